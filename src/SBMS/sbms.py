@@ -1126,6 +1126,14 @@ def AddAmpTools(env):
 		except:
 			pass
 
+		# The CPU amplitude kernels use OpenMP SIMD directives which need no
+		# runtime library. Distributing blocks of events over threads needs
+		# full OpenMP and is enabled by setting AMPTOOLS_OPENMP.
+		CXXFLAGSLIST.extend(["-fopenmp-simd", "-DAMPTOOLS_OMP_SIMD"])
+		if os.getenv('AMPTOOLS_OPENMP')!=None:
+			CXXFLAGSLIST.append("-fopenmp")
+			env.AppendUnique(LINKFLAGS = ['-fopenmp'])
+
 		env.AppendUnique(CXXFLAGS = CXXFLAGSLIST)
 		env.AppendUnique(CPPPATH = AMPTOOLS_CPPPATH)
 		env.AppendUnique(LIBPATH = AMPTOOLS_LIBPATH)
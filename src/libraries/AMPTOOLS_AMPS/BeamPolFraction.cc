@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+#include "TFile.h"
+#include "TAxis.h"
+
+#include "AMPTOOLS_AMPS/BeamPolFraction.h"
+#include "UTILITIES/BeamProperties.h"
+
+map< string, BeamPolFraction* > BeamPolFraction::m_tables;
+
+// amplitudes are normally constructed from one thread, but guard the
+// table map anyway since a lookup may construct BeamProperties
+static mutex tableMutex;
+
+const BeamPolFraction*
+BeamPolFraction::fromBeamConfig( const string& configFile ){
+
+  lock_guard< mutex > lock( tableMutex );
+
+  string key = "config:" + configFile;
+  map< string, BeamPolFraction* >::iterator table = m_tables.find( key );
+  if( table != m_tables.end() ) return table->second;
+
+  BeamProperties beamProp( configFile.c_str() );
+  BeamPolFraction* polFrac = new BeamPolFraction( beamProp.GetPolFrac(),
+                                                  beamProp.GetPolAngle() );
+  m_tables[key] = polFrac;
+  return polFrac;
+}
+
+const BeamPolFraction*
+BeamPolFraction::fromHistogram( const string& rootFile, const string& histName ){
+
+  lock_guard< mutex > lock( tableMutex );
+
+  string key = "hist:" + rootFile + ":" + histName;
+  map< string, BeamPolFraction* >::iterator table = m_tables.find( key );
+  if( table != m_tables.end() ) return table->second;
+
+  TFile* f = TFile::Open( rootFile.c_str() );
+  assert( f != NULL );
+  TH1* hist = (TH1*)f->Get( histName.c_str() );
+  assert( hist != NULL );
+
+  BeamPolFraction* polFrac = new BeamPolFraction( hist, -1 );
+  f->Close();
+  delete f;
+
+  m_tables[key] = polFrac;
+  return polFrac;
+}
+
+const BeamPolFraction*
+BeamPolFraction::fixed( double polFraction ){
+
+  lock_guard< mutex > lock( tableMutex );
+
+  ostringstream key;
+  key.precision( 17 );
+  key << "fixed:" << polFraction;
+  map< string, BeamPolFraction* >::iterator table = m_tables.find( key.str() );
+  if( table != m_tables.end() ) return table->second;
+
+  BeamPolFraction* polFrac = new BeamPolFraction( polFraction );
+  m_tables[key.str()] = polFrac;
+  return polFrac;
+}
+
+BeamPolFraction::BeamPolFraction( double polFraction ) :
+m_isFixed( true ),
+m_fixedValue( polFraction ),
+m_isUniform( true ),
+m_nBins( 0 ),
+m_xMin( 0 ),
+m_xMax( 0 ),
+m_polAngle( -1 )
+{}
+
+BeamPolFraction::BeamPolFraction( const TH1* hist, double polAngle ) :
+m_isFixed( false ),
+m_fixedValue( 0 ),
+m_polAngle( polAngle )
+{
+  assert( hist != NULL );
+
+  const TAxis* axis = hist->GetXaxis();
+
+  m_nBins = axis->GetNbins();
+  m_xMin = axis->GetXmin();
+  m_xMax = axis->GetXmax();
+  m_isUniform = ( axis->GetXbins()->GetSize() == 0 );
+
+  // bin i of the arrays is ROOT bin i+1; under- and overflow are dropped
+  for( int i = 1; i <= m_nBins; ++i ){
+
+    m_edges.push_back( axis->GetBinLowEdge( i ) );
+    m_contents.push_back( hist->GetBinContent( i ) );
+  }
+  m_edges.push_back( m_xMax );
+}
+
+int
+BeamPolFraction::findVariableBin( double energy ) const {
+
+  // energy is inside [ m_xMin, m_xMax ) so the result is a valid bin
+  int bin = upper_bound( m_edges.begin(), m_edges.end(), energy ) -
+            m_edges.begin() - 1;
+
+  return ( bin < m_nBins ? bin : m_nBins - 1 );
+}
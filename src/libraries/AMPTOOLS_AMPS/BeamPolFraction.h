@@ -0,0 +1,83 @@
+#if !defined(BEAMPOLFRACTION)
+#define BEAMPOLFRACTION
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "GPUManager/GPUCustomTypes.h"
+
+#include "TH1.h"
+
+using namespace std;
+
+// Beam polarization fraction as a function of beam photon energy for use
+// in amplitude calcUserVars routines.  The contents of the ROOT histogram
+// (from BeamProperties or a user file) are copied once into a flat array
+// and looked up with the same arithmetic as TAxis::FindBin, avoiding the
+// axis lookup for every event.  Tables are shared: all amplitudes that
+// request the same source get the same object, so the BeamProperties or
+// histogram file is read only once per process.
+
+class BeamPolFraction
+{
+
+public:
+
+  // polarization fraction and angle from a BeamProperties config file
+  static const BeamPolFraction* fromBeamConfig( const string& configFile );
+
+  // polarization fraction from histogram <histName> in <rootFile>
+  static const BeamPolFraction* fromHistogram( const string& rootFile,
+                                               const string& histName );
+
+  // energy independent polarization fraction
+  static const BeamPolFraction* fixed( double polFraction );
+
+  // the polarization fraction at energy; zero outside of the histogram range
+  GDouble operator()( double energy ) const {
+
+    if( m_isFixed ) return m_fixedValue;
+
+    if( !( energy >= m_xMin && energy < m_xMax ) ) return 0;
+
+    int bin;
+    if( m_isUniform ){
+
+      bin = int( m_nBins * ( energy - m_xMin ) / ( m_xMax - m_xMin ) );
+      if( bin >= m_nBins ) bin = m_nBins - 1;
+    }
+    else{
+
+      bin = findVariableBin( energy );
+    }
+
+    return m_contents[bin];
+  }
+
+  // polarization angle in degrees from BeamProperties, -1 if not available
+  double polAngle() const { return m_polAngle; }
+
+private:
+
+  BeamPolFraction( double polFraction );
+  BeamPolFraction( const TH1* hist, double polAngle );
+
+  int findVariableBin( double energy ) const;
+
+  bool m_isFixed;
+  GDouble m_fixedValue;
+
+  bool m_isUniform;
+  int m_nBins;
+  double m_xMin;
+  double m_xMax;
+  vector< double > m_edges;
+  vector< GDouble > m_contents;
+
+  double m_polAngle;
+
+  static map< string, BeamPolFraction* > m_tables;
+};
+
+#endif
@@ -31,10 +31,12 @@ UserAmplitude< BreitWigner >( args )
   
   // make sure the input variables look reasonable
   assert( ( m_orbitL >= 0 ) && ( m_orbitL <= 4 ) );
+
+  m_profAmps = ampProfileCounter( "calcAmplitudeAll", name(), args );
 }
 
-complex< GDouble >
-BreitWigner::calcAmplitude( GDouble** pKin ) const
+void
+BreitWigner::calcUserVars( GDouble** pKin, GDouble* userVars ) const
 {
   TLorentzVector P1, P2, Ptot, Ptemp;
   
@@ -58,16 +60,29 @@ BreitWigner::calcAmplitude( GDouble** pKin ) const
     Ptot += Ptemp;
   }
   
-  GDouble mass  = Ptot.M();
-  GDouble mass1 = P1.M();
-  GDouble mass2 = P2.M();
+  userVars[kMass]  = Ptot.M();
+  userVars[kMass1] = P1.M();
+  userVars[kMass2] = P2.M();
+
+  // these only depend on the event, not on the resonance parameters
+  userVars[kQ] = fabs( breakupMomentum( userVars[kMass], userVars[kMass1],
+                                        userVars[kMass2] ) );
+  userVars[kBarrier] = barrierFactor( userVars[kQ], m_orbitL );
+}
+
+complex< GDouble >
+BreitWigner::calcAmplitude( GDouble** pKin, GDouble* userVars ) const
+{
+  GDouble mass  = userVars[kMass];
+  GDouble mass1 = userVars[kMass1];
+  GDouble mass2 = userVars[kMass2];
+  
+  GDouble q = userVars[kQ];
+  GDouble F = userVars[kBarrier];
   
   // assert positive breakup momenta     
   GDouble q0 = fabs( breakupMomentum(m_mass0, mass1, mass2) );
-  GDouble q  = fabs( breakupMomentum(mass,    mass1, mass2) );
-  
   GDouble F0 = barrierFactor(q0, m_orbitL);
-  GDouble F  = barrierFactor(q,  m_orbitL);
   
   GDouble width = m_width0*(m_mass0/mass)*(q/q0)*((F*F)/(F0*F0));
   //GDouble width = m_width0;
@@ -82,6 +97,25 @@ BreitWigner::calcAmplitude( GDouble** pKin ) const
   return( F * bwtop / bwbottom );
 }
 
+void
+BreitWigner::calcAmplitudeAll( GDouble* pdData, GDouble* pdAmps, int iNEvents,
+                               const vector< vector< int > >* pvPermutations,
+                               GDouble* pdUserVars ) const
+{
+  AmpProfileScope profile( m_profAmps, iNEvents );
+
+  if( pdUserVars == NULL || !cpuKernelsEnabled() ){
+
+    Amplitude::calcAmplitudeAll( pdData, pdAmps, iNEvents,
+                                 pvPermutations, pdUserVars );
+    return;
+  }
+
+  CPUBreitWigner_exec( pdUserVars, pdAmps,
+                       iNEvents * pvPermutations->size(), kNumUserVars,
+                       m_mass0, m_width0, m_orbitL );
+}
+
 void
 BreitWigner::updatePar( const AmpParameter& par ){
  
@@ -93,14 +127,11 @@ BreitWigner::updatePar( const AmpParameter& par ){
 void
 BreitWigner::launchGPUKernel( dim3 dimGrid, dim3 dimBlock, GPU_AMP_PROTO ) const {
   
-  // use integers to endcode the string of daughters -- one index in each
-  // decimal place
-  
-  int daught1 = atoi( m_daughters.first.c_str() );
-  int daught2 = atoi( m_daughters.second.c_str() );
+  // the masses of the resonance and the daughter systems, the breakup
+  // momentum and the barrier factor are precomputed in calcUserVars
   
   GPUBreitWigner_exec( dimGrid,  dimBlock, GPU_AMP_ARGS, 
-                       m_mass0, m_width0, m_orbitL, daught1, daught2 );
+                       m_mass0, m_width0, m_orbitL );
 
 }
 #endif //GPU_ACCELERATION
@@ -6,6 +6,9 @@
 #include "IUAmpTools/UserAmplitude.h"
 #include "GPUManager/GPUCustomTypes.h"
 
+#include "AMPTOOLS_AMPS/cpuKernel.h"
+#include "AMPTOOLS_AMPS/ampProfiler.h"
+
 #include <utility>
 #include <string>
 #include <complex>
@@ -13,11 +16,13 @@
 
 #ifdef GPU_ACCELERATION
 void GPUBreitWigner_exec( dim3 dimGrid, dim3 dimBlock, GPU_AMP_PROTO,
-                          GDouble mass0, GDouble width0, int orbitL,
-                          int daught1, int daught2 );
+                          GDouble mass0, GDouble width0, int orbitL );
 
 #endif // GPU_ACCELERATION
 
+void CPUBreitWigner_exec( CPU_AMP_PROTO, GDouble mass0, GDouble width0,
+                          int orbitL );
+
 using std::complex;
 using namespace std;
 
@@ -28,14 +33,27 @@ class BreitWigner : public UserAmplitude< BreitWigner >
   
 public:
 	
-	BreitWigner() : UserAmplitude< BreitWigner >() {}
+	BreitWigner() : UserAmplitude< BreitWigner >(), m_profAmps( NULL ) {}
 	BreitWigner( const vector< string >& args );
 	
   ~BreitWigner(){}
   
 	string name() const { return "BreitWigner"; }
   
-  complex< GDouble > calcAmplitude( GDouble** pKin ) const;
+  enum UserVars { kMass = 0, kMass1, kMass2, kQ, kBarrier, kNumUserVars };
+  unsigned int numUserVars() const { return kNumUserVars; }
+
+  complex< GDouble > calcAmplitude( GDouble** pKin, GDouble* userVars ) const;
+  void calcUserVars( GDouble** pKin, GDouble* userVars ) const;
+
+  // the masses, the breakup momentum and the barrier factor at the event
+  // mass are all that is needed to compute the amplitude
+  bool needsUserVarsOnly() const { return true; }
+
+  // evaluate blocks of events with the vectorized CPU kernel
+  void calcAmplitudeAll( GDouble* pdData, GDouble* pdAmps, int iNEvents,
+                         const vector< vector< int > >* pvPermutations,
+                         GDouble* pdUserVars ) const;
 	  
   void updatePar( const AmpParameter& par );
     
@@ -54,6 +72,9 @@ private:
   int m_orbitL;
   
   pair< string, string > m_daughters;  
+
+  // NULL unless profiling is enabled
+  AmpProfileCounter* m_profAmps;
 };
 
 #endif
@@ -30,8 +30,8 @@ UserAmplitude< BreitWigner3body >( args )
   
 }
 
-complex< GDouble >
-BreitWigner3body::calcAmplitude( GDouble** pKin ) const
+void
+BreitWigner3body::calcUserVars( GDouble** pKin, GDouble* userVars ) const
 {
   TLorentzVector Ptot, Ptemp;
   
@@ -44,7 +44,13 @@ BreitWigner3body::calcAmplitude( GDouble** pKin ) const
     Ptot += Ptemp;
   }
   
-  GDouble mass  = Ptot.M();
+  userVars[kMass] = Ptot.M();
+}
+
+complex< GDouble >
+BreitWigner3body::calcAmplitude( GDouble** pKin, GDouble* userVars ) const
+{
+  GDouble mass  = userVars[kMass];
   
   GDouble width = m_width0;
   //GDouble width = m_width0;
@@ -35,7 +35,14 @@ public:
   
 	string name() const { return "BreitWigner3body"; }
   
-  complex< GDouble > calcAmplitude( GDouble** pKin ) const;
+  enum UserVars { kMass = 0, kNumUserVars };
+  unsigned int numUserVars() const { return kNumUserVars; }
+
+  complex< GDouble > calcAmplitude( GDouble** pKin, GDouble* userVars ) const;
+  void calcUserVars( GDouble** pKin, GDouble* userVars ) const;
+
+  // the mass of the daughter system is all that is needed
+  bool needsUserVarsOnly() const { return true; }
 	  
   void updatePar( const AmpParameter& par );
     
@@ -0,0 +1,56 @@
+#include <cmath>
+
+#include "AMPTOOLS_AMPS/cpuKernel.h"
+#include "AMPTOOLS_AMPS/BreitWigner.h"
+
+void
+CPUBreitWigner_exec( CPU_AMP_PROTO, GDouble mass0, GDouble width0, int orbitL ){
+
+  CPU_PARALLEL_BLOCKS
+  for( int iFirst = 0; iFirst < iNRows; iFirst += CPU_BLOCK_SIZE ){
+
+    const int iN = ( iNRows - iFirst < CPU_BLOCK_SIZE ?
+                     iNRows - iFirst : CPU_BLOCK_SIZE );
+
+    GDouble mass[CPU_BLOCK_SIZE];
+    GDouble mass1[CPU_BLOCK_SIZE];
+    GDouble mass2[CPU_BLOCK_SIZE];
+
+    cpuLoadUserVar( pdUserVars, iNUserVars, BreitWigner::kMass, iFirst, iN, mass );
+    cpuLoadUserVar( pdUserVars, iNUserVars, BreitWigner::kMass1, iFirst, iN, mass1 );
+    cpuLoadUserVar( pdUserVars, iNUserVars, BreitWigner::kMass2, iFirst, iN, mass2 );
+
+    GDouble q[CPU_BLOCK_SIZE], F[CPU_BLOCK_SIZE];
+    cpuLoadUserVar( pdUserVars, iNUserVars, BreitWigner::kQ, iFirst, iN, q );
+    cpuLoadUserVar( pdUserVars, iNUserVars, BreitWigner::kBarrier, iFirst, iN, F );
+
+    GDouble nominal[CPU_BLOCK_SIZE];
+    for( int i = 0; i < iN; ++i ) nominal[i] = mass0;
+
+    GDouble q0[CPU_BLOCK_SIZE], F0[CPU_BLOCK_SIZE];
+    cpuBreakupMomentum( iN, nominal, mass1, mass2, q0 );
+    cpuBarrierFactor( iN, orbitL, q0, F0 );
+
+    const GDouble bwTop = sqrt( mass0 * width0 / 3.1416 );
+
+    GDouble re[CPU_BLOCK_SIZE];
+    GDouble im[CPU_BLOCK_SIZE];
+
+    CPU_SIMD
+    for( int i = 0; i < iN; ++i ){
+
+      GDouble width = width0*(mass0/mass[i])*(q[i]/q0[i])*
+                      ((F[i]*F[i])/(F0[i]*F0[i]));
+
+      // F * bwTop / ( a + i b ) with a = m0^2 - m^2 and b = -m0 * width
+      GDouble a = mass0*mass0 - mass[i]*mass[i];
+      GDouble b = -1.0 * mass0 * width;
+      GDouble scale = F[i] * bwTop / ( a*a + b*b );
+
+      re[i] =  scale * a;
+      im[i] = -scale * b;
+    }
+
+    cpuStoreAmps( pdAmps, iFirst, iN, re, im );
+  }
+}
@@ -0,0 +1,130 @@
+#include <cmath>
+
+#include "AMPTOOLS_AMPS/cpuKernel.h"
+#include "AMPTOOLS_AMPS/Vec_ps_refl.h"
+
+void
+CPUVec_ps_refl_exec( CPU_AMP_PROTO, const CPUWignerD* dJ, const CPUWignerD* d1,
+                     const GDouble* helAmp, int m_m, int m_l, int m_r, int m_s,
+                     int m_3pi, GDouble dalitz_alpha, GDouble dalitz_beta,
+                     GDouble dalitz_gamma, GDouble dalitz_delta ){
+
+  // dJ, d1 and helAmp are indexed by lambda + 1 for the vector helicity
+  // lambda = -1, 0, 1; for each lambda the summand of calcAmplitude is
+  //   helAmp * d^J_{m lambda}(theta) d^1_{lambda 0}(thetaH) *
+  //   exp( i ( m Phi + lambda PhiH ) )
+
+  const GDouble DegToRad = PI/180.0;
+
+  CPU_PARALLEL_BLOCKS
+  for( int iFirst = 0; iFirst < iNRows; iFirst += CPU_BLOCK_SIZE ){
+
+    const int iN = ( iNRows - iFirst < CPU_BLOCK_SIZE ?
+                     iNRows - iFirst : CPU_BLOCK_SIZE );
+
+    GDouble cosTheta[CPU_BLOCK_SIZE];
+    GDouble Phi[CPU_BLOCK_SIZE];
+    GDouble cosThetaH[CPU_BLOCK_SIZE];
+    GDouble PhiH[CPU_BLOCK_SIZE];
+    GDouble prod_angle[CPU_BLOCK_SIZE];
+    GDouble kinFactor[CPU_BLOCK_SIZE];
+    GDouble polFraction[CPU_BLOCK_SIZE];
+    GDouble polAngle[CPU_BLOCK_SIZE];
+
+    cpuLoadUserVar( pdUserVars, iNUserVars, Vec_ps_refl::uv_cosTheta, iFirst, iN, cosTheta );
+    cpuLoadUserVar( pdUserVars, iNUserVars, Vec_ps_refl::uv_Phi, iFirst, iN, Phi );
+    cpuLoadUserVar( pdUserVars, iNUserVars, Vec_ps_refl::uv_cosThetaH, iFirst, iN, cosThetaH );
+    cpuLoadUserVar( pdUserVars, iNUserVars, Vec_ps_refl::uv_PhiH, iFirst, iN, PhiH );
+    cpuLoadUserVar( pdUserVars, iNUserVars, Vec_ps_refl::uv_prod_Phi, iFirst, iN, prod_angle );
+    if( m_l <= Vec_ps_refl::kMaxBarrierL )
+      cpuLoadUserVar( pdUserVars, iNUserVars, Vec_ps_refl::uv_barrierL0 + m_l, iFirst, iN, kinFactor );
+    else
+      for( int i = 0; i < iN; ++i ) kinFactor[i] = 0;
+    cpuLoadUserVar( pdUserVars, iNUserVars, Vec_ps_refl::uv_beam_polFraction, iFirst, iN, polFraction );
+    cpuLoadUserVar( pdUserVars, iNUserVars, Vec_ps_refl::uv_beam_polAngle, iFirst, iN, polAngle );
+
+    // dalitz parameters for 3-body vector decay
+    GDouble G[CPU_BLOCK_SIZE];
+    if( m_3pi ){
+
+      GDouble dalitz_z[CPU_BLOCK_SIZE];
+      GDouble dalitz_sin3theta[CPU_BLOCK_SIZE];
+      cpuLoadUserVar( pdUserVars, iNUserVars, Vec_ps_refl::uv_dalitz_z, iFirst, iN, dalitz_z );
+      cpuLoadUserVar( pdUserVars, iNUserVars, Vec_ps_refl::uv_dalitz_sin3theta, iFirst, iN, dalitz_sin3theta );
+
+      CPU_SIMD
+      for( int i = 0; i < iN; ++i ){
+
+        GDouble z = dalitz_z[i];
+        GDouble sqrtZ = sqrt( z );
+        G[i] = sqrt( 1 + 2 * dalitz_alpha * z +
+                     2 * dalitz_beta * z * sqrtZ * dalitz_sin3theta[i] +
+                     2 * dalitz_gamma * z * z +
+                     2 * dalitz_delta * z * z * sqrtZ * dalitz_sin3theta[i] );
+      }
+    }
+    else{
+
+      for( int i = 0; i < iN; ++i ) G[i] = 1;
+    }
+
+    // the only transcendental functions needed per event: the phase
+    // m Phi - ( prod_angle + polAngle ) and the vector decay azimuth
+    GDouble cosA[CPU_BLOCK_SIZE], sinA[CPU_BLOCK_SIZE];
+    GDouble cosH[CPU_BLOCK_SIZE], sinH[CPU_BLOCK_SIZE];
+    for( int i = 0; i < iN; ++i ){
+
+      GDouble A = m_m * Phi[i] - ( prod_angle[i] + polAngle[i] * DegToRad );
+      cosA[i] = cos( A );
+      sinA[i] = sin( A );
+      cosH[i] = cos( PhiH[i] );
+      sinH[i] = sin( PhiH[i] );
+    }
+
+    CPUPowerTable cPow, sPow, cPowH, sPowH;
+    cpuHalfAnglePowers( iN, cosTheta, dJ[1].maxPower(), cPow, sPow );
+    cpuHalfAnglePowers( iN, cosThetaH, 2, cPowH, sPowH );
+
+    GDouble re[CPU_BLOCK_SIZE];
+    GDouble im[CPU_BLOCK_SIZE];
+    for( int i = 0; i < iN; ++i ){
+
+      re[i] = 0;
+      im[i] = 0;
+    }
+
+    for( int lambda = -1; lambda <= 1; ++lambda ){
+
+      const GDouble h = helAmp[lambda+1];
+      if( h == 0 ) continue;
+
+      GDouble dj[CPU_BLOCK_SIZE], dh[CPU_BLOCK_SIZE];
+      dJ[lambda+1].evaluate( iN, cPow, sPow, dj );
+      d1[lambda+1].evaluate( iN, cPowH, sPowH, dh );
+
+      CPU_SIMD
+      for( int i = 0; i < iN; ++i ){
+
+        // exp( i lambda PhiH ) for lambda = -1, 0, 1
+        GDouble cl = ( lambda == 0 ? 1 : cosH[i] );
+        GDouble sl = lambda * sinH[i];
+
+        GDouble mag = h * dj[i] * dh[i];
+        re[i] += mag * ( cosA[i] * cl - sinA[i] * sl );
+        im[i] += mag * ( sinA[i] * cl + cosA[i] * sl );
+      }
+    }
+
+    CPU_SIMD
+    for( int i = 0; i < iN; ++i ){
+
+      GDouble Factor = sqrt( 1 + m_s * polFraction[i] ) * kinFactor[i] * G[i];
+
+      // m_r selects the real or imaginary part of the rotated amplitude
+      re[i] = ( m_r == 1 ? Factor * re[i] : 0 );
+      im[i] = ( m_r == -1 ? Factor * im[i] : 0 );
+    }
+
+    cpuStoreAmps( pdAmps, iFirst, iN, re, im );
+  }
+}
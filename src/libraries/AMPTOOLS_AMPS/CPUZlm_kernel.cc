@@ -0,0 +1,59 @@
+#include <cmath>
+
+#include "AMPTOOLS_AMPS/cpuKernel.h"
+#include "AMPTOOLS_AMPS/Zlm.h"
+
+void
+CPUZlm_exec( CPU_AMP_PROTO, const CPUWignerD& dlm0, int j, int m, int r, int s ){
+
+  // Y_lm(theta,phi) = sqrt( (2l+1)/4pi ) d^l_m0(theta) exp( i m phi )
+
+  const GDouble norm = sqrt( ( 2*j + 1 ) / ( 4*PI ) );
+
+  CPU_PARALLEL_BLOCKS
+  for( int iFirst = 0; iFirst < iNRows; iFirst += CPU_BLOCK_SIZE ){
+
+    const int iN = ( iNRows - iFirst < CPU_BLOCK_SIZE ?
+                     iNRows - iFirst : CPU_BLOCK_SIZE );
+
+    GDouble pGamma[CPU_BLOCK_SIZE];
+    GDouble cosTheta[CPU_BLOCK_SIZE];
+    GDouble phi[CPU_BLOCK_SIZE];
+    GDouble bigPhi[CPU_BLOCK_SIZE];
+
+    cpuLoadUserVar( pdUserVars, iNUserVars, Zlm::kPgamma, iFirst, iN, pGamma );
+    cpuLoadUserVar( pdUserVars, iNUserVars, Zlm::kCosTheta, iFirst, iN, cosTheta );
+    cpuLoadUserVar( pdUserVars, iNUserVars, Zlm::kPhi, iFirst, iN, phi );
+    cpuLoadUserVar( pdUserVars, iNUserVars, Zlm::kBigPhi, iFirst, iN, bigPhi );
+
+    CPUPowerTable cPow, sPow;
+    cpuHalfAnglePowers( iN, cosTheta, dlm0.maxPower(), cPow, sPow );
+
+    GDouble d[CPU_BLOCK_SIZE];
+    dlm0.evaluate( iN, cPow, sPow, d );
+
+    // rotating by -bigPhi leaves a single phase per event; r selects
+    // the real or imaginary part of Y_lm * exp( -i bigPhi )
+    GDouble phase[CPU_BLOCK_SIZE];
+    if( r == 1 ){
+
+      for( int i = 0; i < iN; ++i ) phase[i] = cos( m * phi[i] - bigPhi[i] );
+    }
+    else{
+
+      for( int i = 0; i < iN; ++i ) phase[i] = sin( m * phi[i] - bigPhi[i] );
+    }
+
+    GDouble re[CPU_BLOCK_SIZE];
+    GDouble im[CPU_BLOCK_SIZE];
+
+    CPU_SIMD
+    for( int i = 0; i < iN; ++i ){
+
+      re[i] = sqrt( 1 + s * pGamma[i] ) * norm * d[i] * phase[i];
+      im[i] = 0;
+    }
+
+    cpuStoreAmps( pdAmps, iFirst, iN, re, im );
+  }
+}
@@ -10,7 +10,7 @@
 
 #include "IUAmpTools/Kinematics.h"
 #include "AMPTOOLS_AMPS/Compton.h"
-#include "UTILITIES/BeamProperties.h"
+#include "AMPTOOLS_AMPS/BeamPolFraction.h"
 
 Compton::Compton( const vector< string >& args ) :
 UserAmplitude< Compton >( args )
@@ -18,15 +18,13 @@ UserAmplitude< Compton >( args )
 	assert( args.size() == 1 );
 
 	// BeamProperties configuration file
-        TString beamConfigFile = args[0].c_str();
-        BeamProperties beamProp(beamConfigFile);
-        polFrac_vs_E = (TH1D*)beamProp.GetPolFrac();
-        polAngle = beamProp.GetPolAngle();
+        m_polFrac = BeamPolFraction::fromBeamConfig( args[0] );
+        polAngle = m_polFrac->polAngle();
 }
 
 
-complex< GDouble >
-Compton::calcAmplitude( GDouble** pKin ) const {
+void
+Compton::calcUserVars( GDouble** pKin, GDouble* userVars ) const {
   
 	TLorentzVector target  ( 0., 0., 0., 0.938);
 	TLorentzVector beam   ( pKin[0][1], pKin[0][2], pKin[0][3], pKin[0][0] ); 
@@ -36,26 +34,27 @@ Compton::calcAmplitude( GDouble** pKin ) const {
 	TLorentzVector cm = recoil + p1;
 	TLorentzRotation cmBoost( -cm.BoostVector() );
 	
-	TLorentzVector beam_cm = cmBoost * beam;
-	TLorentzVector target_cm = cmBoost * target;
-	TLorentzVector recoil_cm = cmBoost * recoil;
-	
 	// phi dependence needed for polarized distribution
 	TLorentzVector p1_cm = cmBoost * p1;
 	GDouble phi = p1_cm.Phi() + polAngle*TMath::Pi()/180.;
-	GDouble cos2Phi = cos(2.*phi);
+	userVars[kCos2Phi] = cos(2.*phi);
 	
 	// polarization from cobrem.F
-	int bin = polFrac_vs_E->GetXaxis()->FindBin(beam.E());
-	GDouble Pgamma;
-	if (bin == 0 || bin > polFrac_vs_E->GetXaxis()->GetNbins()){
-		Pgamma = 0.;
-	}
-	else Pgamma = polFrac_vs_E->GetBinContent(bin);	
+	userVars[kPgamma] = (*m_polFrac)( beam.E() );
 
 	// factors needed to calculate cross section from model
-	GDouble s = cm.M2();
-	GDouble t = (recoil - target).M2();
+	userVars[kS] = cm.M2();
+	userVars[kT] = (recoil - target).M2();
+}
+
+complex< GDouble >
+Compton::calcAmplitude( GDouble** pKin, GDouble* userVars ) const {
+  
+	GDouble cos2Phi = userVars[kCos2Phi];
+	GDouble Pgamma = userVars[kPgamma];
+
+	GDouble s = userVars[kS];
+	GDouble t = userVars[kT];
 	if(fabs(t) < 0.4) return 0.; // interested in high -t behavior, so temporarily exclude low -t 
 
 	// model parameters from PAC42 proposal PR12-14-003
@@ -165,7 +165,7 @@ std::complex<double> DblRegge_FastEta::cgamma(std::complex<double> z,int OPT) co
         int j,k;
 
 
-        static double a[] = {
+        static const double a[] = {
                 8.333333333333333e-02,
                 -2.777777777777778e-03,
                 7.936507936507937e-04,
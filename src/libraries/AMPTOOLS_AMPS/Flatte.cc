@@ -46,17 +46,32 @@ Flatte::Flatte( const vector< string >& args ) :
 }
 
 
-complex< GDouble > Flatte::calcAmplitude( GDouble** pKin, GDouble* userData ) const {
+void Flatte::calcUserVars( GDouble** pKin, GDouble* userData ) const {
    TLorentzVector P1, P2;
 
    P1.SetPxPyPzE( pKin[m_daughter1][1], pKin[m_daughter1][2], pKin[m_daughter1][3], pKin[m_daughter1][0] );
    P2.SetPxPyPzE( pKin[m_daughter2][1], pKin[m_daughter2][2], pKin[m_daughter2][3], pKin[m_daughter2][0] );
 
    GDouble curMass = (P1+P2).M();
+
+   complex<GDouble> q1 = Flatte::breakupMom( curMass, m_mass11, m_mass12 );
+   complex<GDouble> q2 = Flatte::breakupMom( curMass, m_mass21, m_mass22 );
+
+   userData[kMass] = curMass;
+   userData[kQ1Re] = real(q1);
+   userData[kQ1Im] = imag(q1);
+   userData[kQ2Re] = real(q2);
+   userData[kQ2Im] = imag(q2);
+}
+
+
+complex< GDouble > Flatte::calcAmplitude( GDouble** pKin, GDouble* userData ) const {
+
+   GDouble curMass = userData[kMass];
    complex<GDouble> imag(0.,1.);
 
-   complex<GDouble> gamma11 = (GDouble)m_g1 * Flatte::breakupMom( curMass, m_mass11, m_mass12 );
-   complex<GDouble> gamma22 = (GDouble)m_g2 * Flatte::breakupMom( curMass, m_mass21, m_mass22 );
+   complex<GDouble> gamma11 = (GDouble)m_g1 * complex<GDouble>( userData[kQ1Re], userData[kQ1Im] );
+   complex<GDouble> gamma22 = (GDouble)m_g2 * complex<GDouble>( userData[kQ2Re], userData[kQ2Im] );
 
    complex<GDouble> gammaLow;
    if( (m_mass11+m_mass12) < (m_mass21+m_mass22) ) gammaLow = gamma11;
@@ -72,10 +87,6 @@ complex< GDouble > Flatte::calcAmplitude( GDouble** pKin, GDouble* userData ) co
 }
 
 
-//void Flatte::calcUserData( GDouble** pKin, GDouble* userData ) const {
-//}
-
-
 complex<GDouble> Flatte::phaseSpaceFac(GDouble m, GDouble mDec1, GDouble mDec2) const{
 
    complex<GDouble> result(0.,0.);
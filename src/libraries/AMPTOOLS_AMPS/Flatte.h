@@ -37,7 +37,15 @@ class Flatte : public UserAmplitude< Flatte >{
 
       string name() const { return "Flatte"; }
 
+      // the breakup momenta in both channels only depend on the event
+      // mass and the fixed daughter masses
+      enum UserVars { kMass = 0, kQ1Re, kQ1Im, kQ2Re, kQ2Im, kNumUserVars };
+      unsigned int numUserVars() const { return kNumUserVars; }
+
       complex< GDouble > calcAmplitude( GDouble** pKin, GDouble* userData ) const;
+      void calcUserVars( GDouble** pKin, GDouble* userData ) const;
+
+      bool needsUserVarsOnly() const { return true; }
 
 //#ifdef GPU_ACCELERATION
 //
@@ -29,9 +29,13 @@ GPUVec_ps_refl_kernel( GPU_AMP_PROTO, int m_j, int m_m, int m_l, int m_r, int m_
 	GDouble prod_angle = GPU_UVARS(4);
 	GDouble dalitz_z = GPU_UVARS(5);
 	GDouble dalitz_sin3theta = GPU_UVARS(6);
-	GDouble MX = GPU_UVARS(7);
-	GDouble MVec = GPU_UVARS(8);
-	GDouble MPs = GPU_UVARS(9);
+	// barrier factor for this L precomputed in Vec_ps_refl::calcUserVars
+	GDouble kinFactor = ( m_l <= 4 ? GPU_UVARS(12 + m_l) : 0 );
+
+	// per event beam polarization, either from the tree, the BeamProperties
+	// table or the fixed values given as arguments
+	GDouble beam_polFraction = GPU_UVARS(10);
+	GDouble beam_polAngle = GPU_UVARS(11);
 	
 	///////////////////////////////////////////////////////////////////////////////////////////
 
@@ -47,16 +51,16 @@ GPUVec_ps_refl_kernel( GPU_AMP_PROTO, int m_j, int m_m, int m_l, int m_r, int m_
 		amplitude += Conjugate(wignerD( m_j, m_m, lambda, cosTheta, Phi )) * hel_amp * Conjugate(wignerD( 1, lambda, 0, cosThetaH, PhiH )) * G;
   	} 
   
-	GDouble Factor = sqrt(1 + m_s * polFraction);
+	GDouble Factor = sqrt(1 + m_s * beam_polFraction);
 	WCUComplex zjm = CZero;
-	WCUComplex rotateY = { G_COS(  -1. * (prod_angle + polAngle*DegToRad) ) , G_SIN( -1. * (prod_angle + polAngle*DegToRad) ) }; // prod_angle and polAngle should be added
+	WCUComplex rotateY = { G_COS(  -1. * (prod_angle + beam_polAngle*DegToRad) ) , G_SIN( -1. * (prod_angle + beam_polAngle*DegToRad) ) }; // prod_angle and polAngle should be added
 
 	if (m_r == 1)
 		zjm = (amplitude * rotateY).m_dRe;
 	if (m_r == -1) 
 		zjm = (amplitude * rotateY).m_dIm;
 		
-  	Factor *= barrierFactor(MX, m_l, MVec, MPs);	
+  	Factor *= kinFactor;
 
   	pcDevAmp[iEvent] = zjm * Factor;
 }
@@ -11,12 +11,21 @@
 Hist2D::Hist2D( const vector< string >& args ) :
 UserAmplitude< Hist2D >( args )
 {
-	assert( args.size() == 4 );
+	assert( args.size() == 4 || args.size() == 5 );
 	fileName = args[0].c_str();
 	histName = args[1].c_str();
 	histType = args[2].c_str();
 	particleList = args[3].c_str();
 
+	m_bilinear = false;
+	if( args.size() == 5 ) {
+		if( args[4] != "bilinear" ) {
+			cout<<"Unknown Hist2D option "<<args[4].data()<<", only bilinear is supported"<<endl;
+			exit(1);
+		}
+		m_bilinear = true;
+	}
+
 	cout<<"Opening ROOT file "<<fileName.data()<<endl;
 	cout<<"Model provided in histogram named "<<histName.data()<<endl;
 	cout<<"Histogram type for generator "<<histType.data()<<endl;
@@ -25,7 +34,9 @@ UserAmplitude< Hist2D >( args )
 		string num; num += particleList[i];
 		int index = atoi(num.c_str());
 		cout<<index<<endl;
+		m_particles.push_back(index);
 	}
+	if(m_bilinear) cout<<"Interpolating bilinearly between bin centers"<<endl;
 
 	TFile *finput = TFile::Open(fileName.data());
 	if(!finput->IsOpen()) {
@@ -43,46 +54,123 @@ UserAmplitude< Hist2D >( args )
 		cout<<"Type of 2D histogram is not currently supported, please add necessary kinematics and options to Hist2D amplitude"<<endl;
 		exit(1);
 	}
+	m_useBeamEnergy = (histType == "MassVsEgamma");
 
 	// keep in memory after file is closed
         hist2D->SetDirectory(gROOT);
 	finput->Close();
+
+	// flat copy of the contents, global bin = binX + (nBinsX+2)*binY
+	m_nBinsX = hist2D->GetXaxis()->GetNbins() + 2;
+	int nBinsY = hist2D->GetYaxis()->GetNbins() + 2;
+	m_weights.resize( m_nBinsX * nBinsY );
+	for(int iy=0; iy<nBinsY; iy++) {
+		for(int ix=0; ix<m_nBinsX; ix++) {
+			m_weights[ix + m_nBinsX*iy] = hist2D->GetBinContent(ix, iy);
+		}
+	}
 }
 
+int
+Hist2D::findBin( const TAxis* axis, double value ) const {
 
-complex< GDouble >
-Hist2D::calcAmplitude( GDouble** pKin ) const {
+	// same convention as TAxis::FindFixBin: 0 is underflow, nBins+1 overflow
+	int nBins = axis->GetNbins();
+	double min = axis->GetXmin();
+	double max = axis->GetXmax();
+
+	if( value < min ) return 0;
+	if( !( value < max ) ) return nBins + 1;
+
+	// variable bin widths need a search, uniform binning is arithmetic
+	if( axis->GetXbins()->GetSize() ) return axis->FindFixBin( value );
+
+	return 1 + int( nBins * ( value - min ) / ( max - min ) );
+}
+
+void
+Hist2D::findInterpolationBin( const TAxis* axis, double value,
+			      int& bin, GDouble& frac ) const {
+
+	// lower of the two bins whose centers enclose value; beyond the
+	// outermost bin centers the edge bin content is used
+	int nBins = axis->GetNbins();
+	bin = findBin( axis, value );
+	if( value < axis->GetBinCenter( bin ) ) bin--;
+
+	if( bin < 1 ) {
+		bin = 1;
+		frac = 0;
+	}
+	else if( bin >= nBins ) {
+		bin = nBins;
+		frac = 0;
+	}
+	else {
+		double lowCenter = axis->GetBinCenter( bin );
+		frac = ( value - lowCenter ) / ( axis->GetBinCenter( bin + 1 ) - lowCenter );
+	}
+}
+
+void
+Hist2D::calcUserVars( GDouble** pKin, GDouble* userVars ) const {
   
-	TLorentzVector target  ( 0., 0., 0., 0.938);
 	TLorentzVector beam   ( pKin[0][1], pKin[0][2], pKin[0][3], pKin[0][0] ); 
-	TLorentzVector recoil ( pKin[1][1], pKin[1][2], pKin[1][3], pKin[1][0] ); 
 	
 	// compute particle P4 sum for invariant mass
 	TLorentzVector sum;
-	for(uint i=0; i<particleList.length(); i++) {
-		string num; num += particleList[i];
-		int index = atoi(num.c_str());
+	for(uint i=0; i<m_particles.size(); i++) {
+		int index = m_particles[i];
 		TLorentzVector particleP4 ( pKin[index][1], pKin[index][2], pKin[index][3], pKin[index][0] ); 
 		sum += particleP4;
 	}
 	
-	double beamE = beam.E();
-	double t = fabs((sum - beam).M2()); 
-
-	double userVarX = 0;
+	double userVarX = m_useBeamEnergy ? beam.E() : fabs((sum - beam).M2());
 	double userVarY = sum.M();
-	if(histType == "MassVsEgamma") {
-		userVarX = beamE;
+
+	const TAxis* xAxis = hist2D->GetXaxis();
+	const TAxis* yAxis = hist2D->GetYaxis();
+
+	userVars[kFracX] = 0;
+	userVars[kFracY] = 0;
+
+	if(!m_bilinear) {
+		userVars[kBin] = findBin(xAxis, userVarX) + m_nBinsX * findBin(yAxis, userVarY);
+		return;
 	}
-	if(histType == "MassVst") {
-		userVarX = t;
+
+	// outside of the histogram range the weight is zero
+	if(userVarX < xAxis->GetXmin() || !(userVarX < xAxis->GetXmax()) ||
+	   userVarY < yAxis->GetXmin() || !(userVarY < yAxis->GetXmax())) {
+		userVars[kBin] = -1;
+		return;
 	}
 
+	int binX, binY;
+	findInterpolationBin(xAxis, userVarX, binX, userVars[kFracX]);
+	findInterpolationBin(yAxis, userVarY, binY, userVars[kFracY]);
+	userVars[kBin] = binX + m_nBinsX * binY;
+}
+
+complex< GDouble >
+Hist2D::calcAmplitude( GDouble** pKin, GDouble* userVars ) const {
+
 	// weighted model of intensity from histogram 
 	GDouble W = 0.; // initialized to zero
 
-	int bin = hist2D->FindBin(userVarX, userVarY); // generic bin index from 2D histogram (negative value if values outside defined range)
-	if(bin > 0) W = hist2D->GetBinContent(bin); 
+	int bin = static_cast< int >( userVars[kBin] );
+	if(bin <= 0) return complex< GDouble > ( W );
+
+	if(!m_bilinear) {
+		W = m_weights[bin];
+	}
+	else {
+		GDouble fx = userVars[kFracX];
+		GDouble fy = userVars[kFracY];
+		const GDouble* w = &(m_weights[bin]);
+		W = (1-fy) * ( (1-fx) * w[0] + fx * w[1] ) +
+		    fy * ( (1-fx) * w[m_nBinsX] + fx * w[m_nBinsX+1] );
+	}
 
 	return complex< GDouble > ( sqrt(W) );
 }
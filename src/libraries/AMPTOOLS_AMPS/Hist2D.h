@@ -19,22 +19,49 @@ using namespace std;
 
 class Kinematics;
 
+// The histogram contents are copied into a flat array (including the
+// under- and overflow bins, laid out as in TH2::GetBin) when the amplitude
+// is constructed.  The global bin of each event is found once in
+// calcUserVars so that the fit only does an array lookup per event.
+//
+// An optional fifth argument "bilinear" interpolates between the centers
+// of neighboring bins instead of using the content of the bin itself.
+
 class Hist2D : public UserAmplitude< Hist2D >
 {
-    
+
 public:
-	
+
 	Hist2D() : UserAmplitude< Hist2D >() { };
 	Hist2D( const vector< string >& args );
-	
+
 	string name() const { return "Hist2D"; }
-    
-	complex< GDouble > calcAmplitude( GDouble** pKin ) const;
-	
+
+	enum UserVars { kBin = 0, kFracX, kFracY, kNumUserVars };
+	unsigned int numUserVars() const { return kNumUserVars; }
+
+	complex< GDouble > calcAmplitude( GDouble** pKin, GDouble* userVars ) const;
+	void calcUserVars( GDouble** pKin, GDouble* userVars ) const;
+
+	bool needsUserVarsOnly() const { return true; }
+
 private:
-	
+
+	int findBin( const TAxis* axis, double value ) const;
+	void findInterpolationBin( const TAxis* axis, double value,
+				   int& bin, GDouble& frac ) const;
+
         string fileName, histName, histType, particleList;
 	TH2 *hist2D;
+
+	bool m_useBeamEnergy;
+	bool m_bilinear;
+	vector< int > m_particles;
+
+	// number of bins in x including under- and overflow, i.e. the stride
+	// between rows of constant y in m_weights
+	int m_nBinsX;
+	vector< GDouble > m_weights;
 };
 
 #endif
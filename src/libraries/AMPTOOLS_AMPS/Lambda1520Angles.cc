@@ -13,7 +13,7 @@
 #include "AMPTOOLS_AMPS/clebschGordan.h"
 #include "AMPTOOLS_AMPS/wignerD.h"
 
-#include "UTILITIES/BeamProperties.h"
+#include "AMPTOOLS_AMPS/BeamPolFraction.h"
 
 Lambda1520Angles::Lambda1520Angles( const vector< string >& args ) :
 UserAmplitude< Lambda1520Angles >( args )
@@ -48,19 +48,17 @@ UserAmplitude< Lambda1520Angles >( args )
 	if(args.size() == 11){
 		polAngle  = atof(args[9].c_str() ); // azimuthal angle of the photon polarization vector in the lab.
 		polFraction = AmpParameter( args[10] ); // fraction of polarization (0-1)
+		m_polFrac = BeamPolFraction::fixed( polAngle == -1 ? 0. : polFraction );
 		std::cout << "Fixed polarisation of " << polFraction << " and angle of " << polAngle << " degrees." << std::endl;
 	}
 	else if (args.size() == 10){
 		// BeamProperties configuration file
-		TString beamConfigFile = args[9].c_str();
-		BeamProperties beamProp(beamConfigFile);
-		polFrac_vs_E = (TH1D*)beamProp.GetPolFrac();
-		polAngle = beamProp.GetPolAngle();
+		m_polFrac = BeamPolFraction::fromBeamConfig( args[9] );
+		polAngle = m_polFrac->polAngle();
 		std::cout << "Polarisation angle of " << polAngle << " and degree from BeamProperties." << std::endl;
-		if(polAngle == -1)
+		if(polAngle == -1){
 			std::cout << "This is an amorphous run. Set beam polarisation to 0." << std::endl;
-		for(Int_t i=0; i<polFrac_vs_E->GetXaxis()->GetNbins()+2; i++){
-			cout << polFrac_vs_E->GetBinContent(i) << endl;
+			m_polFrac = BeamPolFraction::fixed( 0. );
 		}
 	}
 	else
@@ -68,8 +66,8 @@ UserAmplitude< Lambda1520Angles >( args )
 }
 
 
-complex< GDouble >
-Lambda1520Angles::calcAmplitude( GDouble** pKin ) const {
+void
+Lambda1520Angles::calcUserVars( GDouble** pKin, GDouble* userVars ) const {
 	
 	TLorentzVector target ( 0, 0, 0, 0.9382720813);
 	TLorentzVector beam   ( pKin[0][1], pKin[0][2], pKin[0][3], pKin[0][0] ); 
@@ -95,28 +93,30 @@ Lambda1520Angles::calcAmplitude( GDouble** pKin ) const {
 					(p1_res.Vect()).Dot(y),
 					(p1_res.Vect()).Dot(z) );
 	
-	GDouble sinSqTheta = sin(angles.Theta())*sin(angles.Theta());
-	GDouble cosSqTheta = cos(angles.Theta())*cos(angles.Theta());
-	GDouble sin2Theta = sin(2.*angles.Theta());
+	userVars[kSinSqTheta] = sin(angles.Theta())*sin(angles.Theta());
+	userVars[kCosSqTheta] = cos(angles.Theta())*cos(angles.Theta());
+	userVars[kSin2Theta] = sin(2.*angles.Theta());
 	
-	GDouble phi = angles.Phi();
+	userVars[kPhi] = angles.Phi();
 	
 	TVector3 eps(cos(polAngle*TMath::DegToRad()), sin(polAngle*TMath::DegToRad()), 0.0); // beam polarization vector in lab
 	GDouble Phi = atan2(y.Dot(eps), beam.Vect().Unit().Dot(eps.Cross(y)));
-	Phi = Phi > 0? Phi : Phi + 3.14159;
+	userVars[kBigPhi] = Phi > 0? Phi : Phi + 3.14159;
 	
 	// polarization BeamProperties
-	GDouble Pgamma=polFraction;
-	
-	if(polAngle == -1)
-		Pgamma = 0.;
-	else if(polFrac_vs_E!=NULL){
-		int bin = polFrac_vs_E->GetXaxis()->FindBin(beam.E());
-		if (bin == 0 || bin > polFrac_vs_E->GetXaxis()->GetNbins()){
-			Pgamma = 0.;
-		}
-		else Pgamma = polFrac_vs_E->GetBinContent(bin);
-	}
+	userVars[kPgamma] = (*m_polFrac)( beam.E() );
+}
+
+
+complex< GDouble >
+Lambda1520Angles::calcAmplitude( GDouble** pKin, GDouble* userVars ) const {
+	
+	GDouble sinSqTheta = userVars[kSinSqTheta];
+	GDouble cosSqTheta = userVars[kCosSqTheta];
+	GDouble sin2Theta = userVars[kSin2Theta];
+	GDouble phi = userVars[kPhi];
+	GDouble Phi = userVars[kBigPhi];
+	GDouble Pgamma = userVars[kPgamma];
 	
 	// SDMEs for 3/2- -> 1/2+ + 0- (doi.org/10.1103/PhysRevC.96.025208)
 	GDouble W = 3.*(0.5 - rho011)*sinSqTheta + rho011*(1.+3.*cosSqTheta) - 2.*TMath::Sqrt(3.)*rho031*cos(phi)*sin2Theta - 2.*TMath::Sqrt(3.)*rho03m1*cos(2.*phi)*sinSqTheta;
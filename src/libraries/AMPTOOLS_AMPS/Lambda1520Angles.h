@@ -18,6 +18,7 @@ using std::complex;
 using namespace std;
 
 class Kinematics;
+class BeamPolFraction;
 
 class Lambda1520Angles : public UserAmplitude< Lambda1520Angles >
 {
@@ -29,7 +30,14 @@ public:
 	
 	string name() const { return "Lambda1520Angles"; }
     
-	complex< GDouble > calcAmplitude( GDouble** pKin ) const;
+	enum UserVars { kPgamma = 0, kSinSqTheta, kCosSqTheta, kSin2Theta,
+			kPhi, kBigPhi, kNumUserVars };
+	unsigned int numUserVars() const { return kNumUserVars; }
+
+	complex< GDouble > calcAmplitude( GDouble** pKin, GDouble* userVars ) const;
+	void calcUserVars( GDouble** pKin, GDouble* userVars ) const;
+
+	bool needsUserVarsOnly() const { return true; }
 
   
 private:
@@ -48,7 +56,7 @@ private:
 
 	GDouble polFraction=0.;
 	GDouble polAngle=-1;
-	TH1D *polFrac_vs_E;
+	const BeamPolFraction* m_polFrac;
 
 };
 
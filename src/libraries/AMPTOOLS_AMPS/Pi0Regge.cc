@@ -10,7 +10,7 @@
 
 #include "IUAmpTools/Kinematics.h"
 #include "AMPTOOLS_AMPS/Pi0Regge.h"
-#include "UTILITIES/BeamProperties.h"
+#include "AMPTOOLS_AMPS/BeamPolFraction.h"
 
 Pi0Regge::Pi0Regge( const vector< string >& args ) :
 UserAmplitude< Pi0Regge >( args )
@@ -18,17 +18,14 @@ UserAmplitude< Pi0Regge >( args )
 	assert( args.size() == 1 );
 	
 	// BeamProperties configuration file
-	TString beamConfigFile = args[0].c_str();
-	BeamProperties beamProp(beamConfigFile);
-	polFrac_vs_E = (TH1D*)beamProp.GetPolFrac();
-	polAngle = beamProp.GetPolAngle();
+	m_polFrac = BeamPolFraction::fromBeamConfig( args[0] );
+	polAngle = m_polFrac->polAngle();
 }
 
 
-complex< GDouble >
-Pi0Regge::calcAmplitude( GDouble** pKin ) const {
+void
+Pi0Regge::calcUserVars( GDouble** pKin, GDouble* userVars ) const {
   
-	TLorentzVector target  ( 0., 0., 0., 0.938);
 	TLorentzVector beam   ( pKin[0][1], pKin[0][2], pKin[0][3], pKin[0][0] ); 
 	TLorentzVector recoil ( pKin[1][1], pKin[1][2], pKin[1][3], pKin[1][0] ); 
 	TLorentzVector p1     ( pKin[2][1], pKin[2][2], pKin[2][3], pKin[2][0] ); 
@@ -36,26 +33,26 @@ Pi0Regge::calcAmplitude( GDouble** pKin ) const {
 	TLorentzVector cm = recoil + p1;
 	TLorentzRotation cmBoost( -cm.BoostVector() );
 	
-	TLorentzVector beam_cm = cmBoost * beam;
-	TLorentzVector target_cm = cmBoost * target;
-	TLorentzVector recoil_cm = cmBoost * recoil;
-	
 	// phi dependence needed for polarized distribution
 	TLorentzVector p1_cm = cmBoost * p1;
 	GDouble phi = p1_cm.Phi() + polAngle*TMath::Pi()/180.;
-	GDouble cos2Phi = cos(2.*phi);
+	userVars[kCos2Phi] = cos(2.*phi);
 	
 	// polarization BeamProperties
-	int bin = polFrac_vs_E->GetXaxis()->FindBin(beam.E());
-	GDouble Pgamma;
-	if (bin == 0 || bin > polFrac_vs_E->GetXaxis()->GetNbins()){
-		Pgamma = 0.;
-	}
-	else Pgamma = polFrac_vs_E->GetBinContent(bin);
+	userVars[kPgamma] = (*m_polFrac)( beam.E() );
 
 	// factors needed to calculate amplitude in c++ code
-	GDouble Ecom = cm.M();
-	GDouble theta = p1_cm.Theta();	
+	userVars[kEcom] = cm.M();
+	userVars[kTheta] = p1_cm.Theta();
+}
+
+complex< GDouble >
+Pi0Regge::calcAmplitude( GDouble** pKin, GDouble* userVars ) const {
+  
+	GDouble cos2Phi = userVars[kCos2Phi];
+	GDouble Pgamma = userVars[kPgamma];
+	GDouble Ecom = userVars[kEcom];
+	GDouble theta = userVars[kTheta];
 
 	// amplitude coded in c++ (include calculation of beam asymmetry)
 	double BeamSigma = 0.;
@@ -17,6 +17,7 @@ using std::complex;
 using namespace std;
 
 class Kinematics;
+class BeamPolFraction;
 
 class Pi0Regge : public UserAmplitude< Pi0Regge >
 {
@@ -28,7 +29,18 @@ public:
 	
 	string name() const { return "Pi0Regge"; }
     
-	complex< GDouble > calcAmplitude( GDouble** pKin ) const;
+	enum UserVars { kPgamma = 0, kCos2Phi, kEcom, kTheta, kNumUserVars };
+	unsigned int numUserVars() const { return kNumUserVars; }
+
+	complex< GDouble > calcAmplitude( GDouble** pKin, GDouble* userVars ) const;
+	void calcUserVars( GDouble** pKin, GDouble* userVars ) const;
+
+	bool needsUserVarsOnly() const { return true; }
+
+	// cos2Phi includes the polarization angle of the beam configuration
+	// file given to this instance, so the user variables cannot be shared
+	// with other instances
+	bool areUserVarsStatic() const { return false; }
 	
 private:
 
@@ -36,7 +48,7 @@ private:
 
 	TH1D *totalFlux_vs_E;
 	TH1D *polFlux_vs_E;
-	TH1D *polFrac_vs_E;
+	const BeamPolFraction* m_polFrac;
 };
 
 #endif
@@ -18,16 +18,13 @@ UserAmplitude< Pi0SAID >( args )
 	Pgamma = atof( args[0].c_str() );
 
 	FillDataTables();
+}
 
-	hCosTheta_Ebeam = new TH2F("hCosTheta_Ebeam","; E_{#gamma}; cos#theta; d#sigma/dcos#theta", 31, 1.475, 3.025, 41, -1.025, 1.025);
-	hSigma_Ebeam = new TH2F("hSigma_Ebeam","; E_{#gamma}; cos#theta; #Sigma", 31, 1.475, 3.025, 41, -1.025, 1.025);
+// index into the data tables for uniform bins, -1 outside of the range
+static int tableBin( GDouble value, int nBins, GDouble min, GDouble max ) {
 
-	for(int i=0; i<hCosTheta_Ebeam->GetXaxis()->GetNbins(); i++){
-		for(int j=0; j<hCosTheta_Ebeam->GetYaxis()->GetNbins(); j++){
-			hCosTheta_Ebeam->SetBinContent(i+1,j+1,DSG[i][j]);
-			hSigma_Ebeam->SetBinContent(i+1,j+1,Sigma[i][j]);
-		}
-	}		
+	if( value < min || !( value < max ) ) return -1;
+	return int( nBins * ( value - min ) / ( max - min ) );
 }
 
 
@@ -51,12 +48,15 @@ Pi0SAID::calcAmplitude( GDouble** pKin ) const {
 	GDouble cos2Phi = cos(2.*phi);
 	GDouble Eg = beam.E();
 
-	int bin = hCosTheta_Ebeam->FindBin(Eg, cosTheta);
-	GDouble DSG = hCosTheta_Ebeam->GetBinContent(bin);
-	GDouble Sigma = hSigma_Ebeam->GetBinContent(bin);
-	
+	// the tables have 31 bins in E_gamma from 1.475 to 3.025 GeV and 41 bins
+	// in cos(theta) from -1.025 to 1.025; they are read directly instead of
+	// through TH2F copies, which are not safe to share between threads
+	int iE = tableBin(Eg, 31, 1.475, 3.025);
+	int iCos = tableBin(cosTheta, 41, -1.025, 1.025);
+	if(iE < 0 || iCos < 0) return complex< GDouble > ( 0 );
+
 	// weighted cross section from Igor Strakovsky (GWU/SAID collaboration)
-	GDouble W = DSG * (1 - Pgamma * Sigma * cos2Phi);
+	GDouble W = DSG[iE][iCos] * (1 - Pgamma * Sigma[iE][iCos] * cos2Phi);
 
 	return complex< GDouble > ( sqrt(W) );
 }
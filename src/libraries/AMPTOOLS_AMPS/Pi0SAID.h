@@ -35,7 +35,6 @@ private:
 	double DSG[31][41];
 	double Sigma[31][41];
 
-	TH2F *hCosTheta_Ebeam, *hSigma_Ebeam;
 	GDouble Pgamma;
 };
 
@@ -11,7 +11,7 @@
 #include "IUAmpTools/Kinematics.h"
 #include "AMPTOOLS_AMPS/PiPlusRegge.h"
 
-#include "UTILITIES/BeamProperties.h"
+#include "AMPTOOLS_AMPS/BeamPolFraction.h"
 
 PiPlusRegge::PiPlusRegge( const vector< string >& args ) :
 UserAmplitude< PiPlusRegge >( args )
@@ -20,15 +20,13 @@ UserAmplitude< PiPlusRegge >( args )
 	// Polarization plane angle (PARA = 0 and PERP = PI/2)
 
 	// BeamProperties configuration file
-	TString beamConfigFile = args[0].c_str();
-	BeamProperties beamProp(beamConfigFile);
-	polFrac_vs_E = (TH1D*)beamProp.GetPolFrac();
-	polAngle = beamProp.GetPolAngle();
+	m_polFrac = BeamPolFraction::fromBeamConfig( args[0] );
+	polAngle = m_polFrac->polAngle();
 }
 
 
-complex< GDouble >
-PiPlusRegge::calcAmplitude( GDouble** pKin ) const {
+void
+PiPlusRegge::calcUserVars( GDouble** pKin, GDouble* userVars ) const {
   
 	TLorentzVector target  ( 0., 0., 0., 0.938);
 	TLorentzVector beam   ( pKin[0][1], pKin[0][2], pKin[0][3], pKin[0][0] ); 
@@ -38,24 +36,24 @@ PiPlusRegge::calcAmplitude( GDouble** pKin ) const {
 	TLorentzVector cm = recoil + p1;
 	TLorentzRotation cmBoost( -cm.BoostVector() );
 	
-	TLorentzVector beam_cm = cmBoost * beam;
-	TLorentzVector target_cm = cmBoost * target;
-	TLorentzVector recoil_cm = cmBoost * recoil;
-	
 	// phi dependence needed for polarized distribution
 	TLorentzVector p1_cm = cmBoost * p1;
 	GDouble phi = p1_cm.Phi() + polAngle*TMath::Pi()/180.;
-	GDouble cos2Phi = cos(2.*phi);
+	userVars[kCos2Phi] = cos(2.*phi);
 	
 	// polarization from cobrem.F
-	int bin = polFrac_vs_E->GetXaxis()->FindBin(beam.E());
-	GDouble Pgamma;
-	if (bin == 0 || bin > polFrac_vs_E->GetXaxis()->GetNbins()){
-		Pgamma = 0.;
-	}
-	else Pgamma = polFrac_vs_E->GetBinContent(bin);
+	userVars[kPgamma] = (*m_polFrac)( beam.E() );
+
+	userVars[kT] = (target - recoil).M2();
+}
+
+complex< GDouble >
+PiPlusRegge::calcAmplitude( GDouble** pKin, GDouble* userVars ) const {
+  
+	GDouble cos2Phi = userVars[kCos2Phi];
+	GDouble Pgamma = userVars[kPgamma];
 
-	GDouble t = (target - recoil).M2();
+	GDouble t = userVars[kT];
 	GDouble W = exp(2.5*t);
 
 	// hard coded beam asymmetry for all -t
@@ -15,6 +15,7 @@ using std::complex;
 using namespace std;
 
 class Kinematics;
+class BeamPolFraction;
 
 class PiPlusRegge : public UserAmplitude< PiPlusRegge >
 {
@@ -26,12 +27,23 @@ public:
 	
 	string name() const { return "PiPlusRegge"; }
     
-	complex< GDouble > calcAmplitude( GDouble** pKin ) const;
+	enum UserVars { kPgamma = 0, kCos2Phi, kT, kNumUserVars };
+	unsigned int numUserVars() const { return kNumUserVars; }
+
+	complex< GDouble > calcAmplitude( GDouble** pKin, GDouble* userVars ) const;
+	void calcUserVars( GDouble** pKin, GDouble* userVars ) const;
+
+	bool needsUserVarsOnly() const { return true; }
+
+	// cos2Phi includes the polarization angle of the beam configuration
+	// file given to this instance, so the user variables cannot be shared
+	// with other instances
+	bool areUserVarsStatic() const { return false; }
 	
 private:
 
 	GDouble polAngle;
-	TH1D *polFrac_vs_E;
+	const BeamPolFraction* m_polFrac;
 };
 
 #endif
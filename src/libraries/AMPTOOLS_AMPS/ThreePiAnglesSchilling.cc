@@ -7,11 +7,10 @@
 
 #include "TLorentzVector.h"
 #include "TLorentzRotation.h"
-#include "TFile.h"
 
 #include "IUAmpTools/Kinematics.h"
 #include "AMPTOOLS_AMPS/ThreePiAnglesSchilling.h"
-#include "UTILITIES/BeamProperties.h"
+#include "AMPTOOLS_AMPS/BeamPolFraction.h"
 
 ThreePiAnglesSchilling::ThreePiAnglesSchilling( const vector< string >& args ) :
 UserAmplitude< ThreePiAnglesSchilling >( args )
@@ -50,14 +49,15 @@ UserAmplitude< ThreePiAnglesSchilling >( args )
   registerParameter( m_polAngle );
   
    if (m_polFraction > 0.0)
+   {
    cout << "Fitting with constant polarization" << endl;
+   m_polFrac = BeamPolFraction::fixed( m_polFraction );
+   }
    else
    {
    cout << "Fitting with polarization from BeamProperties class" << endl;
    // BeamProperties configuration file
-   TString beamConfigFile = args[10].c_str();
-   BeamProperties beamProp(beamConfigFile);
-   m_polFrac_vs_E = (TH1D*)beamProp.GetPolFrac();
+   m_polFrac = BeamPolFraction::fromBeamConfig( args[10] );
    }
 }
 
@@ -142,18 +142,6 @@ ThreePiAnglesSchilling::calcUserVars( GDouble** pKin, GDouble* userVars ) const
   userVars[kBigPhi] = atan2( yHel.Dot( polUnitVec ),
                              beam.Vect().Unit().Dot( polUnitVec.Cross( yHel ) ) );
 
-  GDouble polFrac = 0;
-  if( m_polFraction > 0 ) {
-
-    // for fitting with constant polarization
-    polFrac = m_polFraction;
-  }
-  else{
-    int bin = m_polFrac_vs_E->GetXaxis()->FindBin(pKin[0][0]);
-    if( bin == 0 || bin > m_polFrac_vs_E->GetXaxis()->GetNbins() ) polFrac = 0;
-    else polFrac = m_polFrac_vs_E->GetBinContent(bin);
-  }
-  
-  userVars[kPolFrac] = polFrac;
+  userVars[kPolFrac] = (*m_polFrac)( pKin[0][0] );
  }
 
@@ -22,6 +22,7 @@ using std::complex;
 using namespace std;
 
 class Kinematics;
+class BeamPolFraction;
 
 class ThreePiAnglesSchilling : public UserAmplitude< ThreePiAnglesSchilling >
 {
@@ -70,7 +71,7 @@ private:
   AmpParameter m_polAngle;
 
   double m_polFraction;
-  TH1D *m_polFrac_vs_E;
+  const BeamPolFraction* m_polFrac;
 
 };
 
@@ -7,12 +7,12 @@
 
 #include "TLorentzVector.h"
 #include "TLorentzRotation.h"
-#include "TFile.h"
 
 #include "IUAmpTools/Kinematics.h"
 #include "AMPTOOLS_AMPS/TwoLeptonAngles.h"
 #include "AMPTOOLS_AMPS/clebschGordan.h"
 #include "AMPTOOLS_AMPS/wignerD.h"
+#include "AMPTOOLS_AMPS/BeamPolFraction.h"
 
 TwoLeptonAngles::TwoLeptonAngles( const vector< string >& args ) :
   UserAmplitude< TwoLeptonAngles >( args )
@@ -53,16 +53,15 @@ TwoLeptonAngles::TwoLeptonAngles( const vector< string >& args ) :
   //    Usage: amplitude <reaction>::<sum>::<ampName> TwoLeptonAngles <rho000> ... <rho1m12> <polAngle> <polFraction>
   if(args.size() == 11) {
     polFraction = atof(args[10].c_str());
+    m_polFrac = BeamPolFraction::fixed( polFraction );
     cout << "Fitting with constant polarization " << polFraction << endl;
   }
   // 2: 12 arguments, read polarization from histogram <hist> in file <rootFile>
   //    Usage: amplitude <reaction>::<sum>::<ampName> TwoLeptonAngles <rho000> ... <rho1m12> <polAngle> <rootFile> <hist>
   else if(args.size() == 12) {
     polFraction = 0.; 
-    TFile* f = new TFile( args[10].c_str() );
-    polFrac_vs_E = (TH1D*)f->Get( args[11].c_str() );
-    assert( polFrac_vs_E != NULL );
-    cout << "Fitting with polarization from " << polFrac_vs_E->GetName() << endl;
+    m_polFrac = BeamPolFraction::fromHistogram( args[10], args[11] );
+    cout << "Fitting with polarization from " << args[11] << endl;
   }
 }
 
@@ -128,18 +127,7 @@ TwoLeptonAngles::calcUserVars( GDouble** pKin, GDouble* userVars ) const {
   userVars[kBigPhi] = atan2(y.Dot(eps), beam.Vect().Unit().Dot(eps.Cross(y)));
 	
   // vector meson production from K. Schilling et. al.
-  GDouble Pgamma;
-  if(polFraction > 0.) { // for fitting with constant polarization 
-    Pgamma = polFraction;
-  }
-  else{
-    int bin = polFrac_vs_E->GetXaxis()->FindBin(pKin[0][0]);
-    if (bin == 0 || bin > polFrac_vs_E->GetXaxis()->GetNbins()){
-      Pgamma = 0.;
-    }
-    else Pgamma = polFrac_vs_E->GetBinContent(bin);
-  }
-  userVars[kPgamma] = Pgamma;
+  userVars[kPgamma] = (*m_polFrac)( pKin[0][0] );
 }
 
 #ifdef GPU_ACCELERATION
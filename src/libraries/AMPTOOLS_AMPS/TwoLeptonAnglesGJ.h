@@ -25,6 +25,7 @@ using std::complex;
 using namespace std;
 
 class Kinematics;
+class BeamPolFraction;
 
 class TwoLeptonAnglesGJ : public UserAmplitude< TwoLeptonAnglesGJ >
 {
@@ -71,7 +72,7 @@ private:
   AmpParameter polAngle;
 
   double polFraction;
-  TH1D *polFrac_vs_E;
+  const BeamPolFraction* m_polFrac;
 
 };
 
@@ -25,6 +25,7 @@ using std::complex;
 using namespace std;
 
 class Kinematics;
+class BeamPolFraction;
 
 class TwoPiAngles : public UserAmplitude< TwoPiAngles >
 {
@@ -71,7 +72,7 @@ private:
   AmpParameter polAngle;
 
   double polFraction;
-  TH1D *polFrac_vs_E;
+  const BeamPolFraction* m_polFrac;
 
 };
 
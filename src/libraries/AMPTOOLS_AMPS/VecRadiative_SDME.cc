@@ -9,7 +9,7 @@
 
 #include "IUAmpTools/Kinematics.h"
 #include "AMPTOOLS_AMPS/VecRadiative_SDME.h"
-#include "UTILITIES/BeamProperties.h"
+#include "AMPTOOLS_AMPS/BeamPolFraction.h"
 
 VecRadiative_SDME::VecRadiative_SDME( const vector< string >& args ) :
 UserAmplitude< VecRadiative_SDME >( args )
@@ -47,14 +47,15 @@ UserAmplitude< VecRadiative_SDME >( args )
   registerParameter( m_polAngle );
   
   if (m_polFraction > 0.0)
+  {
     cout << "Fitting with constant polarization" << endl;
+    m_polFrac = BeamPolFraction::fixed( m_polFraction );
+  }
   else
   {
     cout << "Fitting with polarization from BeamProperties class" << endl;
     // BeamProperties configuration file
-    TString beamConfigFile = args[10].c_str();
-    BeamProperties beamProp(beamConfigFile);
-    m_polFrac_vs_E = (TH1D*)beamProp.GetPolFrac();
+    m_polFrac = BeamPolFraction::fromBeamConfig( args[10] );
   }
 }
 
@@ -150,19 +151,7 @@ VecRadiative_SDME::calcUserVars( GDouble** pKin, GDouble* userVars ) const {
   userVars[kPhi] = phi;
   userVars[kBigPhi] = bigPhi;
   
-  GDouble polFrac;
-  if(m_polFraction > 0.) { // for fitting with constant polarization
-
-    polFrac = m_polFraction;
-  }
-  else{
-
-    int bin = m_polFrac_vs_E->GetXaxis()->FindBin( pKin[0][0] );
-    if( bin == 0 || bin > m_polFrac_vs_E->GetXaxis()->GetNbins() ) polFrac = 0.;
-    else polFrac = m_polFrac_vs_E->GetBinContent( bin );
-  }
-  
-  userVars[kPolFrac] = polFrac;
+  userVars[kPolFrac] = (*m_polFrac)( pKin[0][0] );
 }
 
 #ifdef GPU_ACCELERATION
@@ -24,6 +24,7 @@ using std::complex;
 using namespace std;
 
 class Kinematics;
+class BeamPolFraction;
 
 class VecRadiative_SDME : public UserAmplitude< VecRadiative_SDME >
 {
@@ -72,7 +73,7 @@ private:
   AmpParameter m_polAngle;
 
   GDouble m_polFraction;
-  TH1D* m_polFrac_vs_E;
+  const BeamPolFraction* m_polFrac;
 };
 
 #endif
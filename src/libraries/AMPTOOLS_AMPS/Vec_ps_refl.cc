@@ -14,8 +14,9 @@
 #include "AMPTOOLS_AMPS/wignerD.h"
 #include "AMPTOOLS_AMPS/omegapiAngles.h"
 #include "AMPTOOLS_AMPS/barrierFactor.h"
+#include "AMPTOOLS_AMPS/breakupMomentum.h"
 
-#include "UTILITIES/BeamProperties.h"
+#include "AMPTOOLS_AMPS/BeamPolFraction.h"
 
 Vec_ps_refl::Vec_ps_refl( const vector< string >& args ) :
 UserAmplitude< Vec_ps_refl >( args )
@@ -29,6 +30,8 @@ UserAmplitude< Vec_ps_refl >( args )
   m_r = atoi( args[3].c_str() ); // real (+1) or imaginary (-1)
   m_s = atoi( args[4].c_str() ); // sign for polarization in amplitude
 
+  m_polFrac = NULL;
+
   // 4 possibilities to initialize this amplitude:
   // (with <J>: total spin, <m>: spin projection, <r>: +1/-1 for real/imaginary part; <s>: +1/-1 sign in P_gamma term)
   //
@@ -91,11 +94,8 @@ UserAmplitude< Vec_ps_refl >( args )
     polFraction = atof(args[6].c_str());
   
     // BeamProperties configuration file
-    if (polFraction == 0){
-      TString beamConfigFile = args[6].c_str();
-      BeamProperties beamProp(beamConfigFile);
-      polFrac_vs_E = (TH1D*)beamProp.GetPolFrac();
-    }
+    if (polFraction == 0)
+      m_polFrac = BeamPolFraction::fromBeamConfig( args[6] );
   }
 
 
@@ -107,7 +107,16 @@ UserAmplitude< Vec_ps_refl >( args )
   // m_s = +1 for 1 + Pgamma
   // m_s = -1 for 1 - Pgamma
   assert( abs( m_s ) == 1 );
-  
+
+  for( int lambda = -1; lambda <= 1; lambda++ ){
+
+    m_helAmp[lambda+1] = clebschGordan( m_l, 1, 0, lambda, m_j, lambda );
+    m_d1[lambda+1] = CPUWignerD( 1, lambda, 0 );
+    if( m_j <= CPU_MAX_J && abs( lambda ) <= m_j )
+      m_dJ[lambda+1] = CPUWignerD( m_j, m_m, lambda );
+  }
+
+  m_profAmps = ampProfileCounter( "calcAmplitudeAll", name(), args );
 }
 
 void
@@ -128,7 +137,7 @@ Vec_ps_refl::calcUserVars( GDouble** pKin, GDouble* userVars ) const {
   }
   else{
     beam.SetPxPyPzE( pKin[0][1], pKin[0][2], pKin[0][3], pKin[0][0] ); 
-    beam_polFraction = polFraction;
+    beam_polFraction = ( m_polFrac != NULL ? (*m_polFrac)( beam.E() ) : polFraction );
     beam_polAngle = polAngle;
   }
   
@@ -205,6 +214,12 @@ Vec_ps_refl::calcUserVars( GDouble** pKin, GDouble* userVars ) const {
   userVars[uv_MVec] = vec.M();
   userVars[uv_MPs] = ps.M();
 
+  // barrier factors for all partial waves: the breakup momentum is
+  // computed once here instead of for every amplitude and iteration
+  GDouble q = breakupMomentum( X.M(), vec.M(), ps.M() );
+  for( int L = 0; L <= kMaxBarrierL; ++L )
+    userVars[uv_barrierL0 + L] = barrierFactor( q, L );
+
   userVars[uv_beam_polFraction] = beam_polFraction;
   userVars[uv_beam_polAngle] = beam_polAngle;
 
@@ -225,9 +240,6 @@ Vec_ps_refl::calcAmplitude( GDouble** pKin, GDouble* userVars ) const
   GDouble prod_angle = userVars[uv_prod_Phi];
   GDouble dalitz_z = userVars[uv_dalitz_z];
   GDouble dalitz_sin3theta = userVars[uv_dalitz_sin3theta];
-  GDouble MX = userVars[uv_MX];
-  GDouble MVec = userVars[uv_MVec];
-  GDouble MPs = userVars[uv_MPs];
   GDouble beam_polFraction = userVars[uv_beam_polFraction];
   GDouble beam_polAngle = userVars[uv_beam_polAngle];
 
@@ -257,7 +269,7 @@ Vec_ps_refl::calcAmplitude( GDouble** pKin, GDouble* userVars ) const
 	  zjm = i*imag(amplitude * rotateY);
 
   // E852 Nozar thesis has sqrt(2*s+1)*sqrt(2*l+1)*F_l(p_omega)*sqrt(omega)
-  double kinFactor = barrierFactor(MX, m_l, MVec, MPs);
+  double kinFactor = ( m_l <= kMaxBarrierL ? userVars[uv_barrierL0 + m_l] : 0 );
   //kinFactor *= sqrt(3.) * sqrt(2.*m_l + 1.);
   Factor *= kinFactor;
 
@@ -265,6 +277,34 @@ Vec_ps_refl::calcAmplitude( GDouble** pKin, GDouble* userVars ) const
 }
 
 
+void
+Vec_ps_refl::calcAmplitudeAll( GDouble* pdData, GDouble* pdAmps, int iNEvents,
+                               const vector< vector< int > >* pvPermutations,
+                               GDouble* pdUserVars ) const
+{
+  AmpProfileScope profile( m_profAmps, iNEvents );
+
+  if( pdUserVars == NULL || m_j > CPU_MAX_J || !cpuKernelsEnabled() ){
+
+    Amplitude::calcAmplitudeAll( pdData, pdAmps, iNEvents,
+                                 pvPermutations, pdUserVars );
+    return;
+  }
+
+  GDouble alpha = 0, beta = 0, gamma = 0, delta = 0;
+  if( m_3pi ){
+
+    alpha = dalitz_alpha;
+    beta  = dalitz_beta;
+    gamma = dalitz_gamma;
+    delta = dalitz_delta;
+  }
+
+  CPUVec_ps_refl_exec( pdUserVars, pdAmps, iNEvents * pvPermutations->size(),
+                       kNumUserVars, m_dJ, m_d1, m_helAmp, m_m, m_l, m_r, m_s,
+                       m_3pi, alpha, beta, gamma, delta );
+}
+
 void Vec_ps_refl::updatePar( const AmpParameter& par ){
 
   // could do expensive calculations here on parameter updates  
@@ -6,6 +6,9 @@
 #include "IUAmpTools/AmpParameter.h"
 #include "GPUManager/GPUCustomTypes.h"
 
+#include "AMPTOOLS_AMPS/cpuKernel.h"
+#include "AMPTOOLS_AMPS/ampProfiler.h"
+
 #include "TH1D.h"
 #include <string>
 #include <complex>
@@ -27,14 +30,18 @@ void
 GPUVec_ps_refl_exec( dim3 dimGrid, dim3 dimBlock, GPU_AMP_PROTO, int m_j, int m_m, int m_l, int m_r, int m_s, int m_3pi, GDouble dalitz_alpha, GDouble dalitz_beta, GDouble dalitz_gamma, GDouble dalitz_delta, GDouble polAngle, GDouble polFraction );
 #endif
 
+void
+CPUVec_ps_refl_exec( CPU_AMP_PROTO, const CPUWignerD* dJ, const CPUWignerD* d1, const GDouble* helAmp, int m_m, int m_l, int m_r, int m_s, int m_3pi, GDouble dalitz_alpha, GDouble dalitz_beta, GDouble dalitz_gamma, GDouble dalitz_delta );
+
 class Kinematics;
+class BeamPolFraction;
 
 class Vec_ps_refl : public UserAmplitude< Vec_ps_refl >
 {
     
 public:
 	
-	Vec_ps_refl() : UserAmplitude< Vec_ps_refl >() { };
+	Vec_ps_refl() : UserAmplitude< Vec_ps_refl >(), m_profAmps( NULL ) { };
 	Vec_ps_refl( const vector< string >& args );
 	Vec_ps_refl( int m_j, int m_m, int m_l, int m_r, int m_s, int m_3pi, GDouble dalitz_alpha, GDouble dalitz_beta, GDouble dalitz_gamma, GDouble dalitz_delta, GDouble polAngle, GDouble polFraction);
 	
@@ -49,8 +56,12 @@ public:
 	// Use this for indexing a user-defined data array and notifying
 	// the framework of the number of user-defined variables.
 	
-	enum UserVars { uv_cosTheta = 0, uv_Phi = 1, uv_cosThetaH = 2, uv_PhiH = 3, uv_prod_Phi = 4, uv_dalitz_z = 5, uv_dalitz_sin3theta = 6, uv_MX = 7, uv_MVec = 8, uv_MPs = 9, uv_beam_polFraction = 10, uv_beam_polAngle = 11, kNumUserVars };
+	enum UserVars { uv_cosTheta = 0, uv_Phi = 1, uv_cosThetaH = 2, uv_PhiH = 3, uv_prod_Phi = 4, uv_dalitz_z = 5, uv_dalitz_sin3theta = 6, uv_MX = 7, uv_MVec = 8, uv_MPs = 9, uv_beam_polFraction = 10, uv_beam_polAngle = 11, uv_barrierL0 = 12, uv_barrierL1 = 13, uv_barrierL2 = 14, uv_barrierL3 = 15, uv_barrierL4 = 16, kNumUserVars };
 	unsigned int numUserVars() const { return kNumUserVars; }
+
+	// barrier factors are stored for every L up to this value so that the
+	// user variables stay independent of the amplitude arguments
+	enum { kMaxBarrierL = 4 };
 	
 	// This function needs to be defined -- see comments and discussion
 	// in the .cc file.
@@ -71,6 +82,11 @@ public:
 
 	void updatePar( const AmpParameter& par );
 
+	// evaluate blocks of events with the vectorized CPU kernel
+	void calcAmplitudeAll( GDouble* pdData, GDouble* pdAmps, int iNEvents,
+	                       const vector< vector< int > >* pvPermutations,
+	                       GDouble* pdUserVars ) const;
+
 #ifdef GPU_ACCELERATION
 
 	void launchGPUKernel( dim3 dimGrid, dim3 dimBlock, GPU_AMP_PROTO ) const;
@@ -97,7 +113,17 @@ private:
     double polFraction;
 	double polAngle;
     bool m_polInTree;
-	TH1D *polFrac_vs_E;
+	// shared, read-only table when a BeamProperties file is given
+	const BeamPolFraction* m_polFrac;
+
+	// Wigner d functions and helicity couplings for lambda = -1, 0, 1
+	// used by the CPU kernel
+	CPUWignerD m_dJ[3];
+	CPUWignerD m_d1[3];
+	GDouble m_helAmp[3];
+
+	// NULL unless profiling is enabled
+	AmpProfileCounter* m_profAmps;
 };
 
 #endif
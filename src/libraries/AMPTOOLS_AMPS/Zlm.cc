@@ -10,8 +10,7 @@
 #include "IUAmpTools/Kinematics.h"
 #include "AMPTOOLS_AMPS/Zlm.h"
 #include "AMPTOOLS_AMPS/wignerD.h"
-
-#include "TFile.h"
+#include "AMPTOOLS_AMPS/BeamPolFraction.h"
 
 Zlm::Zlm( const vector< string >& args ) :
    UserAmplitude< Zlm >( args )
@@ -30,6 +29,7 @@ Zlm::Zlm( const vector< string >& args ) :
    //    Usage: amplitude <reaction>::<sum>::<ampName> Zlm <J> <m> <r> <s>
    if(args.size() == 4) {
       m_polInTree = true;
+      m_polFrac = NULL;
    
    // 2: six arguments, polarization fixed per amplitude and passed as flag
    //    Usage: amplitude <reaction>::<sum>::<ampName> Zlm <J> <m> <r> <s> <polAngle> <polFraction>
@@ -37,6 +37,7 @@ Zlm::Zlm( const vector< string >& args ) :
       m_polInTree = false;
       m_polAngle = atof( args[4].c_str() );
       m_polFraction = atof( args[5].c_str() );
+      m_polFrac = BeamPolFraction::fixed( m_polFraction );
    
    // 3: eight arguments, read polarization from histogram <hist> in file <rootFile>
    //    Usage: amplitude <reaction>::<sum>::<ampName> Zlm <J> <m> <r> <s> <polAngle> <polFraction=0.> <rootFile> <hist>
@@ -44,9 +45,7 @@ Zlm::Zlm( const vector< string >& args ) :
       m_polInTree = false;
       m_polAngle = atof( args[4].c_str() );
       m_polFraction = 0.; 
-      TFile* f = new TFile( args[6].c_str() );
-      m_polFrac_vs_E = (TH1D*)f->Get( args[7].c_str() );
-      assert( m_polFrac_vs_E != NULL );
+      m_polFrac = BeamPolFraction::fromHistogram( args[6], args[7] );
    }
 
    // make sure values are reasonable
@@ -57,6 +56,10 @@ Zlm::Zlm( const vector< string >& args ) :
    // m_s = +1 for 1 + Pgamma
    // m_s = -1 for 1 - Pgamma
    assert( abs( m_s ) == 1 );
+
+   if( m_j <= CPU_MAX_J ) m_dlm0 = CPUWignerD( m_j, m_m, 0 );
+
+   m_profAmps = ampProfileCounter( "calcAmplitudeAll", name(), args );
 }
 
 
@@ -128,20 +131,30 @@ Zlm::calcUserVars( GDouble** pKin, GDouble* userVars ) const {
    if(m_polInTree) {
       pGamma = eps.Mag();
    } else {
-      if(m_polFraction > 0.) { // for fitting with constant polarization 
-         pGamma = m_polFraction;
-      } else{
-         int bin = m_polFrac_vs_E->GetXaxis()->FindBin(pKin[0][0]);
-         if (bin == 0 || bin > m_polFrac_vs_E->GetXaxis()->GetNbins()){
-            pGamma = 0.;
-         } else 
-            pGamma = m_polFrac_vs_E->GetBinContent(bin);
-      }
+      pGamma = (*m_polFrac)( pKin[0][0] );
    }
 
    userVars[kPgamma] = pGamma;
 }
 
+void
+Zlm::calcAmplitudeAll( GDouble* pdData, GDouble* pdAmps, int iNEvents,
+                       const vector< vector< int > >* pvPermutations,
+                       GDouble* pdUserVars ) const {
+
+   AmpProfileScope profile( m_profAmps, iNEvents );
+
+   if( pdUserVars == NULL || m_j > CPU_MAX_J || !cpuKernelsEnabled() ){
+
+      Amplitude::calcAmplitudeAll( pdData, pdAmps, iNEvents,
+                                   pvPermutations, pdUserVars );
+      return;
+   }
+
+   CPUZlm_exec( pdUserVars, pdAmps, iNEvents * pvPermutations->size(),
+                kNumUserVars, m_dlm0, m_j, m_m, m_r, m_s );
+}
+
 #ifdef GPU_ACCELERATION
 void
 Zlm::launchGPUKernel( dim3 dimGrid, dim3 dimBlock, GPU_AMP_PROTO ) const {
@@ -6,6 +6,9 @@
 #include "IUAmpTools/AmpParameter.h"
 #include "GPUManager/GPUCustomTypes.h"
 
+#include "AMPTOOLS_AMPS/cpuKernel.h"
+#include "AMPTOOLS_AMPS/ampProfiler.h"
+
 #include "TH1D.h"
 #include <string>
 #include <complex>
@@ -17,6 +20,8 @@ GPUZlm_exec( dim3 dimGrid, dim3 dimBlock, GPU_AMP_PROTO,
       int j, int m, int r, int s );
 #endif // GPU_ACCELERATION
 
+void
+CPUZlm_exec( CPU_AMP_PROTO, const CPUWignerD& dlm0, int j, int m, int r, int s );
 
 using std::complex;
 using namespace std;
@@ -30,13 +35,14 @@ using namespace std;
 // s=+/-1 multiplies with sqrt(1+/- P_gamma)
 
 class Kinematics;
+class BeamPolFraction;
 
 class Zlm : public UserAmplitude< Zlm >
 {
 
    public:
 
-      Zlm() : UserAmplitude< Zlm >() { };
+      Zlm() : UserAmplitude< Zlm >(), m_profAmps( NULL ) { };
       Zlm( const vector< string >& args );
 
       enum UserVars { kPgamma = 0, kCosTheta, kPhi, kBigPhi, kNumUserVars };
@@ -54,6 +60,11 @@ class Zlm : public UserAmplitude< Zlm >
       // the user variables above are the same for all instances of this amplitude
       bool areUserVarsStatic() const { return true; }
 
+      // evaluate blocks of events with the vectorized CPU kernel
+      void calcAmplitudeAll( GDouble* pdData, GDouble* pdAmps, int iNEvents,
+                             const vector< vector< int > >* pvPermutations,
+                             GDouble* pdUserVars ) const;
+
 #ifdef GPU_ACCELERATION
 
       void launchGPUKernel( dim3 dimGrid, dim3 dimBlock, GPU_AMP_PROTO ) const;
@@ -73,7 +84,13 @@ class Zlm : public UserAmplitude< Zlm >
       double m_polFraction;
       bool m_polInTree;
 
-      TH1D* m_polFrac_vs_E;
+      const BeamPolFraction* m_polFrac;
+
+      // d^j_m0 used by the CPU kernel
+      CPUWignerD m_dlm0;
+
+      // NULL unless profiling is enabled
+      AmpProfileCounter* m_profAmps;
 };
 
 #endif
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "AMPTOOLS_AMPS/ampProfiler.h"
+
+using namespace std;
+
+namespace {
+
+atomic< bool > profilerEnabled( false );
+
+mutex counterMutex;
+
+// owns the counters, which are never removed so that the amplitudes can
+// keep the pointers
+map< string, unique_ptr< AmpProfileCounter > >& counterMap(){
+
+  static map< string, unique_ptr< AmpProfileCounter > > counters;
+  return counters;
+}
+
+vector< AmpProfileCounter* > sortedCounters(){
+
+  vector< AmpProfileCounter* > counters;
+
+  lock_guard< mutex > lock( counterMutex );
+  map< string, unique_ptr< AmpProfileCounter > >& all = counterMap();
+  for( map< string, unique_ptr< AmpProfileCounter > >::iterator it = all.begin();
+       it != all.end(); ++it ){
+
+    counters.push_back( it->second.get() );
+  }
+
+  stable_sort( counters.begin(), counters.end(),
+               []( const AmpProfileCounter* a, const AmpProfileCounter* b ){
+                 return a->seconds() > b->seconds(); } );
+
+  return counters;
+}
+
+string jsonString( const string& text ){
+
+  string quoted( "\"" );
+  for( size_t i = 0; i < text.size(); ++i ){
+
+    if( text[i] == '"' || text[i] == '\\' ) quoted += '\\';
+    quoted += text[i];
+  }
+
+  return quoted + "\"";
+}
+
+}
+
+AmpProfileCounter::AmpProfileCounter( const string& category, const string& className,
+                                      const string& instance ) :
+m_category( category ),
+m_className( className ),
+m_instance( instance ),
+m_calls( 0 ),
+m_events( 0 ),
+m_nanoseconds( 0 )
+{}
+
+bool
+ampProfilerEnabled(){
+
+  return profilerEnabled;
+}
+
+void
+ampProfilerEnable(){
+
+  profilerEnabled = true;
+}
+
+AmpProfileCounter*
+ampProfileCounter( const string& category, const string& className,
+                   const string& instance ){
+
+  if( !profilerEnabled ) return NULL;
+
+  string key = category + '\0' + className + '\0' + instance;
+
+  lock_guard< mutex > lock( counterMutex );
+
+  unique_ptr< AmpProfileCounter >& counter = counterMap()[key];
+  if( !counter ) counter.reset( new AmpProfileCounter( category, className, instance ) );
+
+  return counter.get();
+}
+
+AmpProfileCounter*
+ampProfileCounter( const string& category, const string& className,
+                   const vector< string >& args ){
+
+  if( !profilerEnabled ) return NULL;
+
+  string instance;
+  for( size_t i = 0; i < args.size(); ++i ){
+
+    if( i > 0 ) instance += " ";
+    instance += args[i];
+  }
+
+  return ampProfileCounter( category, className, instance );
+}
+
+void
+ampProfilerReset(){
+
+  lock_guard< mutex > lock( counterMutex );
+  map< string, unique_ptr< AmpProfileCounter > >& all = counterMap();
+  for( map< string, unique_ptr< AmpProfileCounter > >::iterator it = all.begin();
+       it != all.end(); ++it ){
+
+    it->second->reset();
+  }
+}
+
+void
+ampProfilerPrint( ostream& out ){
+
+  vector< AmpProfileCounter* > counters = sortedCounters();
+
+  out << "PROFILE:  " << "      seconds        calls       events  category / class / instance" << endl;
+
+  char line[128];
+  for( size_t i = 0; i < counters.size(); ++i ){
+
+    if( counters[i]->calls() == 0 ) continue;
+
+    snprintf( line, sizeof( line ), "PROFILE:  %13.4f %12lli %12lli  ",
+              counters[i]->seconds(), counters[i]->calls(), counters[i]->events() );
+
+    out << line << counters[i]->category() << " / " << counters[i]->className();
+    if( counters[i]->instance() != "" ) out << " / " << counters[i]->instance();
+    out << endl;
+  }
+}
+
+void
+ampProfilerWriteJSON( ostream& out ){
+
+  vector< AmpProfileCounter* > counters = sortedCounters();
+
+  out << "{" << endl << "  \"counters\": [";
+
+  bool first = true;
+  for( size_t i = 0; i < counters.size(); ++i ){
+
+    if( counters[i]->calls() == 0 ) continue;
+
+    out << ( first ? "" : "," ) << endl;
+    first = false;
+
+    out << "    { \"category\": " << jsonString( counters[i]->category() )
+        << ", \"class\": " << jsonString( counters[i]->className() )
+        << ", \"instance\": " << jsonString( counters[i]->instance() )
+        << ", \"calls\": " << counters[i]->calls()
+        << ", \"events\": " << counters[i]->events()
+        << ", \"seconds\": " << counters[i]->seconds() << " }";
+  }
+
+  out << endl << "  ]" << endl << "}" << endl;
+}
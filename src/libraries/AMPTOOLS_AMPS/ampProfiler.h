@@ -0,0 +1,115 @@
+#if !defined(AMPPROFILER)
+#define AMPPROFILER
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+using std::ostream;
+
+// Optional timing of a fit.  Amplitudes and fit programs ask for a
+// counter for each category of work (calcAmplitudeAll, setup,
+// minimization) and time it with an AmpProfileScope.  Counters are
+// identified by the category, the class and the instance, which for
+// amplitudes are the arguments in the configuration file.  The amplitudes
+// time calcAmplitudeAll, their batch entry point, and nothing else; the
+// likelihood evaluations and the normalization integrals are inside
+// AmpTools and are not timed on their own.
+//
+// Profiling is switched on by a program calling ampProfilerEnable()
+// before the amplitudes are created, which fit and fitMPI do for -P.
+// Otherwise ampProfileCounter returns NULL and a scope costs a single
+// comparison.
+
+class AmpProfileCounter {
+
+public:
+
+  AmpProfileCounter( const string& category, const string& className,
+                     const string& instance );
+
+  void add( long long events, long long nanoseconds ){
+
+    m_calls.fetch_add( 1, std::memory_order_relaxed );
+    m_events.fetch_add( events, std::memory_order_relaxed );
+    m_nanoseconds.fetch_add( nanoseconds, std::memory_order_relaxed );
+  }
+
+  const string& category() const { return m_category; }
+  const string& className() const { return m_className; }
+  const string& instance() const { return m_instance; }
+
+  long long calls() const { return m_calls; }
+  long long events() const { return m_events; }
+  double seconds() const { return 1E-9 * m_nanoseconds; }
+
+  void reset(){ m_calls = 0; m_events = 0; m_nanoseconds = 0; }
+
+private:
+
+  string m_category;
+  string m_className;
+  string m_instance;
+
+  std::atomic< long long > m_calls;
+  std::atomic< long long > m_events;
+  std::atomic< long long > m_nanoseconds;
+};
+
+bool ampProfilerEnabled();
+void ampProfilerEnable();
+
+// return NULL if profiling is disabled; counters with the same category,
+// class and instance are shared
+AmpProfileCounter* ampProfileCounter( const string& category,
+                                      const string& className,
+                                      const string& instance = "" );
+AmpProfileCounter* ampProfileCounter( const string& category,
+                                      const string& className,
+                                      const vector< string >& args );
+
+void ampProfilerReset();
+
+// a table sorted by time and a JSON document with one entry per counter
+void ampProfilerPrint( ostream& out );
+void ampProfilerWriteJSON( ostream& out );
+
+class AmpProfileScope {
+
+public:
+
+  AmpProfileScope( AmpProfileCounter* counter, long long events = 0 ) :
+  m_counter( counter ), m_events( events )
+  {
+    if( m_counter ) m_start = std::chrono::steady_clock::now();
+  }
+
+  ~AmpProfileScope(){ stop(); }
+
+  // ends the timing before the end of the scope, e.g. when the object
+  // being timed has to outlive it
+  void stop(){
+
+    if( m_counter == NULL ) return;
+
+    m_counter->add( m_events,
+                    std::chrono::duration_cast< std::chrono::nanoseconds >
+                    ( std::chrono::steady_clock::now() - m_start ).count() );
+    m_counter = NULL;
+  }
+
+private:
+
+  AmpProfileScope( const AmpProfileScope& );
+  AmpProfileScope& operator=( const AmpProfileScope& );
+
+  AmpProfileCounter* m_counter;
+  long long m_events;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include "AMPTOOLS_AMPS/cpuKernel.h"
+
+static bool
+readCPUKernelSetting(){
+
+  const char* setting = getenv( "AMPTOOLS_CPU_KERNELS" );
+  if( setting == NULL ) return true;
+
+  return std::string( setting ) != "0";
+}
+
+bool
+cpuKernelsEnabled(){
+
+  // evaluated once, C++11 guarantees thread safe initialization
+  static const bool enabled = readCPUKernelSetting();
+  return enabled;
+}
+
+static double
+factorial( int n ){
+
+  double result = 1;
+  for( int i = 2; i <= n; ++i ) result *= i;
+  return result;
+}
+
+CPUWignerD::CPUWignerD( int j, int m, int n ) :
+m_j( j )
+{
+  assert( j >= 0 && j <= CPU_MAX_J );
+  assert( abs( m ) <= j && abs( n ) <= j );
+
+  // d^j_mn(theta) = sum_k (-1)^(m-n+k)
+  //   sqrt( (j+m)! (j-m)! (j+n)! (j-n)! ) / ( (j+n-k)! k! (m-n+k)! (j-m-k)! )
+  //   cos(theta/2)^(2j+n-m-2k) sin(theta/2)^(m-n+2k)
+
+  double norm = sqrt( factorial( j + m ) * factorial( j - m ) *
+                      factorial( j + n ) * factorial( j - n ) );
+
+  for( int k = 0; k <= 2 * j; ++k ){
+
+    if( j + n - k < 0 || m - n + k < 0 || j - m - k < 0 ) continue;
+
+    double sign = ( ( m - n + k ) % 2 == 0 ? 1 : -1 );
+
+    m_coef.push_back( sign * norm /
+                      ( factorial( j + n - k ) * factorial( k ) *
+                        factorial( m - n + k ) * factorial( j - m - k ) ) );
+    m_cPow.push_back( 2 * j + n - m - 2 * k );
+    m_sPow.push_back( m - n + 2 * k );
+  }
+}
@@ -0,0 +1,216 @@
+#if !defined(CPUKERNEL)
+#define CPUKERNEL
+
+#include <cmath>
+#include <vector>
+
+#include "GPUManager/GPUCustomTypes.h"
+
+using std::vector;
+
+// Helpers for the block-vectorized CPU amplitude kernels (CPU*_kernel.cc).
+// These mirror the CUDA kernels: instead of one thread per event the
+// events are processed in blocks of CPU_BLOCK_SIZE rows.  Each block is
+// transposed from the AmpTools user variable layout (all variables of one
+// event are contiguous) into one contiguous array per variable so that the
+// inner loops can be vectorized by the compiler.  The instruction set
+// (SSE, AVX2, AVX-512) follows the compiler flags, e.g. -march=native;
+// without OpenMP the loops are ordinary scalar loops.
+//
+// Blocks are distributed over threads when built with -fopenmp.  Setting
+// the environment variable AMPTOOLS_CPU_KERNELS=0 switches back to the
+// per-event calcAmplitude path, which is useful for cross checks.
+
+#define CPU_BLOCK_SIZE 64
+
+// highest spin supported by CPUWignerD
+#define CPU_MAX_J 8
+#define CPU_MAX_HALF_POWER ( 2 * CPU_MAX_J + 1 )
+
+#ifdef AMPTOOLS_OMP_SIMD
+#define CPU_SIMD _Pragma("omp simd")
+#else
+#define CPU_SIMD
+#endif
+
+#ifdef _OPENMP
+#define CPU_PARALLEL_BLOCKS _Pragma("omp parallel for schedule(static)")
+#else
+#define CPU_PARALLEL_BLOCKS
+#endif
+
+// the AmpTools user variable and amplitude blocks are stored event by event
+// for each permutation in turn, which means they can be treated as
+// iNRows = iNEvents * iNPermutations consecutive rows
+
+#define CPU_AMP_PROTO const GDouble* pdUserVars, GDouble* pdAmps, int iNRows, int iNUserVars
+#define CPU_AMP_ARGS pdUserVars, pdAmps, iNRows, iNUserVars
+
+typedef GDouble CPUPowerTable[CPU_MAX_HALF_POWER][CPU_BLOCK_SIZE];
+
+bool cpuKernelsEnabled();
+
+inline void
+cpuLoadUserVar( const GDouble* pdUserVars, int iNUserVars, int iVar,
+                int iFirst, int iN, GDouble* out ){
+
+  const GDouble* p = pdUserVars + iFirst * iNUserVars + iVar;
+  for( int i = 0; i < iN; ++i ) out[i] = p[i * iNUserVars];
+}
+
+inline void
+cpuStoreAmps( GDouble* pdAmps, int iFirst, int iN,
+              const GDouble* re, const GDouble* im ){
+
+  GDouble* p = pdAmps + 2 * iFirst;
+  CPU_SIMD
+  for( int i = 0; i < iN; ++i ){
+
+    p[2*i]   = re[i];
+    p[2*i+1] = im[i];
+  }
+}
+
+// fill tables of cos(theta/2)^p and sin(theta/2)^p, p = 0 ... maxPower,
+// from cos(theta); theta is in [0,pi] so both half angle terms are positive
+
+inline void
+cpuHalfAnglePowers( int iN, const GDouble* cosTheta, int maxPower,
+                    CPUPowerTable& cPow, CPUPowerTable& sPow ){
+
+  CPU_SIMD
+  for( int i = 0; i < iN; ++i ){
+
+    cPow[0][i] = 1;
+    sPow[0][i] = 1;
+    cPow[1][i] = sqrt( fabs( 0.5 * ( 1 + cosTheta[i] ) ) );
+    sPow[1][i] = sqrt( fabs( 0.5 * ( 1 - cosTheta[i] ) ) );
+  }
+
+  for( int p = 2; p <= maxPower; ++p ){
+
+    CPU_SIMD
+    for( int i = 0; i < iN; ++i ){
+
+      cPow[p][i] = cPow[p-1][i] * cPow[1][i];
+      sPow[p][i] = sPow[p-1][i] * sPow[1][i];
+    }
+  }
+}
+
+// breakup momentum and barrier factors for a block; these are the same
+// expressions as breakupMomentum.cc and barrierFactor.cc
+
+inline void
+cpuBreakupMomentum( int iN, const GDouble* mass0, const GDouble* mass1,
+                    const GDouble* mass2, GDouble* q ){
+
+  CPU_SIMD
+  for( int i = 0; i < iN; ++i ){
+
+    GDouble m0sq = mass0[i] * mass0[i];
+    GDouble m1sq = mass1[i] * mass1[i];
+    GDouble m2sq = mass2[i] * mass2[i];
+
+    q[i] = sqrt( fabs( m0sq*m0sq + m1sq*m1sq + m2sq*m2sq -
+                       2.0*m0sq*m1sq - 2.0*m0sq*m2sq - 2.0*m1sq*m2sq ) ) /
+           ( 2.0 * mass0[i] );
+  }
+}
+
+inline void
+cpuBarrierFactor( int iN, int spin, const GDouble* q, GDouble* barrier ){
+
+  // switch outside of the loops so the loop bodies stay branch free
+  switch( spin ){
+
+    case 0:
+      for( int i = 0; i < iN; ++i ) barrier[i] = 1.0;
+      break;
+
+    case 1:
+      CPU_SIMD
+      for( int i = 0; i < iN; ++i ){
+
+        GDouble z = ( q[i]*q[i] ) / ( 0.1973*0.1973 );
+        barrier[i] = sqrt( (2.0*z) / (z + 1.0) );
+      }
+      break;
+
+    case 2:
+      CPU_SIMD
+      for( int i = 0; i < iN; ++i ){
+
+        GDouble z = ( q[i]*q[i] ) / ( 0.1973*0.1973 );
+        barrier[i] = sqrt( (13.0*z*z) / ((z-3.0)*(z-3.0) + 9.0*z) );
+      }
+      break;
+
+    case 3:
+      CPU_SIMD
+      for( int i = 0; i < iN; ++i ){
+
+        GDouble z = ( q[i]*q[i] ) / ( 0.1973*0.1973 );
+        barrier[i] = sqrt( (277.0*z*z*z) /
+                           (z*(z-15.0)*(z-15.0) + 9.0*(2.0*z-5.0)*(2.0*z-5.0)) );
+      }
+      break;
+
+    case 4:
+      CPU_SIMD
+      for( int i = 0; i < iN; ++i ){
+
+        GDouble z = ( q[i]*q[i] ) / ( 0.1973*0.1973 );
+        barrier[i] = sqrt( (12746.0*z*z*z*z) /
+                           ((z*z-45.0*z+105.0)*(z*z-45.0*z+105.0) +
+                            25.0*z*(2.0*z-21.0)*(2.0*z-21.0)) );
+      }
+      break;
+
+    default:
+      for( int i = 0; i < iN; ++i ) barrier[i] = 0.0;
+  }
+}
+
+// Wigner small-d function d^j_mn(theta) for fixed j, m, n written as a
+// polynomial in cos(theta/2) and sin(theta/2).  The coefficients are
+// computed once per amplitude so that evaluating a block of events only
+// needs multiplications; the convention agrees with wignerDSmall.
+
+class CPUWignerD
+{
+
+public:
+
+  CPUWignerD() : m_j( 0 ) {}
+  CPUWignerD( int j, int m, int n );
+
+  // the power tables must extend to at least maxPower()
+  int maxPower() const { return 2 * m_j; }
+
+  void evaluate( int iN, const CPUPowerTable& cPow,
+                 const CPUPowerTable& sPow, GDouble* d ) const {
+
+    for( int i = 0; i < iN; ++i ) d[i] = 0;
+
+    for( unsigned int k = 0; k < m_coef.size(); ++k ){
+
+      const GDouble c = m_coef[k];
+      const GDouble* cp = cPow[m_cPow[k]];
+      const GDouble* sp = sPow[m_sPow[k]];
+
+      CPU_SIMD
+      for( int i = 0; i < iN; ++i ) d[i] += c * cp[i] * sp[i];
+    }
+  }
+
+private:
+
+  int m_j;
+
+  vector< GDouble > m_coef;
+  vector< int > m_cPow;
+  vector< int > m_sPow;
+};
+
+#endif
@@ -8,13 +8,13 @@
 #include <string>
 #include <sstream>
 #include "UTILITIES/CobremsGeneration.hh"
-#include "UTILITIES/BeamProperties.h"
 
 #include "TLorentzVector.h"
 #include "TLorentzRotation.h"
 
 #include "IUAmpTools/AmpParameter.h"
 #include "omegapi_amplitude.h"
+#include "BeamPolFraction.h"
 #include "barrierFactor.h"
 #include "clebschGordan.h"
 #include "wignerD.h"
@@ -35,21 +35,18 @@ omegapi_amplitude::omegapi_amplitude( const vector< string >& args ):
 	if(args.size() == (6+4+3)){
 		polAngle  = atof(args[6+4+1].c_str() ); // azimuthal angle of the photon polarization vector in the lab measured in degrees.
 		polFraction = AmpParameter( args[6+4+2] ); // polarization fraction
+		m_polFrac = NULL;
 		std::cout << "Fixed polarization fraction =" << polFraction << " and pol.angle= " << polAngle << " degrees." << std::endl;
 	}
 	else if (args.size() == (6+4+2)){//beam properties requires halld_sim
 		// BeamProperties configuration file
-		TString beamConfigFile = args[6+4+1].c_str();
-		cout<<beamConfigFile.Data()<<endl;
-		BeamProperties beamProp(beamConfigFile);
-		polFrac_vs_E = (TH1D*)beamProp.GetPolFrac();
-		polAngle = beamProp.GetPolAngle();
+		cout<<args[6+4+1]<<endl;
+		m_polFrac = BeamPolFraction::fromBeamConfig( args[6+4+1] );
+		polAngle = m_polFrac->polAngle();
+		polFraction = 0;
 		std::cout << "Polarisation angle of " << polAngle << " from BeamProperties." << std::endl;
 		if(polAngle == -1)
 			std::cout << "This is an amorphous run. Set beam polarisation to 0." << std::endl;
-		for(Int_t i=0; i<polFrac_vs_E->GetXaxis()->GetNbins()+2; i++){
-			//cout << polFrac_vs_E->GetBinContent(i) << endl;
-		}
 	}
 	else assert(0);
 
@@ -102,16 +99,10 @@ omegapi_amplitude::calcUserVars( GDouble** pKin, GDouble* userVars ) const
 	GDouble Pgamma=polFraction;//fixed beam polarization fraction
 	if(polAngle == -1)
 	Pgamma = 0.;//if beam is amorphous set polarization fraction to 0
-	else if(0) { //polFrac_vs_E!=NULL){
-	//This part causes seg fault with 34 amplitudes or more with gen_amp and gen_omegapi.
-	//Not needed for fixed beam pol angle and frac.
-	int bin = polFrac_vs_E->GetXaxis()->FindBin(beam.E());
-
-	if (bin == 0 || bin > polFrac_vs_E->GetXaxis()->GetNbins()){
-		Pgamma = 0.;
-	}
-	else
-	 Pgamma = polFrac_vs_E->GetBinContent(bin);
+	else if(m_polFrac != NULL) {
+	// the table is loaded once and shared by all instances; every instance
+	// used to build its own histograms, which crashed with many amplitudes
+	Pgamma = (*m_polFrac)(beam.E());
 	}
 
   //Calculate decay angles in helicity frame
@@ -26,6 +26,7 @@ using std::complex;
 using namespace std;
 
 class Kinematics;
+class BeamPolFraction;
 
 class omegapi_amplitude : public UserAmplitude< omegapi_amplitude >
 {
@@ -88,9 +89,8 @@ private:
 
 	double polAngle, polFraction;
   
-  TH1D *totalFlux_vs_E;
-  TH1D *polFlux_vs_E;
-  TH1D *polFrac_vs_E;
+  // shared, read-only table; NULL for a fixed polarization fraction
+  const BeamPolFraction* m_polFrac;
 
 };
 
@@ -0,0 +1,68 @@
+
+#include "AMPTOOLS_DATAIO/AsyncWriteQueue.h"
+
+using namespace std;
+
+AsyncWriteQueue::AsyncWriteQueue( const function< void( const Kinematics& ) >& fill ) :
+  m_fill( fill ),
+  m_done( false )
+{
+  m_batch.reserve( kBatchSize );
+  m_thread = thread( &AsyncWriteQueue::work, this );
+}
+
+AsyncWriteQueue::~AsyncWriteQueue()
+{
+  if( !m_batch.empty() ) submitBatch();
+
+  {
+    lock_guard< mutex > lock( m_mutex );
+    m_done = true;
+  }
+  m_batchReady.notify_one();
+
+  m_thread.join();
+}
+
+void
+AsyncWriteQueue::push( const Kinematics& kin )
+{
+  m_batch.push_back( kin );
+  if( m_batch.size() >= kBatchSize ) submitBatch();
+}
+
+void
+AsyncWriteQueue::submitBatch()
+{
+  {
+    unique_lock< mutex > lock( m_mutex );
+    m_batchDone.wait( lock, [this]{ return m_batches.size() < kMaxBatches; } );
+
+    m_batches.push_back( vector< Kinematics >() );
+    m_batches.back().swap( m_batch );
+  }
+  m_batchReady.notify_one();
+
+  m_batch.reserve( kBatchSize );
+}
+
+void
+AsyncWriteQueue::work()
+{
+  while( true ){
+
+    vector< Kinematics > batch;
+    {
+      unique_lock< mutex > lock( m_mutex );
+      m_batchReady.wait( lock, [this]{ return m_done || !m_batches.empty(); } );
+
+      if( m_batches.empty() ) return;
+
+      batch.swap( m_batches.front() );
+      m_batches.pop_front();
+    }
+    m_batchDone.notify_one();
+
+    for( unsigned int i = 0; i < batch.size(); ++i ) m_fill( batch[i] );
+  }
+}
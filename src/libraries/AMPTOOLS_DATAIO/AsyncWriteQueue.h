@@ -0,0 +1,57 @@
+#if !defined(ASYNCWRITEQUEUE)
+#define ASYNCWRITEQUEUE
+
+#include "IUAmpTools/Kinematics.h"
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+/**
+ * Hands events to a separate thread that fills (and thereby compresses)
+ * the output tree, so event generation and output compression overlap.
+ *
+ * Events are copied and passed on in batches; push() blocks when
+ * kMaxBatches batches are waiting, which bounds the memory use if the
+ * writer cannot keep up.  The events are filled in the order they were
+ * pushed.  The destructor writes all remaining events and stops the thread.
+ */
+
+class AsyncWriteQueue
+{
+
+public:
+
+  enum { kBatchSize = 1000, kMaxBatches = 16 };
+
+  AsyncWriteQueue( const function< void( const Kinematics& ) >& fill );
+  ~AsyncWriteQueue();
+
+  void push( const Kinematics& kin );
+
+private:
+
+  void submitBatch();
+  void work();
+
+  function< void( const Kinematics& ) > m_fill;
+
+  // only used by the producing thread
+  vector< Kinematics > m_batch;
+
+  // protected by m_mutex
+  mutex m_mutex;
+  condition_variable m_batchReady;
+  condition_variable m_batchDone;
+  deque< vector< Kinematics > > m_batches;
+  bool m_done;
+
+  thread m_thread;
+};
+
+#endif
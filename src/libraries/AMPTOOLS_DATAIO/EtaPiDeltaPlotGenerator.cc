@@ -8,7 +8,8 @@
 #include "IUAmpTools/Kinematics.h"
 
 EtaPiDeltaPlotGenerator::EtaPiDeltaPlotGenerator( const FitResults& results ) :
-PlotGenerator( results )
+PlotGenerator( results ),
+m_projections( kNumHists )
 {
     // calls to bookHistogram go here
     
@@ -23,7 +24,16 @@ PlotGenerator( results )
 
 void
 EtaPiDeltaPlotGenerator::projectEvent( Kinematics* kin ){
-    
+
+    // the projections only depend on the event, so later passes with
+    // other amplitude sets reuse them
+    const double* cached = m_projections.find( kin );
+    if( cached != NULL ){
+
+        for( int i = 0; i < kt + 1; ++i ) fillHistogram( i, cached[i] );
+        return;
+    }
+
     TLorentzVector beam   = kin->particle( 0 );
     TLorentzVector protonP4 = kin->particle( 1 );//proton
     TLorentzVector p1 = kin->particle( 2 ); //Eta
@@ -90,12 +100,16 @@ EtaPiDeltaPlotGenerator::projectEvent( Kinematics* kin ){
     TLorentzVector TargetP4;
     TargetP4.SetPxPyPzE(0,0,0,0.938272);
     GDouble t=(recoil-TargetP4).Mag2();
+    // kEtaCosTheta_vs_Mass is not filled
+    double values[kNumHists];
+    values[kEtaPiMass] = ( resonance ).M();
+    values[kDeltaPPMass] = ( recoil ).M();
+    values[kEtaCosTheta] = cosTheta;
+    values[kPhi] = phi;
+    values[kt] = -t;      // fill with -t to make positive
+
+    m_projections.insert( values );
+
     // calls to fillHistogram go here
-    
-    fillHistogram( kEtaPiMass, ( resonance ).M() );
-    
-    fillHistogram( kDeltaPPMass, ( recoil ).M() );
-    fillHistogram( kEtaCosTheta, cosTheta );
-    fillHistogram( kPhi, phi );
-    fillHistogram( kt, -t );      // fill with -t to make positive
+    for( int i = 0; i < kt + 1; ++i ) fillHistogram( i, values[i] );
 }
@@ -9,13 +9,17 @@
 #include "TLorentzVector.h"
 #include "IUAmpTools/Kinematics.h"
 #include "AMPTOOLS_DATAIO/FSRootDataReader.h"
+#include "AMPTOOLS_DATAIO/KinematicsCache.h"
 #include "TSystem.h"
 
 using namespace std;
 
 FSRootDataReader::FSRootDataReader( const vector< string >& args ) :
    UserDataReader< FSRootDataReader >(args),
-   m_eventCounter( 0 ){
+   m_inFriendTree( NULL ),
+   m_eventCounter( 0 ),
+   m_blockFirst( 0 ),
+   m_blockSize( 0 ){
 
       assert((args.size() >= 3 && args.size() <= 4) || (args.size()>=6 && args.size()<=7));
       string inFileName(args[0]);
@@ -38,12 +42,19 @@ FSRootDataReader::FSRootDataReader( const vector< string >& args ) :
       TH1::AddDirectory( kFALSE );
       gSystem->Load( "libTree" );
 
+      vector< string > sources( 1, inFileName );
+      if (args.size() >= 6) sources.push_back( args[3] );
+      m_cache = KinematicsCache::open( name(), args, sources );
+      if (m_cache && m_cache->isComplete()){
+         m_inFile = NULL;
+         m_inTree = NULL;
+         return;
+      }
+
       ifstream fileexists( inFileName.c_str() );
       if (fileexists){
          m_inFile = new TFile( inFileName.c_str() );
          m_inTree = static_cast<TTree*>( m_inFile->Get( inTreeName.c_str() ) );
-         if(args.size()>=5)
-            m_inTree->AddFriend(friendTreeName, friendFileName);
       }
       else{
          cout << "FSRootDataReader WARNING:  Cannot find file... " << inFileName << endl;
@@ -62,57 +73,148 @@ FSRootDataReader::FSRootDataReader( const vector< string >& args ) :
       if(args.size()==7)
         cout << "Opening Tree " << args[0] << " " << args[1] << " " << args[2] << " " << args[3] << " " << args[4] << " " << args[5] << " " << args[6] << endl;
       if (m_inTree){
+
+         // FSRoot trees have many more branches than the four-momenta,
+         // only those are read and prefetched
+         m_inTree->SetBranchStatus( "*", 0 );
+         m_inTree->SetCacheSize( 64 * 1024 * 1024 );
+
          TString sEnPB = fourMomentumPrefix+"EnPB";
          TString sPxPB = fourMomentumPrefix+"PxPB";
          TString sPyPB = fourMomentumPrefix+"PyPB";
          TString sPzPB = fourMomentumPrefix+"PzPB";
-         m_inTree->SetBranchAddress( sEnPB, &m_EnPB );
-         m_inTree->SetBranchAddress( sPxPB, &m_PxPB );
-         m_inTree->SetBranchAddress( sPyPB, &m_PyPB );
-         m_inTree->SetBranchAddress( sPzPB, &m_PzPB );
+         addBranch( sEnPB );
+         addBranch( sPxPB );
+         addBranch( sPyPB );
+         addBranch( sPzPB );
          for (unsigned int i = 0; i < m_numParticles; i++){
             TString sI("");  sI += (i+1);
             TString sEnPi = fourMomentumPrefix+"EnP"+sI;
             TString sPxPi = fourMomentumPrefix+"PxP"+sI;
             TString sPyPi = fourMomentumPrefix+"PyP"+sI;
             TString sPzPi = fourMomentumPrefix+"PzP"+sI;
-            m_inTree->SetBranchAddress( sEnPi, &m_EnP[i] );
-            m_inTree->SetBranchAddress( sPxPi, &m_PxP[i] );
-            m_inTree->SetBranchAddress( sPyPi, &m_PyP[i] );
-            m_inTree->SetBranchAddress( sPzPi, &m_PzP[i] );
-            if(args.size()>=6)
-              m_inTree->SetBranchAddress( friendBranchName, &m_weight );
-            else
-              m_weight = 1.0;
+            addBranch( sEnPi );
+            addBranch( sPxPi );
+            addBranch( sPyPi );
+            addBranch( sPzPi );
          }
+
+         m_inTree->StopCacheLearningPhase();
+         m_columns.resize( m_branches.size() * kBlockSize );
+
+         if(args.size()>=6)
+            readFriendWeights( friendFileName, friendTreeName, friendBranchName );
       }
 
    }
 
 
+FSRootDataReader::~FSRootDataReader(){
+   if (m_cache) delete m_cache;
+   if (m_inFile) m_inFile->Close();
+}
+
+
+void FSRootDataReader::addBranch( const TString& branchName ){
+   TBranch* branch = m_inTree->GetBranch( branchName );
+   if (!branch){
+      cout << "FSRootDataReader ERROR:  tree " << m_inTree->GetName()
+           << " has no branch " << branchName << endl;
+      assert( false );
+   }
+   m_inTree->SetBranchStatus( branchName, 1 );
+   m_inTree->SetBranchAddress( branchName, &m_value );
+   m_inTree->AddBranchToCache( branch );
+   m_branches.push_back( branch );
+}
+
+
+void FSRootDataReader::readFriendWeights( const TString& friendFileName,
+                                          const TString& friendTreeName,
+                                          const TString& friendBranchName ){
+
+   // the weights are read once, instead of through the friend on every entry
+   TFile* friendFile = TFile::Open( friendFileName );
+   assert( friendFile != NULL && !friendFile->IsZombie() );
+   m_inFriendTree = static_cast<TTree*>( friendFile->Get( friendTreeName ) );
+   assert( m_inFriendTree != NULL );
+   assert( m_inFriendTree->GetEntries() == m_inTree->GetEntries() );
+
+   m_inFriendTree->SetBranchStatus( "*", 0 );
+   m_inFriendTree->SetBranchStatus( friendBranchName, 1 );
+   TBranch* branch = m_inFriendTree->GetBranch( friendBranchName );
+   assert( branch != NULL );
+   m_inFriendTree->SetBranchAddress( friendBranchName, &m_weight );
+
+   m_weights.resize( m_inFriendTree->GetEntries() );
+   for (Long64_t i = 0; i < m_inFriendTree->GetEntries(); i++){
+      branch->GetEntry( i );
+      m_weights[i] = m_weight;
+   }
+
+   friendFile->Close();
+   delete friendFile;
+   m_inFriendTree = NULL;
+}
+
+
+void FSRootDataReader::readBlock( unsigned int first ){
+
+   // one branch at a time over the whole block, an entry at a time;
+   // only the branches the reader needs are enabled
+   m_blockFirst = first;
+   m_blockSize = numEvents() - first < kBlockSize ? numEvents() - first : kBlockSize;
+   for (unsigned int b = 0; b < m_branches.size(); b++){
+      double* column = &(m_columns[b*kBlockSize]);
+      for (unsigned int i = 0; i < m_blockSize; i++){
+         m_branches[b]->GetEntry( m_blockFirst + i );
+         column[i] = m_value;
+      }
+   }
+}
+
+
 void FSRootDataReader::resetSource(){
+   if (m_cache) m_cache->rewind();
    m_eventCounter = 0;
 }
 
 
 Kinematics* FSRootDataReader::getEvent(){
+   if (m_cache && m_cache->isComplete()){
+      Kinematics* kin = m_cache->nextEvent();
+      if (kin) m_eventCounter++;
+      return kin;
+   }
    if( m_eventCounter < numEvents() ){
-      m_inTree->GetEntry( m_eventCounter++ );
+      if( m_eventCounter < m_blockFirst || m_eventCounter >= m_blockFirst + m_blockSize )
+         readBlock( m_eventCounter );
+      unsigned int i = m_eventCounter - m_blockFirst;
+
+      // columns are ordered beam E, px, py, pz, then the same for each particle
       vector< TLorentzVector > particleList;
-      particleList.push_back( TLorentzVector( m_PxPB, m_PyPB, m_PzPB, m_EnPB ) );
-      for (unsigned int i = 0; i < m_numParticles; i++){
-         particleList.push_back( TLorentzVector( m_PxP[i], m_PyP[i], m_PzP[i], m_EnP[i] ) );
+      particleList.reserve( m_numParticles + 1 );
+      for (unsigned int j = 0; j <= m_numParticles; j++){
+         particleList.push_back( TLorentzVector( m_columns[(4*j+1)*kBlockSize+i],
+                                                 m_columns[(4*j+2)*kBlockSize+i],
+                                                 m_columns[(4*j+3)*kBlockSize+i],
+                                                 m_columns[(4*j)*kBlockSize+i] ) );
       }
-//      m_weight = 1.0;
-      return new Kinematics( particleList, m_weight );
+      double weight = m_weights.empty() ? 1.0 : m_weights[m_eventCounter];
+      m_eventCounter++;
+      Kinematics* kin = new Kinematics( particleList, weight );
+      if (m_cache) m_cache->record( kin, true );
+      return kin;
    }
    else{
+      if (m_cache) m_cache->finish();
       return NULL;
    }
 }
 
 
 unsigned int FSRootDataReader::numEvents() const{
+   if (m_cache && m_cache->isComplete()) return m_cache->numEvents();
    if (!m_inTree) return 0;
    return static_cast< unsigned int >( m_inTree->GetEntries() );
 }
@@ -2,6 +2,7 @@
 #define FSROOTDATAREADER
 
 #include <string>
+#include <vector>
 #include "TString.h"
 #include "TFile.h"
 #include "TTree.h"
@@ -10,11 +11,18 @@
 
 using namespace std;
 
+class KinematicsCache;
+
 class FSRootDataReader : public UserDataReader< FSRootDataReader >{
 
    public:
 
-      FSRootDataReader() : UserDataReader< FSRootDataReader >() { }
+      enum { kBlockSize = 10000 };
+
+      FSRootDataReader() : UserDataReader< FSRootDataReader >(), m_inFile( NULL ),
+         m_cache( NULL ) { }
+
+      ~FSRootDataReader();
 
       FSRootDataReader( const vector< string >& args );
 
@@ -31,23 +39,33 @@ class FSRootDataReader : public UserDataReader< FSRootDataReader >{
 
    private:
 
+      void addBranch( const TString& branchName );
+      void readFriendWeights( const TString& friendFileName,
+                              const TString& friendTreeName,
+                              const TString& friendBranchName );
+      void readBlock( unsigned int first );
+
       TFile* m_inFile;
       TTree* m_inTree;
       TTree* m_inFriendTree;
       unsigned int m_eventCounter;
       unsigned int m_numParticles;
 
-      double m_EnPB;
-      double m_PxPB;
-      double m_PyPB;
-      double m_PzPB;
-      double m_EnP[50];
-      double m_PxP[50];
-      double m_PyP[50];
-      double m_PzP[50];
+      // the four-momentum branches, beam first, read in blocks of
+      // kBlockSize entries into one column per branch
+      vector< TBranch* > m_branches;
+      double m_value;
+      vector< double > m_columns;
+      unsigned int m_blockFirst;
+      unsigned int m_blockSize;
 
+      // weights of all entries from the friend tree, if given
+      vector< double > m_weights;
       double m_weight;
 
+      // optional binary copy of the events, see KinematicsCache
+      KinematicsCache* m_cache;
+
 };
 
 #endif
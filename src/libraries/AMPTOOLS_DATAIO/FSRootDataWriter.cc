@@ -2,20 +2,27 @@
 #include <cassert>
 
 #include "AMPTOOLS_DATAIO/FSRootDataWriter.h"
+#include "AMPTOOLS_DATAIO/AsyncWriteQueue.h"
 
 #include "TLorentzVector.h"
 #include "TFile.h"
 #include "TTree.h"
 #include "TH1.h"
 #include "TSystem.h"
+#include "TROOT.h"
 
-FSRootDataWriter::FSRootDataWriter( unsigned int numParticles, const string& outFile ){
+FSRootDataWriter::FSRootDataWriter( unsigned int numParticles, const string& outFile,
+                                    const ROOTWriterSettings& settings ){
    assert(numParticles < 50);
 
    TH1::AddDirectory( kFALSE );
    gSystem->Load( "libTree" );
 
+   // the tree is filled and compressed on the thread of the queue
+   if( settings.async() ) ROOT::EnableThreadSafety();
+
    m_outFile = new TFile( outFile.c_str(), "recreate" );
+   settings.applyToFile( m_outFile );
    m_outTree = new TTree( "nt", "nt" );
 
    m_numParticles = numParticles;
@@ -41,13 +48,22 @@ FSRootDataWriter::FSRootDataWriter( unsigned int numParticles, const string& out
 
    m_outTree->Branch( "weight", &m_weight, "weight/D" );
 
+   settings.applyToTree( m_outTree );
+
    m_eventCounter = 0;
 
+   m_queue = NULL;
+   if( settings.async() )
+      m_queue = new AsyncWriteQueue( [this]( const Kinematics& kin ){ fillEvent( kin ); } );
+
 }
 
 
 FSRootDataWriter::~FSRootDataWriter(){
 
+   // fills the events that are still queued
+   if( m_queue != NULL ) delete m_queue;
+
    m_outFile->cd();
    m_outTree->Write();
    m_outFile->Close();
@@ -58,6 +74,17 @@ FSRootDataWriter::~FSRootDataWriter(){
 void
 FSRootDataWriter::writeEvent( const Kinematics& kin ){
 
+   if( m_queue != NULL ) m_queue->push( kin );
+   else fillEvent( kin );
+
+   m_eventCounter++;
+
+}
+
+
+void
+FSRootDataWriter::fillEvent( const Kinematics& kin ){
+
    vector< TLorentzVector > particleList = kin.particleList();
 
    m_EnPB = particleList[0].E();
@@ -79,6 +106,4 @@ FSRootDataWriter::writeEvent( const Kinematics& kin ){
 
    m_outTree->Fill();
 
-   m_eventCounter++;
-
 }
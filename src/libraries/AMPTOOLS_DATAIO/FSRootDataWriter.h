@@ -3,16 +3,21 @@
 
 #include "IUAmpTools/Kinematics.h"
 #include "AMPTOOLS_DATAIO/DataWriter.h"
+#include "AMPTOOLS_DATAIO/ROOTWriterSettings.h"
 
 #include "TTree.h"
 #include "TFile.h"
 
+class AsyncWriteQueue;
+
 class FSRootDataWriter : public DataWriter
 {
 
  public:
 
-  FSRootDataWriter( unsigned int numParticles, const string& outFile );
+  FSRootDataWriter( unsigned int numParticles, const string& outFile,
+                    const ROOTWriterSettings& settings =
+                      ROOTWriterSettings::fromEnvironment() );
   ~FSRootDataWriter();
 
   void writeEvent( const Kinematics& kin );
@@ -21,6 +26,8 @@ class FSRootDataWriter : public DataWriter
 
  private:
 
+  void fillEvent( const Kinematics& kin );
+
   TFile* m_outFile;
   TTree* m_outTree;
   int m_eventCounter;
@@ -40,6 +47,9 @@ class FSRootDataWriter : public DataWriter
   double m_s12;
   double m_s23;
 
+  // fills the tree on a separate thread if asynchronous writing is enabled
+  AsyncWriteQueue* m_queue;
+
 };
 
 #endif
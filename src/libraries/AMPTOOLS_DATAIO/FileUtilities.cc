@@ -0,0 +1,30 @@
+
+#include <fstream>
+#include <sstream>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "AMPTOOLS_DATAIO/FileUtilities.h"
+
+bool
+copyFile( const string& from, const string& to ){
+
+  ifstream in( from.c_str(), ios::binary );
+  if( !in.good() ) return false;
+
+  ofstream out( to.c_str(), ios::binary );
+  out << in.rdbuf();
+  return out.good();
+}
+
+string
+fileStamp( const string& path ){
+
+  struct stat info;
+  if( stat( path.c_str(), &info ) != 0 || !S_ISREG( info.st_mode ) ) return "";
+
+  ostringstream stamp;
+  stamp << ":" << info.st_size << ":" << info.st_mtime;
+  return stamp.str();
+}
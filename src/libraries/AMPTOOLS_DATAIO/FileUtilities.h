@@ -0,0 +1,17 @@
+#if !defined(FILEUTILITIES)
+#define FILEUTILITIES
+
+#include <string>
+
+using namespace std;
+
+// Small file helpers shared by the fitting programs and the caches.
+
+// copies a file byte by byte, false if it cannot be read or written
+bool copyFile( const string& from, const string& to );
+
+// ":<size>:<modification time>" of a regular file, empty otherwise; used
+// in the keys of cached results that depend on the file
+string fileStamp( const string& path );
+
+#endif
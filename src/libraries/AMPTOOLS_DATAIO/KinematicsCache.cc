@@ -0,0 +1,375 @@
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "TLorentzVector.h"
+
+#include "AMPTOOLS_DATAIO/KinematicsCache.h"
+
+using namespace std;
+
+namespace {
+
+  struct CacheHeader {
+
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t keyLength;
+    uint32_t unused;
+    uint64_t numEvents;
+    uint64_t payloadBytes;
+    uint64_t checksum;
+  };
+
+  const char kMagic[8] = { 'A', 'M', 'P', 'K', 'I', 'N', 'C', '\0' };
+  const uint32_t kHasWeight = 1;
+
+  const uint64_t kFNVOffset = 14695981039346656037ULL;
+  const uint64_t kFNVPrime  = 1099511628211ULL;
+
+  // FNV-1a over 64 bit words; the payload is always a multiple of 8 bytes
+  uint64_t checksumWords( uint64_t hash, const char* data, size_t nBytes ){
+
+    for( size_t i = 0; i + 8 <= nBytes; i += 8 ){
+
+      uint64_t word;
+      memcpy( &word, data + i, 8 );
+      hash ^= word;
+      hash *= kFNVPrime;
+    }
+    return hash;
+  }
+
+  uint64_t hashString( const string& s ){
+
+    uint64_t hash = kFNVOffset;
+    for( size_t i = 0; i < s.size(); ++i ){
+
+      hash ^= static_cast< unsigned char >( s[i] );
+      hash *= kFNVPrime;
+    }
+    return hash;
+  }
+
+  size_t paddedLength( size_t n ){ return ( n + 7 ) & ~static_cast< size_t >( 7 ); }
+
+  bool isLittleEndian(){
+
+    const uint32_t one = 1;
+    return *reinterpret_cast< const unsigned char* >( &one ) == 1;
+  }
+}
+
+KinematicsCache*
+KinematicsCache::open( const string& readerName, const vector< string >& args,
+                       const vector< string >& sources ){
+
+  const char* setting = getenv( "AMPTOOLS_KIN_CACHE" );
+  if( setting == NULL || string( setting ) == "" || string( setting ) == "0" )
+    return NULL;
+
+  if( !isLittleEndian() ){
+
+    cout << "KinematicsCache WARNING:  caching is only supported on little endian hosts" << endl;
+    return NULL;
+  }
+
+  assert( sources.size() > 0 );
+
+  // the key contains everything that determines the events
+  ostringstream key;
+  key << readerName;
+  for( unsigned int i = 0; i < args.size(); ++i ) key << "|" << args[i];
+
+  for( unsigned int i = 0; i < sources.size(); ++i ){
+
+    struct stat info;
+    if( stat( sources[i].c_str(), &info ) != 0 ){
+
+      // e.g. xrootd URLs, which cannot be checked for changes
+      cout << "KinematicsCache:  cannot stat " << sources[i]
+           << ", events will not be cached" << endl;
+      return NULL;
+    }
+
+    key << "|" << sources[i] << ":" << info.st_size << ":" << info.st_mtime;
+  }
+
+  ostringstream suffix;
+  suffix << "." << hex << setw( 16 ) << setfill( '0' )
+         << hashString( key.str() ) << ".kincache";
+
+  string fileName;
+  if( string( setting ) == "1" ){
+
+    fileName = sources[0] + suffix.str();
+  }
+  else{
+
+    string base = sources[0];
+    size_t slash = base.rfind( '/' );
+    if( slash != string::npos ) base = base.substr( slash + 1 );
+
+    fileName = string( setting ) + "/" + base + suffix.str();
+  }
+
+  KinematicsCache* cache = new KinematicsCache( fileName, key.str() );
+
+  if( cache->load() ){
+
+    cout << "Reading " << cache->numEvents() << " events from kinematics cache "
+         << fileName << endl;
+  }
+  else{
+
+    cache->startWriting();
+  }
+
+  return cache;
+}
+
+KinematicsCache::KinematicsCache( const string& fileName, const string& key ) :
+  m_fileName( fileName ),
+  m_key( key ),
+  m_map( NULL ),
+  m_mapSize( 0 ),
+  m_data( NULL ),
+  m_end( NULL ),
+  m_cursor( NULL ),
+  m_numEvents( 0 ),
+  m_hasWeight( false ),
+  m_out( NULL ),
+  m_payloadBytes( 0 ),
+  m_checksum( kFNVOffset ),
+  m_writeFailed( false )
+{}
+
+KinematicsCache::~KinematicsCache(){
+
+  if( m_map != NULL ) munmap( m_map, m_mapSize );
+
+  // an incomplete cache is never published
+  abortWriting();
+}
+
+bool
+KinematicsCache::load(){
+
+  int fd = ::open( m_fileName.c_str(), O_RDONLY );
+  if( fd < 0 ) return false;
+
+  struct stat info;
+  if( fstat( fd, &info ) != 0 || info.st_size < (off_t)sizeof( CacheHeader ) ){
+
+    close( fd );
+    return false;
+  }
+
+  m_mapSize = info.st_size;
+  m_map = mmap( NULL, m_mapSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+  close( fd );
+
+  if( m_map == MAP_FAILED ){
+
+    m_map = NULL;
+    return false;
+  }
+
+  madvise( m_map, m_mapSize, MADV_SEQUENTIAL );
+
+  const char* base = static_cast< const char* >( m_map );
+  CacheHeader header;
+  memcpy( &header, base, sizeof( header ) );
+
+  size_t payloadOffset = sizeof( header ) + paddedLength( header.keyLength );
+
+  bool valid =
+    memcmp( header.magic, kMagic, sizeof( kMagic ) ) == 0 &&
+    header.version == kVersion &&
+    header.keyLength == m_key.size() &&
+    payloadOffset + header.payloadBytes == m_mapSize &&
+    memcmp( base + sizeof( header ), m_key.data(), m_key.size() ) == 0 &&
+    checksumWords( kFNVOffset, base + payloadOffset, header.payloadBytes ) == header.checksum;
+
+  if( !valid ){
+
+    cout << "KinematicsCache:  ignoring invalid or outdated cache " << m_fileName << endl;
+    munmap( m_map, m_mapSize );
+    m_map = NULL;
+    m_mapSize = 0;
+    return false;
+  }
+
+  m_numEvents = header.numEvents;
+  m_hasWeight = ( header.flags & kHasWeight );
+  m_data = base + payloadOffset;
+  m_end = m_data + header.payloadBytes;
+  m_cursor = m_data;
+
+  return true;
+}
+
+Kinematics*
+KinematicsCache::nextEvent(){
+
+  assert( isComplete() );
+  if( m_cursor >= m_end ) return NULL;
+
+  uint32_t nPart;
+  memcpy( &nPart, m_cursor, sizeof( nPart ) );
+  m_cursor += 8;
+
+  double weight;
+  memcpy( &weight, m_cursor, sizeof( weight ) );
+  m_cursor += 8;
+
+  vector< TLorentzVector > particleList;
+  particleList.reserve( nPart );
+
+  double p4[4];
+  for( uint32_t i = 0; i < nPart; ++i ){
+
+    memcpy( p4, m_cursor, sizeof( p4 ) );
+    m_cursor += sizeof( p4 );
+    particleList.push_back( TLorentzVector( p4[1], p4[2], p4[3], p4[0] ) );
+  }
+
+  return new Kinematics( particleList, weight );
+}
+
+void
+KinematicsCache::startWriting(){
+
+  ostringstream tmpName;
+  tmpName << m_fileName << ".tmp" << getpid();
+  m_tmpName = tmpName.str();
+
+  m_out = fopen( m_tmpName.c_str(), "wb" );
+  if( m_out == NULL ){
+
+    cout << "KinematicsCache WARNING:  cannot write " << m_tmpName
+         << ", events will not be cached" << endl;
+    return;
+  }
+
+  // the header is written again with the final counts in finish()
+  CacheHeader header;
+  memset( &header, 0, sizeof( header ) );
+
+  vector< char > key( paddedLength( m_key.size() ), 0 );
+  memcpy( &(key[0]), m_key.data(), m_key.size() );
+
+  m_writeFailed =
+    fwrite( &header, sizeof( header ), 1, m_out ) != 1 ||
+    fwrite( &(key[0]), 1, key.size(), m_out ) != key.size();
+
+  m_numEvents = 0;
+  m_payloadBytes = 0;
+  m_checksum = kFNVOffset;
+}
+
+void
+KinematicsCache::abortWriting(){
+
+  if( m_out == NULL ) return;
+
+  fclose( m_out );
+  m_out = NULL;
+  remove( m_tmpName.c_str() );
+}
+
+void
+KinematicsCache::record( const Kinematics* kin, bool hasWeight ){
+
+  if( m_out == NULL || m_writeFailed ) return;
+
+  const vector< TLorentzVector >& particles = kin->particleList();
+  uint32_t nPart = particles.size();
+
+  vector< double > buffer( 2 + 4 * nPart );
+  uint32_t counts[2] = { nPart, 0 };
+  memcpy( &(buffer[0]), counts, sizeof( counts ) );
+  buffer[1] = kin->weight();
+
+  for( uint32_t i = 0; i < nPart; ++i ){
+
+    buffer[2+4*i]   = particles[i].E();
+    buffer[2+4*i+1] = particles[i].Px();
+    buffer[2+4*i+2] = particles[i].Py();
+    buffer[2+4*i+3] = particles[i].Pz();
+  }
+
+  size_t nBytes = buffer.size() * sizeof( double );
+  if( fwrite( &(buffer[0]), 1, nBytes, m_out ) != nBytes ){
+
+    m_writeFailed = true;
+    return;
+  }
+
+  m_checksum = checksumWords( m_checksum, reinterpret_cast< const char* >( &(buffer[0]) ), nBytes );
+  m_payloadBytes += nBytes;
+  m_hasWeight = hasWeight;
+  ++m_numEvents;
+}
+
+void
+KinematicsCache::finish(){
+
+  if( m_out == NULL ) return;
+
+  CacheHeader header;
+  memcpy( header.magic, kMagic, sizeof( kMagic ) );
+  header.version = kVersion;
+  header.flags = ( m_hasWeight ? kHasWeight : 0 );
+  header.keyLength = m_key.size();
+  header.unused = 0;
+  header.numEvents = m_numEvents;
+  header.payloadBytes = m_payloadBytes;
+  header.checksum = m_checksum;
+
+  if( !m_writeFailed ){
+
+    m_writeFailed =
+      fseek( m_out, 0, SEEK_SET ) != 0 ||
+      fwrite( &header, sizeof( header ), 1, m_out ) != 1;
+  }
+
+  m_writeFailed = ( fclose( m_out ) != 0 ) || m_writeFailed;
+  m_out = NULL;
+
+  // the rename makes the complete cache visible in one step
+  if( m_writeFailed || rename( m_tmpName.c_str(), m_fileName.c_str() ) != 0 ){
+
+    cout << "KinematicsCache WARNING:  failed to write " << m_fileName << endl;
+    remove( m_tmpName.c_str() );
+    return;
+  }
+
+  cout << "Wrote " << m_numEvents << " events to kinematics cache "
+       << m_fileName << endl;
+}
+
+void
+KinematicsCache::rewind(){
+
+  if( isComplete() ){
+
+    m_cursor = m_data;
+  }
+  else if( m_out != NULL ){
+
+    abortWriting();
+    startWriting();
+  }
+}
@@ -0,0 +1,107 @@
+#if !defined(KINEMATICSCACHE)
+#define KINEMATICSCACHE
+
+#include "IUAmpTools/Kinematics.h"
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ * Binary cache of the events a data reader delivers, so that repeated fits
+ * of the same input do not have to decompress the ROOT files again.
+ *
+ * Caching is enabled with the environment variable AMPTOOLS_KIN_CACHE:
+ * set it to "1" to write the cache next to the first source file, or to a
+ * directory that should hold the cache files.  The cache is keyed on the
+ * reader name, all reader arguments (tree name, cuts, ...) and the size and
+ * modification time of every source file, so a cache that does not match
+ * the current input is never used.
+ *
+ * On the first pass through the source the reader hands every event to
+ * record() and calls finish() at the end; the cache then becomes visible
+ * under its final name.  Later runs find the complete cache, memory map it
+ * and the reader returns nextEvent() without opening the ROOT file.
+ *
+ * File layout, little endian, every record aligned to 8 bytes:
+ *   header    magic "AMPKINC", format version, flags, key length,
+ *             number of events, payload size, FNV-1a checksum of payload
+ *   key       the full key string, zero padded
+ *   payload   per event:  uint32 number of particles, uint32 unused,
+ *             double weight, then E, px, py, pz of each particle as doubles
+ */
+
+class KinematicsCache
+{
+
+public:
+
+  enum { kVersion = 1 };
+
+  /**
+   * Returns NULL if caching is disabled or not possible for these sources.
+   * \param[in] readerName name of the data reader
+   * \param[in] args all arguments of the data reader
+   * \param[in] sources files the events are read from
+   */
+  static KinematicsCache* open( const string& readerName,
+                                const vector< string >& args,
+                                const vector< string >& sources );
+
+  ~KinematicsCache();
+
+  /**
+   * True if a complete, valid cache was found; the reader should then
+   * only use nextEvent(), numEvents() and hasWeight().
+   */
+  bool isComplete() const { return m_data != NULL; }
+
+  unsigned int numEvents() const { return m_numEvents; }
+  bool hasWeight() const { return m_hasWeight; }
+
+  // reading a complete cache, NULL after the last event
+  Kinematics* nextEvent();
+
+  // writing a new cache
+  void record( const Kinematics* kin, bool hasWeight );
+  void finish();
+
+  /**
+   * Goes back to the first event; a cache that is still being written
+   * is discarded and started again.
+   */
+  void rewind();
+
+private:
+
+  KinematicsCache( const string& fileName, const string& key );
+
+  bool load();
+  void startWriting();
+  void abortWriting();
+
+  string m_fileName;
+  string m_key;
+
+  // memory mapped complete cache
+  void* m_map;
+  size_t m_mapSize;
+  const char* m_data;
+  const char* m_end;
+  const char* m_cursor;
+
+  unsigned int m_numEvents;
+  bool m_hasWeight;
+
+  // cache being written
+  string m_tmpName;
+  FILE* m_out;
+  uint64_t m_payloadBytes;
+  uint64_t m_checksum;
+  bool m_writeFailed;
+};
+
+#endif
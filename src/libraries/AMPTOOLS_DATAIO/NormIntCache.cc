@@ -0,0 +1,225 @@
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <set>
+#include <stdint.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "IUAmpTools/AmpToolsInterface.h"
+#include "IUAmpTools/ConfigurationInfo.h"
+#include "IUAmpTools/NormIntInterface.h"
+
+#include "AMPTOOLS_DATAIO/NormIntCache.h"
+#include "AMPTOOLS_DATAIO/FileUtilities.h"
+
+using namespace std;
+
+namespace {
+
+  const uint64_t kFNVOffset = 14695981039346656037ULL;
+  const uint64_t kFNVPrime  = 1099511628211ULL;
+
+  uint64_t hashString( const string& s ){
+
+    uint64_t hash = kFNVOffset;
+    for( size_t i = 0; i < s.size(); ++i ){
+
+      hash ^= static_cast< unsigned char >( s[i] );
+      hash *= kFNVPrime;
+    }
+    return hash;
+  }
+
+  string readFile( const string& path ){
+
+    ifstream in( path.c_str() );
+    stringstream text;
+    text << in.rdbuf();
+    return text.str();
+  }
+
+  void addReader( ostringstream& key, const string& type,
+                  const pair< string, vector< string > >& reader ){
+
+    key << "|" << type << " " << reader.first;
+    for( unsigned int i = 0; i < reader.second.size(); ++i )
+      key << " " << reader.second[i] << fileStamp( reader.second[i] );
+  }
+}
+
+NormIntCache*
+NormIntCache::open( ConfigurationInfo* cfgInfo, const vector< string >& variedPars ){
+
+  const char* setting = getenv( "AMPTOOLS_NI_CACHE" );
+  if( setting == NULL || string( setting ) == "" || string( setting ) == "0" )
+    return NULL;
+
+  NormIntCache* cache = new NormIntCache();
+
+  // the amplitude code is compiled into the executable
+  char exe[4096];
+  ssize_t exeLength = readlink( "/proc/self/exe", exe, sizeof( exe ) - 1 );
+  string exeStamp = ( exeLength > 0 ? fileStamp( string( exe, exeLength ) ) : "" );
+
+  // parameters fixed in the configuration that are changed at run time
+  set< string > varied( variedPars.begin(), variedPars.end() );
+  vector< vector< string > > parRanges = cfgInfo->userKeywordArguments( "parRange" );
+  for( unsigned int i = 0; i < parRanges.size(); ++i )
+    if( !parRanges[i].empty() ) varied.insert( parRanges[i][0] );
+
+  vector< ReactionInfo* > reactions = cfgInfo->reactionList();
+  for( unsigned int i = 0; i < reactions.size(); ++i ){
+
+    ReactionInfo* reaction = reactions[i];
+    string name = reaction->reactionName();
+
+    if( reaction->normIntFileInput() ) continue;
+
+    if( reaction->genMC().first == "" || reaction->accMC().first == "" ||
+        reaction->accMC().second.empty() ) continue;
+
+    ostringstream key;
+    key << "reaction " << name;
+
+    vector< string > particles = reaction->particleList();
+    for( unsigned int j = 0; j < particles.size(); ++j ) key << " " << particles[j];
+
+    addReader( key, "genmc", reaction->genMC() );
+    addReader( key, "accmc", reaction->accMC() );
+    key << "|exe" << exeStamp;
+
+    bool freeParameters = false;
+
+    vector< AmplitudeInfo* > amps = cfgInfo->amplitudeList( name );
+    for( unsigned int j = 0; j < amps.size(); ++j ){
+
+      key << "|amplitude " << amps[j]->fullName();
+
+      vector< vector< string > > factors = amps[j]->factors();
+      for( unsigned int k = 0; k < factors.size(); ++k ){
+
+        key << " {";
+        for( unsigned int l = 0; l < factors[k].size(); ++l )
+          key << " " << factors[k][l] << ( l > 0 ? fileStamp( factors[k][l] ) : "" );
+        key << " }";
+      }
+
+      vector< vector< int > > permutations = amps[j]->permutations();
+      for( unsigned int k = 0; k < permutations.size(); ++k ){
+
+        key << " (";
+        for( unsigned int l = 0; l < permutations[k].size(); ++l ) key << " " << permutations[k][l];
+        key << " )";
+      }
+
+      vector< ParameterInfo* > pars = amps[j]->parameters();
+      for( unsigned int k = 0; k < pars.size(); ++k ){
+
+        if( !pars[k]->fixed() || varied.count( pars[k]->parName() ) ) freeParameters = true;
+        key << " " << pars[k]->parName() << "=" << setprecision( 17 ) << pars[k]->value();
+      }
+    }
+
+    if( freeParameters ){
+
+      cout << "NormIntCache:  amplitudes of " << name << " have free parameters, "
+           << "the normalization integrals will not be cached" << endl;
+      continue;
+    }
+
+    ostringstream suffix;
+    suffix << "." << name << "." << hex << setw( 16 ) << setfill( '0' )
+           << hashString( key.str() ) << ".normint";
+
+    string fileName;
+    if( string( setting ) == "1" ){
+
+      fileName = reaction->accMC().second[0] + suffix.str();
+    }
+    else{
+
+      string base = reaction->accMC().second[0];
+      size_t slash = base.rfind( '/' );
+      if( slash != string::npos ) base = base.substr( slash + 1 );
+
+      fileName = string( setting ) + "/" + base + suffix.str();
+    }
+
+    if( fileStamp( fileName ) != "" && readFile( fileName + ".key" ) == key.str() ){
+
+      cout << "Reading normalization integrals of " << name << " from cache "
+           << fileName << endl;
+
+      // a requested output file is still written, as a copy of the cache
+      if( reaction->normIntFile() != "" && !copyFile( fileName, reaction->normIntFile() ) )
+        cout << "NormIntCache ERROR:  cannot write " << reaction->normIntFile() << endl;
+
+      reaction->setNormIntFile( fileName, true );
+    }
+    else{
+
+      Entry entry;
+      entry.reaction = name;
+      entry.fileName = fileName;
+      entry.key = key.str();
+      cache->m_missing.push_back( entry );
+    }
+  }
+
+  return cache;
+}
+
+void
+NormIntCache::store( AmpToolsInterface& ati ){
+
+  if( m_stored ) return;
+  m_stored = true;
+
+  for( unsigned int i = 0; i < m_missing.size(); ++i ){
+
+    const Entry& entry = m_missing[i];
+
+    NormIntInterface* normInt = ati.normIntInterface( entry.reaction );
+    if( normInt == NULL || !normInt->hasAccessToMC() ) continue;
+
+    // written under temporary names first, so that concurrent jobs never
+    // read a partial cache
+    ostringstream tmpName;
+    tmpName << entry.fileName << ".tmp." << getpid();
+
+    {
+      ofstream out( tmpName.str().c_str() );
+      normInt->exportNormIntCache( out );
+      ofstream keyOut( ( tmpName.str() + ".key" ).c_str() );
+      keyOut << entry.key;
+
+      out.close();
+      keyOut.close();
+
+      if( out.fail() || keyOut.fail() ){
+
+        cout << "NormIntCache WARNING:  cannot write " << entry.fileName << endl;
+        remove( tmpName.str().c_str() );
+        remove( ( tmpName.str() + ".key" ).c_str() );
+        continue;
+      }
+    }
+
+    if( rename( tmpName.str().c_str(), entry.fileName.c_str() ) != 0 ||
+        rename( ( tmpName.str() + ".key" ).c_str(), ( entry.fileName + ".key" ).c_str() ) != 0 ){
+
+      cout << "NormIntCache WARNING:  cannot write " << entry.fileName << endl;
+      continue;
+    }
+
+    cout << "Stored normalization integrals of " << entry.reaction << " in cache "
+         << entry.fileName << endl;
+  }
+}
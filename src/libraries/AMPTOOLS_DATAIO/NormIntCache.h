@@ -0,0 +1,81 @@
+#if !defined(NORMINTCACHE)
+#define NORMINTCACHE
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class ConfigurationInfo;
+class AmpToolsInterface;
+
+/**
+ * Persistent cache of the normalization integrals of each reaction, so
+ * that fits of unchanged MC samples and amplitudes (randomized restarts in
+ * separate jobs, systematic variations of the data selection, refits of a
+ * bin) do not have to read and process the generated and accepted MC again.
+ *
+ * Caching is enabled with the environment variable AMPTOOLS_NI_CACHE: set
+ * it to "1" to write the cache next to the first accepted MC file, or to a
+ * directory that should hold the cache files.  Only reactions whose
+ * amplitudes have no free parameters are cached, since otherwise the
+ * integrals change during the fit.  Parameters that are fixed in the
+ * configuration but changed at run time (scans, parRange randomization)
+ * count as free.  The key of a reaction contains
+ *
+ *   - the particles of the reaction
+ *   - the reader class and all arguments (files, tree names, cuts, ...) of
+ *     the generated and accepted MC, and the size and modification time of
+ *     every argument that is a file
+ *   - the factors, permutations and parameter values of every amplitude,
+ *     and the size and modification time of every factor argument that is
+ *     a file
+ *   - the size and modification time of the executable, which contains
+ *     the amplitude code
+ *
+ * open() points every reaction with a matching cache at it through the
+ * normintfile input mechanism of AmpTools, so the AmpToolsInterface reads
+ * the integrals from the file.  After the integrals of the other reactions
+ * have been computed, i.e. after the first likelihood evaluation, store()
+ * writes them.  The cache files are in the format of AmpTools normintfile
+ * output; the key is kept in <cache file>.key.
+ */
+
+class NormIntCache
+{
+
+public:
+
+  /**
+   * Returns NULL if caching is disabled.  Must be called before the
+   * AmpToolsInterface is created from this configuration.  variedPars are
+   * the amplitude parameters the caller will change, e.g. when scanning
+   * them; parameters with a parRange keyword are added here.  Programs
+   * that may change any parameter should not use the cache.
+   */
+  static NormIntCache* open( ConfigurationInfo* cfgInfo,
+                             const vector< string >& variedPars = vector< string >() );
+
+  /**
+   * Writes the integrals of the reactions that were not read from the
+   * cache.  Only the first call writes anything.
+   */
+  void store( AmpToolsInterface& ati );
+
+private:
+
+  struct Entry {
+
+    string reaction;
+    string fileName;
+    string key;
+  };
+
+  NormIntCache() : m_stored( false ) { }
+
+  // reactions whose integrals are computed from MC and should be stored
+  vector< Entry > m_missing;
+  bool m_stored;
+};
+
+#endif
@@ -23,14 +23,16 @@
 
 /* Constructor to display FitResults */
 OmegaPiPlotGenerator::OmegaPiPlotGenerator( const FitResults& results, Option opt ) :
-PlotGenerator( results, opt )
+PlotGenerator( results, opt ),
+m_projections( kNumHists )
 {
 	createHistograms();
 }
 
 /* Constructor for event generator (no FitResult) */
 OmegaPiPlotGenerator::OmegaPiPlotGenerator( ) :
-PlotGenerator( )
+PlotGenerator( ),
+m_projections( kNumHists )
 {
 	createHistograms();
 }
@@ -55,6 +57,27 @@ void OmegaPiPlotGenerator::createHistograms( ) {
 void
 OmegaPiPlotGenerator::projectEvent( Kinematics* kin ){
 
+   // the projections only depend on the event, so later passes with
+   // other amplitude sets reuse them
+   const double* cached = m_projections.find( kin );
+   if( cached != NULL ){
+
+      for( int i = 0; i < kNumHists; ++i ) fillHistogram( i, cached[i] );
+      return;
+   }
+
+   double values[kNumHists];
+   projectValues( kin, values );
+
+   m_projections.insert( values );
+
+   //cout << "calls to fillHistogram go here" << endl;
+   for( int i = 0; i < kNumHists; ++i ) fillHistogram( i, values[i] );
+}
+
+void
+OmegaPiPlotGenerator::projectValues( Kinematics* kin, double* values ){
+
    //cout << "project event" << endl;
    TLorentzVector beam   = kin->particle( 0 );
    TLorentzVector recoil = kin->particle( 1 );
@@ -95,24 +118,16 @@ OmegaPiPlotGenerator::projectEvent( Kinematics* kin ){
 
   vector <double> locthetaphih = getomegapiAngles(rhos_pip, omega, X, Gammap, rhos_pim);
 
-   GDouble cosTheta = TMath::Cos(locthetaphi[0]);
-   GDouble Phi = locthetaphi[1];
-   GDouble cosThetaH = TMath::Cos(locthetaphih[0]);
-   GDouble PhiH = locthetaphih[1];
-   GDouble prod_angle = locthetaphi[2];
-
-   //cout << "calls to fillHistogram go here" << endl;
-   fillHistogram( kOmegaPiMass, b1_mass );
-   fillHistogram( kCosTheta, cosTheta );
-   fillHistogram( kPhi, Phi );
-   fillHistogram( kCosThetaH, cosThetaH );
-   fillHistogram( kPhiH, PhiH );
-   fillHistogram( kProd_Ang, prod_angle );
-   fillHistogram( kt, Mandt );
-   fillHistogram( kRecoilMass, recoil_mass );
-   fillHistogram( kTwoPiMass, two_pi.M() );
-   fillHistogram( kProtonPiMass, proton_pi.M() );
-   fillHistogram( kRecoilPiMass, recoil_pi.M() );
-
+   values[kOmegaPiMass] = b1_mass;
+   values[kCosTheta] = TMath::Cos(locthetaphi[0]);
+   values[kPhi] = locthetaphi[1];
+   values[kCosThetaH] = TMath::Cos(locthetaphih[0]);
+   values[kPhiH] = locthetaphih[1];
+   values[kProd_Ang] = locthetaphi[2];
+   values[kt] = Mandt;
+   values[kRecoilMass] = recoil_mass;
+   values[kTwoPiMass] = two_pi.M();
+   values[kProtonPiMass] = proton_pi.M();
+   values[kRecoilPiMass] = recoil_pi.M();
 }
 
@@ -5,6 +5,7 @@
 #include <string>
 
 #include "IUAmpTools/PlotGenerator.h"
+#include "AMPTOOLS_DATAIO/PlotProjectionCache.h"
 
 using namespace std;
 
@@ -24,11 +25,17 @@ public:
   OmegaPiPlotGenerator( );
     
   void projectEvent( Kinematics* kin );
+
+  // the values of all histograms for one event; unlike projectEvent this
+  // can be called from several threads, e.g. by PlotSubsetEngine
+  void projectValues( Kinematics* kin, double* values );
  
 private:
   
   void createHistograms( );
- 
+
+  PlotProjectionCache m_projections;
+
 };
 
 #endif
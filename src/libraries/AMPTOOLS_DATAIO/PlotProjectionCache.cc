@@ -0,0 +1,73 @@
+
+#include <cstring>
+
+#include "TLorentzVector.h"
+
+#include "IUAmpTools/Kinematics.h"
+#include "AMPTOOLS_DATAIO/PlotProjectionCache.h"
+
+static const uint64_t kFNVOffset = 14695981039346656037ULL;
+static const uint64_t kFNVPrime  = 1099511628211ULL;
+
+static inline uint64_t
+hashBits( uint64_t hash, uint64_t bits ){
+
+  hash ^= bits;
+  return hash * kFNVPrime;
+}
+
+// the check hash mixes every word completely (splitmix64 finalizer), so it
+// is independent of the FNV key
+static inline uint64_t
+checkBits( uint64_t check, uint64_t bits ){
+
+  check = ( check ^ bits ) + 0x9E3779B97F4A7C15ULL;
+  check = ( check ^ ( check >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+  check = ( check ^ ( check >> 27 ) ) * 0x94D049BB133111EBULL;
+  return check ^ ( check >> 31 );
+}
+
+const double*
+PlotProjectionCache::find( const Kinematics* kin, const string& tag ){
+
+  uint64_t key = kFNVOffset;
+  uint64_t check = tag.size();
+  for( unsigned int i = 0; i < tag.size(); ++i ){
+
+    key = hashBits( key, static_cast< unsigned char >( tag[i] ) );
+    check = checkBits( check, static_cast< unsigned char >( tag[i] ) );
+  }
+
+  const vector< TLorentzVector >& particles = kin->particleList();
+  check = checkBits( check, particles.size() );
+  for( unsigned int i = 0; i < particles.size(); ++i ){
+
+    double p4[4] = { particles[i].E(), particles[i].Px(), particles[i].Py(), particles[i].Pz() };
+    for( int j = 0; j < 4; ++j ){
+
+      uint64_t bits;
+      memcpy( &bits, &(p4[j]), sizeof( bits ) );
+      key = hashBits( key, bits );
+      check = checkBits( check, bits );
+    }
+  }
+
+  m_lastKey = key;
+  m_lastCheck = check;
+
+  unordered_map< uint64_t, unsigned int >::const_iterator entry = m_index.find( key );
+  if( entry == m_index.end() || m_checks[entry->second] != check ) return NULL;
+
+  return &(m_values[entry->second * m_numValues]);
+}
+
+void
+PlotProjectionCache::insert( const double* values ){
+
+  if( m_checks.size() >= kMaxEvents ) return;
+
+  // an event whose key collides replaces the stored one
+  m_index[m_lastKey] = m_checks.size();
+  m_checks.push_back( m_lastCheck );
+  m_values.insert( m_values.end(), values, values + m_numValues );
+}
@@ -0,0 +1,64 @@
+#if !defined(PLOTPROJECTIONCACHE)
+#define PLOTPROJECTIONCACHE
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+
+using namespace std;
+
+class Kinematics;
+
+/**
+ * Remembers the quantities a plot generator projects for each event.
+ *
+ * PlotGenerator loops over the same data and MC events again whenever an
+ * amplitude set is switched on or off, and only the event weight changes
+ * between these passes.  The plot generators store the values they would
+ * fill the first time an event is seen and on later passes only look them
+ * up, which avoids recomputing boosts and decay angles.
+ *
+ * Events are identified by the bit pattern of their four-vectors together
+ * with a tag (e.g. the reaction name) for projections that depend on the
+ * configuration.  They are looked up by one 64-bit hash of these and
+ * checked against a second, independent one, so two events only share
+ * values if both hashes collide.  At most kMaxEvents events are stored;
+ * values of further events are simply computed every time.
+ */
+
+class PlotProjectionCache
+{
+
+public:
+
+  enum { kMaxEvents = 2000000 };
+
+  PlotProjectionCache( unsigned int numValues ) :
+    m_numValues( numValues ), m_lastKey( 0 ), m_lastCheck( 0 ) { }
+
+  /**
+   * Returns the stored values of this event or NULL if there are none;
+   * the pointer is valid until the next insert().
+   */
+  const double* find( const Kinematics* kin, const string& tag = "" );
+
+  /**
+   * Stores the values of the event that was passed to the preceding find().
+   */
+  void insert( const double* values );
+
+private:
+
+  unsigned int m_numValues;
+
+  uint64_t m_lastKey;
+  uint64_t m_lastCheck;
+
+  // key -> number of the stored event
+  unordered_map< uint64_t, unsigned int > m_index;
+  vector< uint64_t > m_checks;
+  vector< double > m_values;
+};
+
+#endif
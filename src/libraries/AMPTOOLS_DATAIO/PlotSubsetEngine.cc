@@ -0,0 +1,251 @@
+#include <cassert>
+#include <cmath>
+#include <thread>
+
+#include "TH1.h"
+#include "TH1D.h"
+
+#include "IUAmpTools/AmpToolsInterface.h"
+#include "IUAmpTools/ConfigurationInfo.h"
+#include "IUAmpTools/DataReader.h"
+#include "IUAmpTools/FitResults.h"
+#include "IUAmpTools/IntensityManager.h"
+#include "IUAmpTools/Kinematics.h"
+#include "IUAmpTools/NormIntInterface.h"
+
+#include "AMPTOOLS_DATAIO/PlotSubsetEngine.h"
+
+PlotSubsetEngine::PlotSubsetEngine( const FitResults& results, const string& reactionName,
+                                    Projector projector, const vector< TH1* >& shapes ) :
+m_reactionName( reactionName ),
+m_projector( projector ),
+m_shapes( shapes )
+{
+  // as in PlotGenerator the configuration is not modified, the interface
+  // only requires a non-const pointer
+  ConfigurationInfo* cfgInfo = const_cast< ConfigurationInfo* >( results.configInfo() );
+
+  m_ati = new AmpToolsInterface( cfgInfo, AmpToolsInterface::kPlotGeneration );
+
+  vector< AmplitudeInfo* > amps = cfgInfo->amplitudeList( reactionName );
+  assert( amps.size() > 0 );
+
+  for( unsigned int i = 0; i < amps.size(); ++i ){
+
+    m_ampNames.push_back( amps[i]->fullName() );
+    m_ampSums.push_back( amps[i]->sumName() );
+    m_production.push_back( results.scaledProductionParameter( amps[i]->fullName() ) );
+
+    // the decay amplitudes are evaluated at the fitted parameters
+    vector< ParameterInfo* > pars = amps[i]->parameters();
+    for( unsigned int j = 0; j < pars.size(); ++j ){
+
+      m_ati->intensityManager( reactionName )->
+        setParValue( amps[i]->fullName(), pars[j]->parName(),
+                     results.parValue( pars[j]->parName() ) );
+    }
+  }
+
+  m_numGenEvents = results.normInt( reactionName )->numGenEvents();
+}
+
+PlotSubsetEngine::~PlotSubsetEngine(){
+
+  for( unsigned int i = 0; i < m_histograms.size(); ++i ) delete m_histograms[i];
+  delete m_ati;
+}
+
+unsigned int
+PlotSubsetEngine::addSubset( const string& name, const vector< string >& amplitudes ){
+
+  Subset subset;
+  subset.name = name;
+
+  vector< string > sumNames;
+  for( unsigned int i = 0; i < amplitudes.size(); ++i ){
+
+    unsigned int amp = 0;
+    while( amp < m_ampNames.size() && m_ampNames[amp] != amplitudes[i] ) ++amp;
+    assert( amp < m_ampNames.size() );
+
+    unsigned int sum = 0;
+    while( sum < sumNames.size() && sumNames[sum] != m_ampSums[amp] ) ++sum;
+    if( sum == sumNames.size() ){
+
+      sumNames.push_back( m_ampSums[amp] );
+      subset.sums.push_back( vector< unsigned int >() );
+    }
+
+    subset.sums[sum].push_back( amp );
+  }
+
+  m_subsets.push_back( subset );
+
+  for( unsigned int v = 0; v < m_shapes.size(); ++v ){
+
+    const TAxis* axis = m_shapes[v]->GetXaxis();
+
+    string histName = string( m_shapes[v]->GetName() ) + "_" + name;
+    TH1D* hist = new TH1D( histName.c_str(), m_shapes[v]->GetTitle(),
+                           axis->GetNbins(), axis->GetXmin(), axis->GetXmax() );
+    hist->SetDirectory( 0 );
+    hist->Sumw2();
+
+    m_histograms.push_back( hist );
+  }
+
+  return m_subsets.size() - 1;
+}
+
+TH1D*
+PlotSubsetEngine::histogram( unsigned int subset, unsigned int variable ) const {
+
+  assert( subset < m_subsets.size() && variable < m_shapes.size() );
+  return m_histograms[subset * m_shapes.size() + variable];
+}
+
+void
+PlotSubsetEngine::fill( bool generatedMC, unsigned int nThreads ){
+
+  if( nThreads == 0 ) nThreads = thread::hardware_concurrency();
+  if( nThreads == 0 ) nThreads = 1;
+
+  // contents and sums of squared weights of all histograms, including
+  // under- and overflow, one copy for each thread
+  unsigned int numBins = 0;
+  for( unsigned int i = 0; i < m_histograms.size(); ++i )
+    numBins += m_histograms[i]->GetNbinsX() + 2;
+
+  vector< vector< double > > bins( nThreads, vector< double >( 2 * numBins, 0 ) );
+
+  DataReader* reader = ( generatedMC ? m_ati->genMCReader( m_reactionName ) :
+                                       m_ati->accMCReader( m_reactionName ) );
+  assert( reader != NULL );
+  reader->resetSource();
+
+  vector< Kinematics* > batch;
+  int numEvents = 0;
+
+  bool done = false;
+  while( !done ){
+
+    batch.clear();
+
+    Kinematics* kin;
+    while( batch.size() < kBatchSize && ( kin = reader->getEvent() ) != NULL )
+      batch.push_back( kin );
+
+    done = ( batch.size() < kBatchSize );
+    if( batch.empty() ) break;
+
+    m_ati->clearEvents();
+    for( unsigned int i = 0; i < batch.size(); ++i ){
+
+      m_ati->loadEvent( batch[i], i, batch.size() );
+      delete batch[i];
+    }
+
+    m_ati->processEvents( m_reactionName );
+
+    fillBatch( batch.size(), nThreads, bins );
+    numEvents += batch.size();
+  }
+
+  m_ati->clearEvents();
+
+  // add up the copies of the threads
+  unsigned int offset = 0;
+  for( unsigned int i = 0; i < m_histograms.size(); ++i ){
+
+    TH1D* hist = m_histograms[i];
+    hist->Reset();
+
+    for( int bin = 0; bin < hist->GetNbinsX() + 2; ++bin, ++offset ){
+
+      double content = 0;
+      double sumw2 = 0;
+      for( unsigned int t = 0; t < nThreads; ++t ){
+
+        content += bins[t][2*offset];
+        sumw2 += bins[t][2*offset+1];
+      }
+
+      hist->SetBinContent( bin, content );
+      hist->SetBinError( bin, sqrt( sumw2 ) );
+    }
+
+    hist->SetEntries( numEvents );
+  }
+}
+
+void
+PlotSubsetEngine::fillBatch( int numEvents, unsigned int nThreads,
+                             vector< vector< double > >& bins ){
+
+  // first bin of each histogram in the flat arrays
+  vector< unsigned int > firstBin;
+  unsigned int offset = 0;
+  for( unsigned int i = 0; i < m_histograms.size(); ++i ){
+
+    firstBin.push_back( offset );
+    offset += m_histograms[i]->GetNbinsX() + 2;
+  }
+
+  auto fillRange = [&]( unsigned int t, int first, int last ){
+
+    vector< double > values( m_shapes.size() );
+    vector< complex< double > > terms( m_ampNames.size() );
+    vector< double >& myBins = bins[t];
+
+    for( int i = first; i < last; ++i ){
+
+      Kinematics* kin = m_ati->kinematics( i );
+
+      m_projector( kin, m_reactionName, &(values[0]) );
+
+      // the per-amplitude contributions are shared by all subsets
+      for( unsigned int a = 0; a < m_ampNames.size(); ++a )
+        terms[a] = m_production[a] * m_ati->decayAmplitude( i, m_ampNames[a] );
+
+      double eventWeight = kin->weight() / m_numGenEvents;
+      delete kin;
+
+      for( unsigned int s = 0; s < m_subsets.size(); ++s ){
+
+        const vector< vector< unsigned int > >& sums = m_subsets[s].sums;
+
+        double intensity = 0;
+        for( unsigned int k = 0; k < sums.size(); ++k ){
+
+          complex< double > sum( 0, 0 );
+          for( unsigned int j = 0; j < sums[k].size(); ++j ) sum += terms[sums[k][j]];
+          intensity += norm( sum );
+        }
+
+        double weight = intensity * eventWeight;
+
+        for( unsigned int v = 0; v < m_shapes.size(); ++v ){
+
+          unsigned int h = s * m_shapes.size() + v;
+          unsigned int bin = firstBin[h] + m_histograms[h]->GetXaxis()->FindFixBin( values[v] );
+
+          myBins[2*bin] += weight;
+          myBins[2*bin+1] += weight * weight;
+        }
+      }
+    }
+  };
+
+  vector< thread > threads;
+  int chunk = ( numEvents + nThreads - 1 ) / nThreads;
+  for( unsigned int t = 0; t < nThreads; ++t ){
+
+    int first = t * chunk;
+    int last = ( first + chunk < numEvents ? first + chunk : numEvents );
+    if( first >= last ) break;
+
+    threads.push_back( thread( fillRange, t, first, last ) );
+  }
+
+  for( unsigned int t = 0; t < threads.size(); ++t ) threads[t].join();
+}
@@ -0,0 +1,104 @@
+#if !defined(PLOTSUBSETENGINE)
+#define PLOTSUBSETENGINE
+
+#include <string>
+#include <vector>
+#include <complex>
+#include <functional>
+
+using namespace std;
+
+class FitResults;
+class Kinematics;
+class AmpToolsInterface;
+class TH1;
+class TH1D;
+
+/**
+ * Fills the projections of the accepted (or generated) MC for many
+ * amplitude subsets in a single pass over the events.
+ *
+ * The plotters used to switch amplitudes and sums on and off in the
+ * PlotGenerator and ask for a projection, which reweights the whole
+ * sample once per subset.  Here the events are read in batches, the
+ * amplitudes of a batch are computed once and each event is projected
+ * once.  From the products V_i A_i of the production parameters and decay
+ * amplitudes of an event, the intensity of every subset is then just a
+ * sum over the coherent sums of the subset.  The events of a batch are
+ * divided between threads, each of which fills its own copy of the
+ * histograms; the copies are added at the end.
+ *
+ * As in PlotGenerator the events are weighted by intensity times event
+ * weight divided by the number of generated events.  The projector must
+ * be safe to call from several threads at once.
+ */
+
+class PlotSubsetEngine
+{
+
+public:
+
+  // computes the value of every plotted variable for one event
+  typedef function< void( Kinematics* kin, const string& reactionName,
+                          double* values ) > Projector;
+
+  enum { kBatchSize = 200000 };
+
+  /**
+   * The histograms of each subset get the binning, name and title of the
+   * shapes, which are typically the data projections of a PlotGenerator.
+   * The amplitudes must be registered with AmpToolsInterface beforehand.
+   */
+  PlotSubsetEngine( const FitResults& results, const string& reactionName,
+                    Projector projector, const vector< TH1* >& shapes );
+
+  ~PlotSubsetEngine();
+
+  /**
+   * Adds a subset of the amplitudes of the reaction, given by their full
+   * names (reaction::sum::amp), and returns its index.
+   */
+  unsigned int addSubset( const string& name, const vector< string >& amplitudes );
+
+  /**
+   * Loops once over the accepted MC, or the generated MC, and fills the
+   * histograms of all subsets.  nThreads = 0 uses one thread per core.
+   */
+  void fill( bool generatedMC = false, unsigned int nThreads = 0 );
+
+  unsigned int numSubsets() const { return m_subsets.size(); }
+  unsigned int numVariables() const { return m_shapes.size(); }
+
+  // owned by the engine, named <shape name>_<subset name>
+  TH1D* histogram( unsigned int subset, unsigned int variable ) const;
+
+  // the full names of all amplitudes of the reaction
+  const vector< string >& amplitudes() const { return m_ampNames; }
+
+private:
+
+  // amplitude indices of a subset grouped by coherent sum
+  struct Subset {
+
+    string name;
+    vector< vector< unsigned int > > sums;
+  };
+
+  void fillBatch( int numEvents, unsigned int nThreads,
+                  vector< vector< double > >& bins );
+
+  string m_reactionName;
+  Projector m_projector;
+  AmpToolsInterface* m_ati;
+  double m_numGenEvents;
+
+  vector< string > m_ampNames;
+  vector< string > m_ampSums;
+  vector< complex< double > > m_production;
+
+  vector< TH1* > m_shapes;
+  vector< Subset > m_subsets;
+  vector< TH1D* > m_histograms;
+};
+
+#endif
@@ -0,0 +1,350 @@
+
+#include <vector>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+
+#include "TLorentzVector.h"
+
+#include "AMPTOOLS_DATAIO/ROOTChainDataReader.h"
+#include "AMPTOOLS_DATAIO/ROOTColumnReader.h"
+#include "AMPTOOLS_DATAIO/KinematicsCache.h"
+#include "IUAmpTools/Kinematics.h"
+
+#include "TH1.h"
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TChain.h"
+#include "TObjArray.h"
+
+using namespace std;
+
+// AMPTOOLS_READ_STATS=1 reports the time spent reading at the end of
+// every pass over the chain, like ROOTDataReader
+static bool
+reportReadStats(){
+
+  static const bool report = ( getenv( "AMPTOOLS_READ_STATS" ) != NULL &&
+                               string( getenv( "AMPTOOLS_READ_STATS" ) ) != "0" );
+  return report;
+}
+
+static vector< string >
+fileSpecifications( const string& arg ){
+
+  vector< string > specs;
+
+  bool isList = ( arg.size() > 4 && arg.compare( arg.size() - 4, 4, ".txt" ) == 0 ) ||
+                ( arg.size() > 5 && arg.compare( arg.size() - 5, 5, ".list" ) == 0 );
+
+  if( isList ){
+
+    ifstream in( arg.c_str() );
+    if( !in.good() ){
+
+      cout << "ROOTChainDataReader ERROR:  cannot read file list " << arg << endl;
+      assert( false );
+    }
+
+    string line;
+    while( getline( in, line ) ){
+
+      line.erase( 0, line.find_first_not_of( " \t" ) );
+      line.erase( line.find_last_not_of( " \t\r" ) + 1 );
+      if( line.empty() || line[0] == '#' ) continue;
+
+      specs.push_back( line );
+    }
+  }
+  else{
+
+    size_t start = 0;
+    while( start <= arg.size() ){
+
+      size_t comma = arg.find( ',', start );
+      if( comma == string::npos ) comma = arg.size();
+
+      if( comma > start ) specs.push_back( arg.substr( start, comma - start ) );
+      start = comma + 1;
+    }
+  }
+
+  return specs;
+}
+
+ROOTChainDataReader::ROOTChainDataReader( const vector< string >& args ):
+  UserDataReader< ROOTChainDataReader >( args ),
+  m_treeName( "kin" ),
+  m_numEvents( 0 ),
+  m_useWeight( false ),
+  m_numThreads( 4 ),
+  m_started( false ),
+  m_stop( false ),
+  m_nextChunk( 0 ),
+  m_currentChunk( 0 ),
+  m_eventInChunk( 0 ),
+  m_cache( NULL )
+{
+  assert( args.size() >= 1 && args.size() <= 3 );
+
+  TH1::AddDirectory( kFALSE );
+
+  // every thread opens its own files
+  ROOT::EnableThreadSafety();
+
+  if( args.size() > 1 ) m_treeName = args[1];
+  if( args.size() > 2 ) m_numThreads = atoi( args[2].c_str() );
+
+  unsigned int nCores = thread::hardware_concurrency();
+  if( nCores > 0 ) m_numThreads = min( m_numThreads, nCores );
+  if( m_numThreads < 1 ) m_numThreads = 1;
+
+  // the chain expands wildcards and counts the entries of each file
+  TChain chain( m_treeName.c_str() );
+
+  vector< string > specs = fileSpecifications( args[0] );
+  for( unsigned int i = 0; i < specs.size(); ++i ){
+
+    if( chain.Add( specs[i].c_str() ) == 0 ){
+
+      cout << "ROOTChainDataReader WARNING:  no files found for " << specs[i] << endl;
+    }
+  }
+
+  m_numEvents = chain.GetEntries();
+
+  TObjArray* fileList = chain.GetListOfFiles();
+  for( int i = 0; i < fileList->GetEntries(); ++i ){
+
+    m_fileNames.push_back( fileList->At( i )->GetTitle() );
+  }
+
+  if( m_fileNames.empty() ){
+
+    cout << "ROOTChainDataReader ERROR:  no input files in " << args[0] << endl;
+    assert( false );
+  }
+
+  m_useWeight = ( chain.GetBranch( "Weight" ) != NULL );
+
+  cout << "ROOTChainDataReader:  " << m_numEvents << " events in "
+       << m_fileNames.size() << " files, decoding with " << m_numThreads
+       << " threads" << endl;
+
+  m_cache = KinematicsCache::open( name(), args, m_fileNames );
+  if( m_cache != NULL && m_cache->isComplete() ) return;
+
+  // split every file into chunks that are decoded independently
+  const Long64_t* offsets = chain.GetTreeOffset();
+  for( unsigned int i = 0; i < m_fileNames.size(); ++i ){
+
+    Long64_t nEntries = offsets[i+1] - offsets[i];
+    for( Long64_t first = 0; first < nEntries; first += kChunkSize ){
+
+      Chunk chunk;
+      chunk.file = i;
+      chunk.first = first;
+      chunk.size = min( nEntries - first, static_cast< Long64_t >( kChunkSize ) );
+      chunk.ready = false;
+
+      m_chunks.push_back( chunk );
+    }
+  }
+}
+
+ROOTChainDataReader::~ROOTChainDataReader()
+{
+  stopThreads();
+  if( m_cache != NULL ) delete m_cache;
+}
+
+void
+ROOTChainDataReader::resetSource()
+{
+  cout << "Resetting source " << m_treeName << " in "
+       << m_fileNames.size() << " files" << endl;
+
+  stopThreads();
+  if( m_cache != NULL ) m_cache->rewind();
+}
+
+Kinematics*
+ROOTChainDataReader::getEvent()
+{
+  if( m_cache != NULL && m_cache->isComplete() ) return m_cache->nextEvent();
+
+  if( !m_started ) startThreads();
+
+  while( m_currentChunk < m_chunks.size() ){
+
+    Chunk& chunk = m_chunks[m_currentChunk];
+
+    if( m_eventInChunk == 0 ){
+
+      unique_lock< mutex > lock( m_mutex );
+      m_chunkReady.wait( lock, [&chunk]{ return chunk.ready; } );
+    }
+
+    if( m_eventInChunk < chunk.events.size() ){
+
+      Kinematics* kin = chunk.events[m_eventInChunk];
+      chunk.events[m_eventInChunk++] = NULL;
+
+      if( m_cache != NULL ) m_cache->record( kin, m_useWeight );
+      return kin;
+    }
+
+    // release the chunk so the threads can decode further ahead
+    vector< Kinematics* >().swap( chunk.events );
+    m_eventInChunk = 0;
+    {
+      lock_guard< mutex > lock( m_mutex );
+      ++m_currentChunk;
+    }
+    m_chunkConsumed.notify_all();
+  }
+
+  if( m_cache != NULL ) m_cache->finish();
+
+  if( m_eventInChunk == 0 && m_numEvents > 0 && reportReadStats() ){
+
+    double seconds =
+      chrono::duration< double >( chrono::steady_clock::now() - m_startTime ).count();
+
+    cout << "Read " << m_numEvents << " events from " << m_fileNames.size()
+         << " files in " << seconds << " s (" << m_numEvents / seconds
+         << " events/s)" << endl;
+
+    // report only once per pass
+    m_eventInChunk = 1;
+  }
+
+  return NULL;
+}
+
+unsigned int
+ROOTChainDataReader::numEvents() const
+{
+  if( m_cache != NULL && m_cache->isComplete() ) return m_cache->numEvents();
+
+  return static_cast< unsigned int >( m_numEvents );
+}
+
+void
+ROOTChainDataReader::startThreads()
+{
+  m_stop = false;
+  m_nextChunk = 0;
+  m_currentChunk = 0;
+  m_eventInChunk = 0;
+  m_startTime = chrono::steady_clock::now();
+
+  for( unsigned int i = 0; i < m_numThreads; ++i ){
+
+    m_threads.push_back( thread( &ROOTChainDataReader::decodeChunks, this ) );
+  }
+
+  m_started = true;
+}
+
+void
+ROOTChainDataReader::stopThreads()
+{
+  if( !m_started ) return;
+
+  {
+    lock_guard< mutex > lock( m_mutex );
+    m_stop = true;
+  }
+  m_chunkConsumed.notify_all();
+
+  for( unsigned int i = 0; i < m_threads.size(); ++i ) m_threads[i].join();
+  m_threads.clear();
+
+  // events that were decoded but never handed out
+  for( unsigned int i = 0; i < m_chunks.size(); ++i ){
+
+    for( unsigned int j = 0; j < m_chunks[i].events.size(); ++j ){
+
+      if( m_chunks[i].events[j] != NULL ) delete m_chunks[i].events[j];
+    }
+
+    vector< Kinematics* >().swap( m_chunks[i].events );
+    m_chunks[i].ready = false;
+  }
+
+  m_currentChunk = 0;
+  m_eventInChunk = 0;
+  m_started = false;
+}
+
+void
+ROOTChainDataReader::decodeChunks()
+{
+  // a few chunks per thread may be decoded ahead of the reader
+  const unsigned int window = 2 * m_numThreads;
+
+  int openFile = -1;
+  TFile* file = NULL;
+  ROOTColumnReader* columns = NULL;
+
+  while( true ){
+
+    unsigned int iChunk;
+    {
+      unique_lock< mutex > lock( m_mutex );
+      m_chunkConsumed.wait( lock, [this, window]{
+          return m_stop || m_nextChunk >= m_chunks.size() ||
+                 m_nextChunk < m_currentChunk + window; } );
+
+      if( m_stop || m_nextChunk >= m_chunks.size() ) break;
+
+      iChunk = m_nextChunk++;
+    }
+
+    Chunk& chunk = m_chunks[iChunk];
+
+    if( static_cast< int >( chunk.file ) != openFile ){
+
+      if( columns != NULL ) delete columns;
+      if( file != NULL ) file->Close();
+      delete file;
+
+      file = TFile::Open( m_fileNames[chunk.file].c_str() );
+      if( file == NULL || file->IsZombie() ){
+
+        cout << "ROOTChainDataReader ERROR:  cannot open "
+             << m_fileNames[chunk.file] << endl;
+        assert( false );
+      }
+
+      TTree* tree = dynamic_cast< TTree* >( file->Get( m_treeName.c_str() ) );
+      assert( tree != NULL );
+
+      columns = new ROOTColumnReader( tree );
+      openFile = chunk.file;
+    }
+
+    vector< Kinematics* > events;
+    events.reserve( chunk.size );
+
+    for( Long64_t entry = chunk.first; entry < chunk.first + chunk.size; ++entry ){
+
+      events.push_back( columns->kinematics( entry ) );
+    }
+
+    {
+      lock_guard< mutex > lock( m_mutex );
+      chunk.events.swap( events );
+      chunk.ready = true;
+    }
+    m_chunkReady.notify_all();
+  }
+
+  if( columns != NULL ) delete columns;
+  if( file != NULL ) file->Close();
+  delete file;
+}
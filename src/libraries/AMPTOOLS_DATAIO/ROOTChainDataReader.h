@@ -0,0 +1,113 @@
+#if !defined(ROOTCHAINDATAREADER)
+#define ROOTCHAINDATAREADER
+
+#include "IUAmpTools/Kinematics.h"
+#include "IUAmpTools/UserDataReader.h"
+
+#include "TString.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+class KinematicsCache;
+
+using namespace std;
+
+/**
+ * Reads the same tree format as ROOTDataReader from many files without
+ * merging them first.
+ *
+ * args[0] is either a comma separated list of file names, each of which may
+ * contain wildcards as accepted by TChain::Add, or the name of a text file
+ * ending in .txt or .list with one such name per line.  args[1] is the tree
+ * name (default "kin") and args[2] the number of decoding threads (default
+ * four, at most the number of cores).
+ *
+ * The entries of the chain are split into chunks that the threads decode
+ * ahead of the fit, each with its own TFile, while getEvent() hands out the
+ * events of one chunk after the other.  The events are therefore always
+ * delivered in chain order, independent of the number of threads, and only
+ * a few chunks per thread are held in memory at any time.
+ */
+
+class ROOTChainDataReader : public UserDataReader< ROOTChainDataReader >
+{
+
+public:
+
+  enum { kChunkSize = 100000 };
+
+  /**
+   * Default constructor for ROOTChainDataReader
+   */
+  ROOTChainDataReader() : UserDataReader< ROOTChainDataReader >(),
+    m_numThreads( 0 ), m_started( false ), m_cache( NULL ) { }
+
+  ~ROOTChainDataReader();
+
+  /**
+   * Constructor for ROOTChainDataReader
+   * \param[in] args vector of string arguments
+   */
+  ROOTChainDataReader( const vector< string >& args );
+
+  string name() const { return "ROOTChainDataReader"; }
+
+  virtual Kinematics* getEvent();
+  virtual void resetSource();
+
+  /**
+   * True if the trees have a Weight branch.
+   */
+  virtual bool hasWeight(){ return m_useWeight; };
+  virtual unsigned int numEvents() const;
+
+private:
+
+  struct Chunk {
+
+    unsigned int file;
+    Long64_t first;
+    Long64_t size;
+
+    bool ready;
+    vector< Kinematics* > events;
+  };
+
+  void startThreads();
+  void stopThreads();
+  void decodeChunks();
+
+  string m_treeName;
+  vector< string > m_fileNames;
+  Long64_t m_numEvents;
+  bool m_useWeight;
+
+  vector< Chunk > m_chunks;
+  unsigned int m_numThreads;
+  vector< thread > m_threads;
+
+  // all members below are protected by m_mutex
+  mutex m_mutex;
+  condition_variable m_chunkReady;
+  condition_variable m_chunkConsumed;
+  bool m_started;
+  bool m_stop;
+  unsigned int m_nextChunk;
+  unsigned int m_currentChunk;
+
+  // only used by the reading thread
+  unsigned int m_eventInChunk;
+  chrono::steady_clock::time_point m_startTime;
+
+  // optional binary copy of the events, see KinematicsCache
+  KinematicsCache* m_cache;
+};
+
+#endif
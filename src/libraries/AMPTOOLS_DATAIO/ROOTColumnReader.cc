@@ -0,0 +1,184 @@
+
+#include <cassert>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+
+#include "AMPTOOLS_DATAIO/ROOTColumnReader.h"
+
+using namespace std;
+
+static TBranch*
+kinematicBranch( TTree* tree, const char* name ){
+
+  TBranch* branch = tree->GetBranch( name );
+  if( branch == NULL ){
+
+    cout << "ROOTColumnReader ERROR:  tree " << tree->GetName()
+         << " has no branch " << name << endl;
+    assert( false );
+  }
+
+  tree->AddBranchToCache( branch );
+  return branch;
+}
+
+ROOTColumnReader::ROOTColumnReader( TTree* tree ) :
+  m_tree( tree ),
+  m_numEntries( tree->GetEntries() ),
+  m_blockFirst( 0 ),
+  m_blockSize( 0 ),
+  m_readTime( 0 ),
+  m_entriesRead( 0 )
+{
+  // prefetch only the branches used below
+  m_tree->SetCacheSize( 64 * 1024 * 1024 );
+
+  m_nPartBranch  = kinematicBranch( m_tree, "NumFinalState" );
+  m_eBranch      = kinematicBranch( m_tree, "E_FinalState" );
+  m_pxBranch     = kinematicBranch( m_tree, "Px_FinalState" );
+  m_pyBranch     = kinematicBranch( m_tree, "Py_FinalState" );
+  m_pzBranch     = kinematicBranch( m_tree, "Pz_FinalState" );
+  m_eBeamBranch  = kinematicBranch( m_tree, "E_Beam" );
+  m_pxBeamBranch = kinematicBranch( m_tree, "Px_Beam" );
+  m_pyBeamBranch = kinematicBranch( m_tree, "Py_Beam" );
+  m_pzBeamBranch = kinematicBranch( m_tree, "Pz_Beam" );
+
+  m_weightBranch = m_tree->GetBranch( "Weight" );
+  if( m_weightBranch != NULL ) m_tree->AddBranchToCache( m_weightBranch );
+
+  m_tree->StopCacheLearningPhase();
+
+  // branches are read one at a time so they can share the
+  // single entry buffers
+  m_tree->SetBranchAddress( "NumFinalState", &m_nPartEntry );
+  m_tree->SetBranchAddress( "E_FinalState", m_arrayEntry );
+  m_tree->SetBranchAddress( "Px_FinalState", m_arrayEntry );
+  m_tree->SetBranchAddress( "Py_FinalState", m_arrayEntry );
+  m_tree->SetBranchAddress( "Pz_FinalState", m_arrayEntry );
+  m_tree->SetBranchAddress( "E_Beam", &m_scalarEntry );
+  m_tree->SetBranchAddress( "Px_Beam", &m_scalarEntry );
+  m_tree->SetBranchAddress( "Py_Beam", &m_scalarEntry );
+  m_tree->SetBranchAddress( "Pz_Beam", &m_scalarEntry );
+  if( m_weightBranch != NULL )
+    m_tree->SetBranchAddress( "Weight", &m_scalarEntry );
+
+  m_nPart.resize( kBlockSize );
+  m_e.resize( kBlockSize * Kinematics::kMaxParticles );
+  m_px.resize( kBlockSize * Kinematics::kMaxParticles );
+  m_py.resize( kBlockSize * Kinematics::kMaxParticles );
+  m_pz.resize( kBlockSize * Kinematics::kMaxParticles );
+  m_eBeam.resize( kBlockSize );
+  m_pxBeam.resize( kBlockSize );
+  m_pyBeam.resize( kBlockSize );
+  m_pzBeam.resize( kBlockSize );
+  if( m_weightBranch != NULL ) m_weight.resize( kBlockSize );
+}
+
+bool
+ROOTColumnReader::readEntry( Long64_t entry ){
+
+  if( entry < 0 || entry >= m_numEntries ) return false;
+
+  if( entry < m_blockFirst || entry >= m_blockFirst + m_blockSize )
+    readBlock( entry );
+
+  return true;
+}
+
+float
+ROOTColumnReader::weight( Long64_t entry ) const {
+
+  return ( m_weightBranch != NULL ? m_weight[entry-m_blockFirst] : 1.0 );
+}
+
+void
+ROOTColumnReader::particleList( Long64_t entry,
+                                vector< TLorentzVector >& particles ) const {
+
+  int i = entry - m_blockFirst;
+  int nPart = m_nPart[i];
+
+  particles.clear();
+  particles.reserve( nPart + 1 );
+
+  particles.push_back( TLorentzVector( m_pxBeam[i], m_pyBeam[i],
+                                       m_pzBeam[i], m_eBeam[i] ) );
+
+  const int offset = i * Kinematics::kMaxParticles;
+  for( int j = offset; j < offset + nPart; ++j ){
+
+    particles.push_back( TLorentzVector( m_px[j], m_py[j], m_pz[j], m_e[j] ) );
+  }
+}
+
+Kinematics*
+ROOTColumnReader::kinematics( Long64_t entry ){
+
+  if( !readEntry( entry ) ) return NULL;
+
+  vector< TLorentzVector > particles;
+  particleList( entry, particles );
+
+  return new Kinematics( particles, weight( entry ) );
+}
+
+void
+ROOTColumnReader::readBlock( Long64_t first ){
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  m_blockFirst = first;
+  m_blockSize = ( m_numEntries - first < kBlockSize ?
+                  m_numEntries - first : kBlockSize );
+
+  // the length of the final state arrays is needed first
+  for( int i = 0; i < m_blockSize; ++i ){
+
+    m_nPartBranch->GetEntry( m_blockFirst + i );
+    assert( m_nPartEntry < Kinematics::kMaxParticles );
+    m_nPart[i] = m_nPartEntry;
+  }
+
+  readArray( m_eBranch, m_e, m_blockSize );
+  readArray( m_pxBranch, m_px, m_blockSize );
+  readArray( m_pyBranch, m_py, m_blockSize );
+  readArray( m_pzBranch, m_pz, m_blockSize );
+
+  readScalar( m_eBeamBranch, m_scalarEntry, m_eBeam, m_blockSize );
+  readScalar( m_pxBeamBranch, m_scalarEntry, m_pxBeam, m_blockSize );
+  readScalar( m_pyBeamBranch, m_scalarEntry, m_pyBeam, m_blockSize );
+  readScalar( m_pzBeamBranch, m_scalarEntry, m_pzBeam, m_blockSize );
+
+  if( m_weightBranch != NULL )
+    readScalar( m_weightBranch, m_scalarEntry, m_weight, m_blockSize );
+
+  m_entriesRead += m_blockSize;
+  m_readTime += chrono::duration< double >( chrono::steady_clock::now() - start ).count();
+}
+
+void
+ROOTColumnReader::readScalar( TBranch* branch, float& address,
+                              vector< float >& column, int nEntries ){
+
+  for( int i = 0; i < nEntries; ++i ){
+
+    branch->GetEntry( m_blockFirst + i );
+    column[i] = address;
+  }
+}
+
+void
+ROOTColumnReader::readArray( TBranch* branch, vector< float >& column,
+                             int nEntries ){
+
+  for( int i = 0; i < nEntries; ++i ){
+
+    // ROOT reads the length of the array from the NumFinalState branch
+    // for this entry, only the first m_nPart[i] values are filled
+    branch->GetEntry( m_blockFirst + i );
+
+    memcpy( &(column[i*Kinematics::kMaxParticles]), m_arrayEntry,
+            m_nPart[i] * sizeof( float ) );
+  }
+}
@@ -0,0 +1,104 @@
+#if !defined(ROOTCOLUMNREADER)
+#define ROOTCOLUMNREADER
+
+#include "IUAmpTools/Kinematics.h"
+
+#include "TTree.h"
+#include "TBranch.h"
+#include "TLorentzVector.h"
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Reads the standard kinematic tree format (NumFinalState, E/Px/Py/Pz_FinalState,
+ * E/Px/Py/Pz_Beam and optionally Weight) in blocks of consecutive entries.
+ *
+ * Only the branches that are needed are enabled and added to the
+ * TTreeCache.  A block is filled one branch at a time with
+ * TBranch::GetEntry for each entry, copying the value from a reused
+ * single-entry buffer into a column.  This does not use ROOT's bulk
+ * interface and decompresses no less than TTree::GetEntry would; it only
+ * avoids reading the unused branches.  The data readers build their
+ * Kinematics objects from the columns.
+ */
+
+class ROOTColumnReader
+{
+
+public:
+
+  enum { kBlockSize = 10000 };
+
+  ROOTColumnReader( TTree* tree );
+
+  Long64_t numEntries() const { return m_numEntries; }
+  bool hasWeight() const { return m_weightBranch != NULL; }
+
+  /**
+   * Makes sure the block containing this entry is in memory.  Returns
+   * false if the entry is beyond the end of the tree.
+   */
+  bool readEntry( Long64_t entry );
+
+  /**
+   * The accessors below require a previous readEntry( entry ) and stay
+   * valid until the next block is read.
+   */
+  int numParticles( Long64_t entry ) const { return m_nPart[entry-m_blockFirst]; }
+  float weight( Long64_t entry ) const;
+  void particleList( Long64_t entry, vector< TLorentzVector >& particles ) const;
+
+  /**
+   * Convenience function that reads the entry and returns a new
+   * Kinematics object (owned by the caller), or NULL past the end.
+   */
+  Kinematics* kinematics( Long64_t entry );
+
+  /**
+   * Total time spent reading blocks and the number of entries read,
+   * used to report the loading rate (AMPTOOLS_READ_STATS=1).
+   */
+  double readTime() const { return m_readTime; }
+  Long64_t entriesRead() const { return m_entriesRead; }
+
+private:
+
+  void readBlock( Long64_t first );
+  void readScalar( TBranch* branch, float& address, vector< float >& column, int nEntries );
+  void readArray( TBranch* branch, vector< float >& column, int nEntries );
+
+  TTree* m_tree;
+  Long64_t m_numEntries;
+
+  TBranch* m_nPartBranch;
+  TBranch* m_eBranch;
+  TBranch* m_pxBranch;
+  TBranch* m_pyBranch;
+  TBranch* m_pzBranch;
+  TBranch* m_eBeamBranch;
+  TBranch* m_pxBeamBranch;
+  TBranch* m_pyBeamBranch;
+  TBranch* m_pzBeamBranch;
+  TBranch* m_weightBranch;
+
+  // branch addresses for a single entry
+  int m_nPartEntry;
+  float m_arrayEntry[Kinematics::kMaxParticles];
+  float m_scalarEntry;
+
+  // columns of the block in memory; the final state arrays hold
+  // kMaxParticles values per entry
+  Long64_t m_blockFirst;
+  int m_blockSize;
+  vector< int > m_nPart;
+  vector< float > m_e, m_px, m_py, m_pz;
+  vector< float > m_eBeam, m_pxBeam, m_pyBeam, m_pzBeam;
+  vector< float > m_weight;
+
+  double m_readTime;
+  Long64_t m_entriesRead;
+};
+
+#endif
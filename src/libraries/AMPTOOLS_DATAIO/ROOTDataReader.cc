@@ -2,10 +2,13 @@
 #include <vector>
 #include <cassert>
 #include <iostream>
+#include <cstdlib>
 
 #include "TLorentzVector.h"
 
 #include "AMPTOOLS_DATAIO/ROOTDataReader.h"
+#include "AMPTOOLS_DATAIO/ROOTColumnReader.h"
+#include "AMPTOOLS_DATAIO/KinematicsCache.h"
 #include "IUAmpTools/Kinematics.h"
 
 #include "TH1.h"
@@ -14,14 +17,35 @@
 
 using namespace std;
 
+// AMPTOOLS_READ_STATS=1 reports the time spent reading at the end of
+// every pass over the tree
+static bool
+reportReadStats(){
+
+  static const bool report = ( getenv( "AMPTOOLS_READ_STATS" ) != NULL &&
+                               string( getenv( "AMPTOOLS_READ_STATS" ) ) != "0" );
+  return report;
+}
+
 ROOTDataReader::ROOTDataReader( const vector< string >& args ):
   UserDataReader< ROOTDataReader >( args ),
+  m_inFile( NULL ),
+  m_inTree( NULL ),
   m_eventCounter( 0 ),
-  m_useWeight( false )
+  m_useWeight( false ),
+  m_columns( NULL )
 {
   assert( args.size() == 2 || args.size() == 1 );
   
   TH1::AddDirectory( kFALSE );
+
+  m_cache = KinematicsCache::open( name(), args, vector< string >( 1, args[0] ) );
+  if( m_cache != NULL && m_cache->isComplete() ){
+
+    // no need to open the ROOT file at all
+    m_useWeight = m_cache->hasWeight();
+    return;
+  }
   
   //this way of opening files works with URLs of the form
   // root://xrootdserver/path/to/myfile.root
@@ -38,38 +62,27 @@ ROOTDataReader::ROOTDataReader( const vector< string >& args ):
     m_inTree = dynamic_cast<TTree*>( m_inFile->Get( args[1].c_str() ) );
   }
   
-  m_inTree->SetBranchAddress( "NumFinalState", &m_nPart );
-  m_inTree->SetBranchAddress( "E_FinalState", m_e );
-  m_inTree->SetBranchAddress( "Px_FinalState", m_px );
-  m_inTree->SetBranchAddress( "Py_FinalState", m_py );
-  m_inTree->SetBranchAddress( "Pz_FinalState", m_pz );
-  m_inTree->SetBranchAddress( "E_Beam", &m_eBeam );
-  m_inTree->SetBranchAddress( "Px_Beam", &m_pxBeam );
-  m_inTree->SetBranchAddress( "Py_Beam", &m_pyBeam );
-  m_inTree->SetBranchAddress( "Pz_Beam", &m_pzBeam );
-
-  if(m_inTree->GetBranch("Weight") != NULL) {
-
-    m_useWeight = true;
-    m_inTree->SetBranchAddress( "Weight", &m_weight );
-  }
-  else{
-
-    m_useWeight = false;
-  }
+  m_columns = new ROOTColumnReader( m_inTree );
+  m_useWeight = m_columns->hasWeight();
 }
 
 ROOTDataReader::~ROOTDataReader()
 {
+  if( m_cache != NULL ) delete m_cache;
+  if( m_columns != NULL ) delete m_columns;
   if( m_inFile != NULL ) m_inFile->Close();
 }
 
 void
 ROOTDataReader::resetSource()
 {
-	
-  cout << "Resetting source " << m_inTree->GetName() 
-       << " in " << m_inFile->GetName() << endl;
+  if( m_cache != NULL ) m_cache->rewind();
+
+  if( m_inTree != NULL ){
+
+    cout << "Resetting source " << m_inTree->GetName() 
+         << " in " << m_inFile->GetName() << endl;
+  }
   
   // this will cause the read to start back at event 0
   m_eventCounter = 0;
@@ -78,32 +91,34 @@ ROOTDataReader::resetSource()
 Kinematics*
 ROOTDataReader::getEvent()
 {
-  if( m_eventCounter < static_cast< unsigned int >( m_inTree->GetEntries() ) ){
-    //  if( m_eventCounter < 10 ){
-    
-    m_inTree->GetEntry( m_eventCounter++ );
-    assert( m_nPart < Kinematics::kMaxParticles );
-    
-    vector< TLorentzVector > particleList;
-    
-    particleList.
-      push_back( TLorentzVector( m_pxBeam, m_pyBeam, m_pzBeam, m_eBeam ) );
-    
-    for( int i = 0; i < m_nPart; ++i ){
-      
-      particleList.push_back( TLorentzVector( m_px[i], m_py[i], m_pz[i], m_e[i] ) );
-    }
-    
-    return new Kinematics( particleList, m_useWeight ? m_weight : 1.0 );
+  if( m_cache != NULL && m_cache->isComplete() ) return m_cache->nextEvent();
+
+  Kinematics* kin = m_columns->kinematics( m_eventCounter );
+
+  if( m_cache != NULL ){
+
+    if( kin != NULL ) m_cache->record( kin, m_useWeight );
+    else m_cache->finish();
   }
-  else{
+
+  if( kin != NULL ){
     
-    return NULL;
+    ++m_eventCounter;
+  }
+  else if( reportReadStats() && m_columns->readTime() > 0 ){
+
+    cout << "Read " << m_columns->entriesRead() << " events from "
+         << m_inTree->GetName() << " in " << m_columns->readTime() << " s ("
+         << m_columns->entriesRead() / m_columns->readTime() << " events/s)" << endl;
   }
+
+  return kin;
 }
 
 unsigned int
 ROOTDataReader::numEvents() const
 {	
+  if( m_cache != NULL && m_cache->isComplete() ) return m_cache->numEvents();
+
   return static_cast< unsigned int >( m_inTree->GetEntries() );
 }
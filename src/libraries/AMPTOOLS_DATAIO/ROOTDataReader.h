@@ -10,6 +10,9 @@
 
 #include <string>
 
+class ROOTColumnReader;
+class KinematicsCache;
+
 using namespace std;
 
 class ROOTDataReader : public UserDataReader< ROOTDataReader >
@@ -20,7 +23,8 @@ public:
   /**
    * Default constructor for ROOTDataReader
    */
-  ROOTDataReader() : UserDataReader< ROOTDataReader >(), m_inFile( NULL ) { }
+  ROOTDataReader() : UserDataReader< ROOTDataReader >(), m_inFile( NULL ),
+    m_columns( NULL ), m_cache( NULL ) { }
   
   ~ROOTDataReader();
   
@@ -50,16 +54,11 @@ private:
   unsigned int m_eventCounter;
   bool m_useWeight;
   
-  int m_nPart;
-  float m_e[Kinematics::kMaxParticles];
-  float m_px[Kinematics::kMaxParticles];
-  float m_py[Kinematics::kMaxParticles];
-  float m_pz[Kinematics::kMaxParticles];
-  float m_eBeam;
-  float m_pxBeam;
-  float m_pyBeam;
-  float m_pzBeam;
-  float m_weight;
+  // reads the kinematic branches in blocks of entries
+  ROOTColumnReader* m_columns;
+
+  // optional binary copy of the events, see KinematicsCache
+  KinematicsCache* m_cache;
 };
 
 #endif
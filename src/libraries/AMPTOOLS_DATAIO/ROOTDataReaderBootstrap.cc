@@ -8,6 +8,7 @@
 #include "TLorentzVector.h"
 
 #include "AMPTOOLS_DATAIO/ROOTDataReaderBootstrap.h"
+#include "AMPTOOLS_DATAIO/ROOTColumnReader.h"
 #include "IUAmpTools/Kinematics.h"
 
 #include "TH1.h"
@@ -19,7 +20,10 @@ using namespace std;
 ROOTDataReaderBootstrap::ROOTDataReaderBootstrap( const vector< string >& args ):
 UserDataReader< ROOTDataReaderBootstrap >( args ),
 m_eventCounter( 0 ),
-m_useWeight( false )
+m_useWeight( false ),
+m_nextEntry( 0 ),
+m_currentEntry( 0 ),
+m_copiesLeft( 0 )
 {
   
   // arguments:
@@ -57,38 +61,27 @@ m_useWeight( false )
     m_inTree = dynamic_cast<TTree*>( m_inFile->Get( args[2].c_str() ) );
   }
   
-  m_inTree->SetBranchAddress( "NumFinalState", &m_nPart );
-  m_inTree->SetBranchAddress( "E_FinalState", m_e );
-  m_inTree->SetBranchAddress( "Px_FinalState", m_px );
-  m_inTree->SetBranchAddress( "Py_FinalState", m_py );
-  m_inTree->SetBranchAddress( "Pz_FinalState", m_pz );
-  m_inTree->SetBranchAddress( "E_Beam", &m_eBeam );
-  m_inTree->SetBranchAddress( "Px_Beam", &m_pxBeam );
-  m_inTree->SetBranchAddress( "Py_Beam", &m_pyBeam );
-  m_inTree->SetBranchAddress( "Pz_Beam", &m_pzBeam );
-  
-  if(m_inTree->GetBranch("Weight") != NULL) {
-    
-    m_useWeight = true;
-    m_inTree->SetBranchAddress( "Weight", &m_weight );
-  }
-  else{
-    
-    m_useWeight = false;
-  }
+  m_columns = new ROOTColumnReader( m_inTree );
+  m_useWeight = m_columns->hasWeight();
 
   unsigned int nEvents = numEvents();
+
+  // draw nEvents entries with replacement, but only count how often each
+  // entry was drawn -- the same draws as a sorted list of indices, so a
+  // given seed still selects the same sample
+  m_multiplicity.assign( nEvents, 0 );
   
   for( unsigned int i = 0; i < nEvents; ++i ){
 
-    m_entryOrder.insert( (unsigned int)floor( m_randGenerator->Rndm()*nEvents ) );
+    unsigned int entry = (unsigned int)floor( m_randGenerator->Rndm()*nEvents );
+    assert( m_multiplicity[entry] < 255 );
+    ++m_multiplicity[entry];
   }
-
-  m_nextEntry = m_entryOrder.begin();
 }
 
 ROOTDataReaderBootstrap::~ROOTDataReaderBootstrap()
 {
+  if( m_columns != NULL ) delete m_columns;
   if( m_inFile != NULL ) m_inFile->Close();
   if( m_randGenerator ) delete m_randGenerator;
 }
@@ -102,35 +95,27 @@ ROOTDataReaderBootstrap::resetSource()
   
   // this will cause the read to start back at event 0
   m_eventCounter = 0;
-  m_nextEntry = m_entryOrder.begin();
+  m_nextEntry = 0;
+  m_copiesLeft = 0;
 }
 
 Kinematics*
 ROOTDataReaderBootstrap::getEvent()
 {
-  if( m_eventCounter++ < numEvents() ){
+  // the file is read sequentially and every entry is repeated as many
+  // times as it was drawn
+  while( m_copiesLeft == 0 && m_nextEntry < m_multiplicity.size() ){
 
-    assert( m_nextEntry != m_entryOrder.end() );
-    
-    m_inTree->GetEntry( *m_nextEntry++ );
-    assert( m_nPart < Kinematics::kMaxParticles );
-    
-    vector< TLorentzVector > particleList;
-    
-    particleList.
-    push_back( TLorentzVector( m_pxBeam, m_pyBeam, m_pzBeam, m_eBeam ) );
-    
-    for( int i = 0; i < m_nPart; ++i ){
-      
-      particleList.push_back( TLorentzVector( m_px[i], m_py[i], m_pz[i], m_e[i] ) );
-    }
-    
-    return new Kinematics( particleList, m_useWeight ? m_weight : 1.0 );
-  }
-  else{
-    
-    return NULL;
+    m_currentEntry = m_nextEntry;
+    m_copiesLeft = m_multiplicity[m_nextEntry++];
   }
+
+  if( m_copiesLeft == 0 ) return NULL;
+
+  --m_copiesLeft;
+  ++m_eventCounter;
+
+  return m_columns->kinematics( m_currentEntry );
 }
 
 unsigned int
@@ -10,7 +10,9 @@
 #include "TTree.h"
 
 #include <string>
-#include <set>
+#include <vector>
+
+class ROOTColumnReader;
 
 using namespace std;
 
@@ -25,7 +27,8 @@ public:
  ROOTDataReaderBootstrap() : 
   UserDataReader< ROOTDataReaderBootstrap >(), 
     m_inFile( NULL ), 
-    m_randGenerator( NULL ) { }
+    m_randGenerator( NULL ),
+    m_columns( NULL ) { }
   
   ~ROOTDataReaderBootstrap();
   
@@ -61,19 +64,13 @@ private:
   
   TRandom2* m_randGenerator;
   
-  int m_nPart;
-  float m_e[Kinematics::kMaxParticles];
-  float m_px[Kinematics::kMaxParticles];
-  float m_py[Kinematics::kMaxParticles];
-  float m_pz[Kinematics::kMaxParticles];
-  float m_eBeam;
-  float m_pxBeam;
-  float m_pyBeam;
-  float m_pzBeam;
-  float m_weight;
+  ROOTColumnReader* m_columns;
 
-  multiset< unsigned int > m_entryOrder;
-  mutable multiset< unsigned int >::const_iterator m_nextEntry;
+  // number of times each entry was drawn for this sample
+  vector< unsigned char > m_multiplicity;
+  unsigned int m_nextEntry;
+  unsigned int m_currentEntry;
+  unsigned int m_copiesLeft;
 };
 
 #endif
@@ -6,6 +6,7 @@
 #include "TLorentzVector.h"
 
 #include "ROOTDataReaderTEM.h"
+#include "AMPTOOLS_DATAIO/KinematicsCache.h"
 #include "IUAmpTools/Kinematics.h"
 
 #include "TH1.h"
@@ -16,6 +17,8 @@ using namespace std;
 
 ROOTDataReaderTEM::ROOTDataReaderTEM( const vector< string >& args ):
    UserDataReader< ROOTDataReaderTEM >( args ),
+   m_inFile( NULL ),
+   m_inTree( NULL ),
    m_eventCounter( 0 ),
    m_useWeight( false )
 {
@@ -23,6 +26,17 @@ ROOTDataReaderTEM::ROOTDataReaderTEM( const vector< string >& args ):
 
    TH1::AddDirectory( kFALSE );
 
+   // the cache holds only the selected events, so not even the
+   // selection pass below is needed
+   m_cache = KinematicsCache::open( name(), args, vector< string >( 1, args[0] ) );
+   if( m_cache != NULL && m_cache->isComplete() ){
+
+      m_numEvents = m_cache->numEvents();
+      m_useWeight = m_cache->hasWeight();
+      m_RangeSpecified = true;
+      return;
+   }
+
    //this way of opening files works with URLs of the form
    // root://xrootdserver/path/to/myfile.root
    m_inFile = TFile::Open( args[0].c_str() );
@@ -77,12 +91,16 @@ ROOTDataReaderTEM::ROOTDataReaderTEM( const vector< string >& args ):
       cout << "ROOT Data reader  Inv. Mass range specified [" << m_MMin << "," << m_MMax << ")" << endl;
       cout << "Total events: " <<  m_inTree->GetEntries() << endl;
 
+      // remember the passing entries so later passes neither read
+      // the rejected entries nor evaluate the cuts again
       while( m_eventCounter < static_cast< unsigned int >( m_inTree->GetEntries() ) ){
 
-	 m_inTree->GetEntry( m_eventCounter++ );
-         if(checkEvent()) m_numEvents++;
-
+	 m_inTree->GetEntry( m_eventCounter );
+         if(checkEvent()) m_selectedEntries.push_back( m_eventCounter );
+         ++m_eventCounter;
       }
+      m_eventCounter = 0;
+      m_numEvents = m_selectedEntries.size();
       cout << "Number of events kept    = " << m_numEvents << endl;
       cout << "*********************************************" << endl;
    }   
@@ -90,14 +108,19 @@ ROOTDataReaderTEM::ROOTDataReaderTEM( const vector< string >& args ):
 
 ROOTDataReaderTEM::~ROOTDataReaderTEM()
 {
+   if( m_cache != NULL ) delete m_cache;
    if( m_inFile != NULL ) m_inFile->Close();
 }
 
 void ROOTDataReaderTEM::resetSource()
 {
+   if( m_cache != NULL ) m_cache->rewind();
 
-   cout << "Resetting source " << m_inTree->GetName() 
-      << " in " << m_inFile->GetName() << endl;
+   if( m_inTree != NULL ){
+
+      cout << "Resetting source " << m_inTree->GetName() 
+         << " in " << m_inFile->GetName() << endl;
+   }
 
    // this will cause the read to start back at event 0
    m_eventCounter = 0;
@@ -105,6 +128,24 @@ void ROOTDataReaderTEM::resetSource()
 
    Kinematics*
 ROOTDataReaderTEM::getEvent()
+{
+   if( m_cache != NULL ){
+
+      if( m_cache->isComplete() ) return m_cache->nextEvent();
+
+      Kinematics* kin = readEvent();
+
+      if( kin != NULL ) m_cache->record( kin, m_useWeight );
+      else m_cache->finish();
+
+      return kin;
+   }
+
+   return readEvent();
+}
+
+   Kinematics*
+ROOTDataReaderTEM::readEvent()
 {
 
    if (m_RangeSpecified == false){
@@ -121,14 +162,12 @@ ROOTDataReaderTEM::getEvent()
    } 
    else{
 
-      while( m_eventCounter < static_cast< unsigned int >( m_inTree->GetEntries() ) ){
+      if( m_eventCounter < m_selectedEntries.size() ){
 
-	  m_inTree->GetEntry( m_eventCounter++ );
+	  m_inTree->GetEntry( m_selectedEntries[m_eventCounter++] );
 	  assert( m_nPart < Kinematics::kMaxParticles );
 	  
-	  if(checkEvent())
-		  return new Kinematics( particleList(), m_useWeight ? m_weight : 1.0 ); 
-
+	  return new Kinematics( particleList(), m_useWeight ? m_weight : 1.0 ); 
       }
       return NULL;
    }
@@ -9,6 +9,9 @@
 #include "TTree.h"
 
 #include <string>
+#include <vector>
+
+class KinematicsCache;
 
 using namespace std;
 
@@ -20,7 +23,8 @@ public:
   /**
    * Default constructor for ROOTDataReaderTEM
    */
-  ROOTDataReaderTEM() : UserDataReader< ROOTDataReaderTEM >(), m_inFile( NULL ) { }
+  ROOTDataReaderTEM() : UserDataReader< ROOTDataReaderTEM >(), m_inFile( NULL ),
+    m_cache( NULL ) { }
   
   ~ROOTDataReaderTEM();
   
@@ -46,6 +50,9 @@ public:
   virtual unsigned int numEvents() const;
   
 private:
+
+  // next event from the ROOT tree that passes the cuts
+  Kinematics* readEvent();
 	
   TFile* m_inFile;
   TTree* m_inTree;
@@ -63,6 +70,12 @@ private:
   float m_pyBeam;
   float m_pzBeam;
   float m_weight;
+
+  // tree entries that pass the cuts, found in a single pass on construction
+  vector< unsigned int > m_selectedEntries;
+
+  // optional binary copy of the selected events, see KinematicsCache
+  KinematicsCache* m_cache;
 };
 
 #endif
@@ -6,6 +6,7 @@
 #include "TLorentzVector.h"
 
 #include "AMPTOOLS_DATAIO/ROOTDataReaderWithTCut.h"
+#include "AMPTOOLS_DATAIO/KinematicsCache.h"
 #include "IUAmpTools/Kinematics.h"
 
 #include "TH1.h"
@@ -16,6 +17,8 @@ using namespace std;
 
 ROOTDataReaderWithTCut::ROOTDataReaderWithTCut( const vector< string >& args ):
    UserDataReader< ROOTDataReaderWithTCut >( args ),
+   m_inFile( NULL ),
+   m_inTree( NULL ),
    m_eventCounter( 0 ),
    m_useWeight( false )
 {
@@ -23,6 +26,16 @@ ROOTDataReaderWithTCut::ROOTDataReaderWithTCut( const vector< string >& args ):
 
    TH1::AddDirectory( kFALSE );
 
+   // the cache holds only the events in the t range, so the scan
+   // below is skipped as well
+   m_cache = KinematicsCache::open( name(), args, vector< string >( 1, args[0] ) );
+   if( m_cache != NULL && m_cache->isComplete() ){
+
+      m_numEvents = m_cache->numEvents();
+      m_useWeight = m_cache->hasWeight();
+      return;
+   }
+
    //this way of opening files works with URLs of the form
    // root://xrootdserver/path/to/myfile.root
    m_inFile = TFile::Open( args[0].c_str() );
@@ -91,10 +104,13 @@ ROOTDataReaderWithTCut::ROOTDataReaderWithTCut( const vector< string >& args ):
          TLorentzVector target = TLorentzVector(0.0,0.0,0.0,0.938272);
          double tMag = fabs((target-particleList[1]).M2());
 
+         // later passes read only these entries
          if (m_tMin <= tMag && tMag < m_tMax){
-            m_numEvents++;
+            m_selectedEntries.push_back( m_eventCounter - 1 );
          }
       }
+      m_eventCounter = 0;
+      m_numEvents = m_selectedEntries.size();
       cout << "Number of events kept    = " << m_numEvents << endl;
       cout << "*********************************************" << endl;
    }
@@ -102,21 +118,41 @@ ROOTDataReaderWithTCut::ROOTDataReaderWithTCut( const vector< string >& args ):
 
 ROOTDataReaderWithTCut::~ROOTDataReaderWithTCut()
 {
+   if( m_cache != NULL ) delete m_cache;
    if( m_inFile != NULL ) m_inFile->Close();
 }
 
 void ROOTDataReaderWithTCut::resetSource()
 {
+   if( m_cache != NULL ) m_cache->rewind();
 
-   cout << "Resetting source " << m_inTree->GetName() 
-      << " in " << m_inFile->GetName() << endl;
+   if( m_inTree != NULL ){
+
+      cout << "Resetting source " << m_inTree->GetName() 
+         << " in " << m_inFile->GetName() << endl;
+   }
 
    // this will cause the read to start back at event 0
    m_eventCounter = 0;
 }
 
-   Kinematics*
+Kinematics*
 ROOTDataReaderWithTCut::getEvent()
+{
+   if( m_cache == NULL ) return readEvent();
+
+   if( m_cache->isComplete() ) return m_cache->nextEvent();
+
+   Kinematics* kin = readEvent();
+
+   if( kin != NULL ) m_cache->record( kin, m_useWeight );
+   else m_cache->finish();
+
+   return kin;
+}
+
+   Kinematics*
+ROOTDataReaderWithTCut::readEvent()
 {
 
 
@@ -144,9 +180,9 @@ ROOTDataReaderWithTCut::getEvent()
       } 
       else{
 
-         while( m_eventCounter < static_cast< unsigned int >( m_inTree->GetEntries() ) ){
+         if( m_eventCounter < m_selectedEntries.size() ){
 
-            m_inTree->GetEntry( m_eventCounter++ );
+            m_inTree->GetEntry( m_selectedEntries[m_eventCounter++] );
             assert( m_nPart < Kinematics::kMaxParticles );
 
             vector< TLorentzVector > particleList;
@@ -159,15 +195,7 @@ ROOTDataReaderWithTCut::getEvent()
                particleList.push_back( TLorentzVector( m_px[i], m_py[i], m_pz[i], m_e[i] ) );
             }
 
-            // Calculate -t and check if it is in range
-            // Use the reconstructed proton
-            TLorentzVector target = TLorentzVector(0.0,0.0,0.0,0.938272);
-            double tMag = fabs((target-particleList[1]).M2());
-
-            if (m_tMin <= tMag && tMag < m_tMax){
-               return new Kinematics( particleList, m_useWeight ? m_weight : 1.0 ); 
-            }
-
+            return new Kinematics( particleList, m_useWeight ? m_weight : 1.0 ); 
          }
          return NULL;
       }
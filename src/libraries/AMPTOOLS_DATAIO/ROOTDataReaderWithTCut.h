@@ -9,9 +9,12 @@
 #include "TTree.h"
 
 #include <string>
+#include <vector>
 
 using namespace std;
 
+class KinematicsCache;
+
 class ROOTDataReaderWithTCut : public UserDataReader< ROOTDataReaderWithTCut >
 {
 	
@@ -20,7 +23,8 @@ public:
   /**
    * Default constructor for ROOTDataReaderWithTCut
    */
-  ROOTDataReaderWithTCut() : UserDataReader< ROOTDataReaderWithTCut >(), m_inFile( NULL ) { }
+  ROOTDataReaderWithTCut() : UserDataReader< ROOTDataReaderWithTCut >(), m_inFile( NULL ),
+    m_cache( NULL ) { }
   
   ~ROOTDataReaderWithTCut();
   
@@ -44,6 +48,9 @@ public:
   virtual unsigned int numEvents() const;
   
 private:
+
+  // next event from the ROOT tree within the t range
+  Kinematics* readEvent();
 	
   TFile* m_inFile;
   TTree* m_inTree;
@@ -61,6 +68,12 @@ private:
   float m_pyBeam;
   float m_pzBeam;
   float m_weight;
+
+  // tree entries in the t range, found in a single pass on construction
+  vector< unsigned int > m_selectedEntries;
+
+  // optional binary copy of the selected events, see KinematicsCache
+  KinematicsCache* m_cache;
 };
 
 #endif
@@ -3,22 +3,29 @@
 #include <cassert>
 
 #include "AMPTOOLS_DATAIO/ROOTDataWriter.h"
+#include "AMPTOOLS_DATAIO/AsyncWriteQueue.h"
 
 #include "TFile.h"
 #include "TTree.h"
 #include "TH1.h"
+#include "TROOT.h"
 
 
 void ROOTDataWriter::IOinit( const string& outFile,
                              const string& outTreeName,
-                             bool overwrite, bool writeWeight)
+                             bool overwrite, bool writeWeight,
+                             const ROOTWriterSettings& settings )
 {
 
   TH1::AddDirectory( kFALSE );
+  // the tree is filled and compressed on the thread of the queue
+  if( settings.async() ) ROOT::EnableThreadSafety();
+
   string writeMode="recreate";
   if(!overwrite) writeMode="update";
 
   m_outFile = new TFile( outFile.c_str(), writeMode.c_str() );
+  settings.applyToFile( m_outFile );
   m_outTree = new TTree( outTreeName.c_str(), "Kinematics" );
 
   m_outTree->Branch( "NumFinalState", &m_nPart, "NumFinalState/I" );
@@ -32,12 +39,23 @@ void ROOTDataWriter::IOinit( const string& outFile,
   m_outTree->Branch( "Pz_Beam", &m_pzBeam, "Pz_Beam/F" );
   if(writeWeight)
     m_outTree->Branch( "Weight", &m_weight, "Weight/F" );  
+
+  settings.applyToTree( m_outTree );
   
   m_eventCounter = 0;
+
+  m_queue = NULL;
+  if( settings.async() ){
+
+    m_queue = new AsyncWriteQueue( [this]( const Kinematics& kin ){ fillEvent( kin ); } );
+  }
 }
 
 ROOTDataWriter::~ROOTDataWriter()
 {
+	// fills the events that are still queued
+	if( m_queue != NULL ) delete m_queue;
+
 	m_outFile->cd();
 	m_outTree->Write();
 	m_outFile->Close();
@@ -45,6 +63,15 @@ ROOTDataWriter::~ROOTDataWriter()
 
 void
 ROOTDataWriter::writeEvent( const Kinematics& kin )
+{
+  if( m_queue != NULL ) m_queue->push( kin );
+  else fillEvent( kin );
+
+  m_eventCounter++;
+}
+
+void
+ROOTDataWriter::fillEvent( const Kinematics& kin )
 {
   vector< TLorentzVector > particleList = kin.particleList();
   
@@ -68,7 +95,4 @@ ROOTDataWriter::writeEvent( const Kinematics& kin )
   m_weight = kin.weight(); //will not get saved if branch not added in IOinit()
   
   m_outTree->Fill();
-  
-  m_eventCounter++;
-  
 }
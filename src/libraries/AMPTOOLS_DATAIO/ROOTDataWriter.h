@@ -3,10 +3,13 @@
 
 #include "IUAmpTools/Kinematics.h"
 #include "AMPTOOLS_DATAIO/DataWriter.h"
+#include "AMPTOOLS_DATAIO/ROOTWriterSettings.h"
 
 #include "TTree.h"
 #include "TFile.h"
 
+class AsyncWriteQueue;
+
 class ROOTDataWriter : public DataWriter
 {
 
@@ -20,12 +23,16 @@ public:
    * \param[in] overwrite (optional) boolean parameter specifying whether to
    *               overwrite (default) or update the ROOT file.
    * \param[in] writeWeight (optional) enables writing of the event weight in the ROOT file
+   * \param[in] settings (optional) compression, basket size and asynchronous
+   *               writing; by default taken from the environment
    */
   ROOTDataWriter( const string& outFile,
                   const string& outTreeName="kin",
-                  bool overwrite=true, bool writeWeight=false )
+                  bool overwrite=true, bool writeWeight=false,
+                  const ROOTWriterSettings& settings =
+                    ROOTWriterSettings::fromEnvironment() )
   {
-    IOinit(outFile, outTreeName, overwrite, writeWeight);
+    IOinit(outFile, outTreeName, overwrite, writeWeight, settings);
   };
  
   ~ROOTDataWriter();
@@ -39,7 +46,10 @@ private:
   
   void IOinit( const string& outFile,
 	       const string& outTreeName,
-	       bool overwrite, bool writeWeight);  
+	       bool overwrite, bool writeWeight,
+	       const ROOTWriterSettings& settings );  
+
+  void fillEvent( const Kinematics& kin );
   
   TFile* m_outFile;
   TTree* m_outTree;
@@ -56,6 +66,9 @@ private:
   float m_pxBeam;
   float m_pyBeam;
   float m_pzBeam;
+
+  // fills the tree on a separate thread if asynchronous writing is enabled
+  AsyncWriteQueue* m_queue;
 };
 
 #endif
@@ -0,0 +1,75 @@
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+#include "AMPTOOLS_DATAIO/ROOTWriterSettings.h"
+
+using namespace std;
+
+ROOTWriterSettings
+ROOTWriterSettings::fromEnvironment(){
+
+  ROOTWriterSettings settings;
+
+  const char* compression = getenv( "AMPTOOLS_ROOT_COMPRESSION" );
+  if( compression != NULL && string( compression ) != "" ){
+
+    string value( compression );
+    size_t colon = value.find( ':' );
+
+    if( value.find_first_not_of( "0123456789" ) == string::npos ){
+
+      settings.setCompression( atoi( value.c_str() ) );
+    }
+    else if( colon == string::npos ){
+
+      settings.setCompression( value, 4 );
+    }
+    else{
+
+      settings.setCompression( value.substr( 0, colon ),
+                               atoi( value.substr( colon + 1 ).c_str() ) );
+    }
+  }
+
+  const char* basketSize = getenv( "AMPTOOLS_ROOT_BASKET_SIZE" );
+  if( basketSize != NULL ) settings.setBasketSize( atoi( basketSize ) );
+
+  const char* async = getenv( "AMPTOOLS_ROOT_ASYNC_WRITE" );
+  if( async != NULL ) settings.setAsync( string( async ) == "1" );
+
+  return settings;
+}
+
+void
+ROOTWriterSettings::setCompression( const string& algorithm, int level ){
+
+  // ROOT's algorithm numbers, see ROOT::RCompressionSetting::EAlgorithm
+  int number = 0;
+  if( algorithm == "zlib" ) number = 1;
+  else if( algorithm == "lzma" ) number = 2;
+  else if( algorithm == "lz4" ) number = 4;
+  else if( algorithm == "zstd" ) number = 5;
+  else{
+
+    cout << "ROOTWriterSettings ERROR:  unknown compression algorithm "
+         << algorithm << endl;
+    assert( false );
+  }
+
+  assert( level >= 0 && level <= 9 );
+  m_compression = 100 * number + level;
+}
+
+void
+ROOTWriterSettings::applyToFile( TFile* file ) const {
+
+  if( m_compression != kFileDefault ) file->SetCompressionSettings( m_compression );
+}
+
+void
+ROOTWriterSettings::applyToTree( TTree* tree ) const {
+
+  if( m_basketSize > 0 ) tree->SetBasketSize( "*", m_basketSize );
+}
@@ -0,0 +1,60 @@
+#if !defined(ROOTWRITERSETTINGS)
+#define ROOTWRITERSETTINGS
+
+#include "TTree.h"
+#include "TFile.h"
+
+#include <string>
+
+using namespace std;
+
+/**
+ * Output settings shared by ROOTDataWriter and FSRootDataWriter.
+ *
+ * By default the settings are taken from the environment, so every
+ * generator that writes through these classes can be tuned without
+ * changes to its command line:
+ *
+ *   AMPTOOLS_ROOT_COMPRESSION   algorithm and level, e.g. "lz4:4", "zstd:5",
+ *                               "zlib:1", "lzma:9", or the numeric ROOT
+ *                               setting 100 * algorithm + level
+ *   AMPTOOLS_ROOT_BASKET_SIZE   basket size in bytes of every branch
+ *   AMPTOOLS_ROOT_ASYNC_WRITE   "1" fills and compresses the tree on a
+ *                               separate thread, see AsyncWriteQueue
+ */
+
+class ROOTWriterSettings
+{
+
+public:
+
+  enum { kFileDefault = -1 };
+
+  ROOTWriterSettings() :
+    m_compression( kFileDefault ), m_basketSize( 0 ), m_async( false ) { }
+
+  static ROOTWriterSettings fromEnvironment();
+
+  int compression() const { return m_compression; }
+  int basketSize() const { return m_basketSize; }
+  bool async() const { return m_async; }
+
+  void setCompression( int setting ) { m_compression = setting; }
+  void setCompression( const string& algorithm, int level );
+  void setBasketSize( int bytes ) { m_basketSize = bytes; }
+  void setAsync( bool async ) { m_async = async; }
+
+  // must be called before the tree is created
+  void applyToFile( TFile* file ) const;
+
+  // must be called after all branches are created
+  void applyToTree( TTree* tree ) const;
+
+private:
+
+  int m_compression;
+  int m_basketSize;
+  bool m_async;
+};
+
+#endif
@@ -7,7 +7,8 @@
 #include "IUAmpTools/Kinematics.h"
 
 ThreePiPlotGenerator::ThreePiPlotGenerator( const FitResults& results ) :
-PlotGenerator( results )
+PlotGenerator( results ),
+m_projections( kNumHists )
 {
   // calls to bookHistogram go here
   
@@ -24,7 +25,16 @@ PlotGenerator( results )
 
 void
 ThreePiPlotGenerator::projectEvent( Kinematics* kin ){
-  
+
+  // the projections only depend on the event, so later passes with
+  // other amplitude sets reuse them
+  const double* cached = m_projections.find( kin );
+  if( cached != NULL ){
+
+    for( int i = 0; i < kNumHists; ++i ) fillHistogram( i, cached[i] );
+    return;
+  }
+
   TLorentzVector beam   = kin->particle( 0 );
   TLorentzVector recoil = kin->particle( 1 );
   TLorentzVector piP1 = kin->particle( 2 );
@@ -54,15 +64,17 @@ ThreePiPlotGenerator::projectEvent( Kinematics* kin ){
   GDouble phiRes = anglesRes.Phi();
 
   
-  // calls to fillHistogram go here
-  
-  fillHistogram( k3PiMass, ( piM + piP1 + piP2 ).M() );
-  
-  fillHistogram( kPiMPiP1Mass,  ( piM + piP1 ).M() );
-  fillHistogram( kPiMPiP2Mass,  ( piM + piP2 ).M() );
-  fillHistogram( kPiP1PiP2Mass, ( piP1+ piP2 ).M() );
+  double values[kNumHists];
+  values[k3PiMass] = ( piM + piP1 + piP2 ).M();
+  values[kPiMPiP1Mass] = ( piM + piP1 ).M();
+  values[kPiMPiP2Mass] = ( piM + piP2 ).M();
+  values[kPiP1PiP2Mass] = ( piP1+ piP2 ).M();
+  values[kAlpha] = alpha;
+  values[kCosThetaRes] = cosThetaRes;
+  values[kPhiRes] = phiRes;
 
-  fillHistogram( kAlpha, alpha );
-  fillHistogram( kCosThetaRes, cosThetaRes );
-  fillHistogram( kPhiRes, phiRes );
+  m_projections.insert( values );
+
+  // calls to fillHistogram go here
+  for( int i = 0; i < kNumHists; ++i ) fillHistogram( i, values[i] );
 }
@@ -5,6 +5,7 @@
 #include <string>
 
 #include "IUAmpTools/PlotGenerator.h"
+#include "AMPTOOLS_DATAIO/PlotProjectionCache.h"
 
 using namespace std;
 
@@ -25,7 +26,8 @@ public:
 private:
         
   void projectEvent( Kinematics* kin );
-  
+
+  PlotProjectionCache m_projections;
 };
 
 #endif
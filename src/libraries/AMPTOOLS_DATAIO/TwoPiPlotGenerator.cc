@@ -8,13 +8,15 @@
 #include "IUAmpTools/Kinematics.h"
 
 TwoPiPlotGenerator::TwoPiPlotGenerator( const FitResults& results ) :
-PlotGenerator( results )
+PlotGenerator( results ),
+m_projections( kNumHists )
 {
 	createHistograms();
 }
 
 TwoPiPlotGenerator::TwoPiPlotGenerator( ) :
-PlotGenerator( )
+PlotGenerator( ),
+m_projections( kNumHists )
 {
 	createHistograms();
 }
@@ -35,7 +37,16 @@ void TwoPiPlotGenerator::createHistograms() {
 
 void
 TwoPiPlotGenerator::projectEvent( Kinematics* kin ){
-  
+
+  // the projections only depend on the event, so later passes with
+  // other amplitude sets reuse them
+  const double* cached = m_projections.find( kin );
+  if( cached != NULL ){
+
+    for( int i = 0; i < kNumHists; ++i ) fillHistogram( i, cached[i] );
+    return;
+  }
+
   TLorentzVector beam   = kin->particle( 0 );
   TLorentzVector recoil = kin->particle( 1 );
   TLorentzVector p1 = kin->particle( 2 );
@@ -71,17 +82,18 @@ TwoPiPlotGenerator::projectEvent( Kinematics* kin ){
   // compute invariant t
   GDouble t = - 2* recoil.M() * (recoil.E()-recoil.M());
 
-  // calls to fillHistogram go here
-  
-  fillHistogram( k2PiMass, ( resonance ).M() );
-  
-  fillHistogram( kPiPCosTheta, cosTheta );
+  double values[kNumHists];
+  values[k2PiMass] = ( resonance ).M();
+  values[kPiPCosTheta] = cosTheta;
+  values[kPhiPiPlus] = p1.Phi();
+  values[kPhiPiMinus] = p2.Phi();
+  values[kPhi] = Phi;
+  values[kphi] = phi;
+  values[kPsi] = psi;
+  values[kt] = -t;      // fill with -t to make positive
 
-  fillHistogram( kPhiPiPlus,  p1.Phi() );
-  fillHistogram( kPhiPiMinus, p2.Phi() );
-  fillHistogram( kPhi, Phi );
-  fillHistogram( kphi, phi );
+  m_projections.insert( values );
 
-  fillHistogram( kPsi, psi );
-  fillHistogram( kt, -t );      // fill with -t to make positive
+  // calls to fillHistogram go here
+  for( int i = 0; i < kNumHists; ++i ) fillHistogram( i, values[i] );
 }
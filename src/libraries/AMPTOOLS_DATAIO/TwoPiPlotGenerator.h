@@ -5,6 +5,7 @@
 #include <string>
 
 #include "IUAmpTools/PlotGenerator.h"
+#include "AMPTOOLS_DATAIO/PlotProjectionCache.h"
 
 using namespace std;
 
@@ -27,7 +28,8 @@ public:
 private:
         
   void createHistograms();
-  
+
+  PlotProjectionCache m_projections;
 };
 
 #endif
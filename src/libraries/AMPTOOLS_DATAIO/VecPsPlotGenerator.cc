@@ -9,14 +9,20 @@
 
 /* Constructor to display FitResults */
 VecPsPlotGenerator::VecPsPlotGenerator( const FitResults& results, Option opt ) :
-PlotGenerator( results, opt )
+PlotGenerator( results, opt ),
+m_reactionSelected( false ),
+m_vecDecay3pi( true ),
+m_projections( kNumHists )
 {
 	createHistograms();
 }
 
 /* Constructor for event generator (no FitResult) */
 VecPsPlotGenerator::VecPsPlotGenerator( ) :
-PlotGenerator( )
+PlotGenerator( ),
+m_reactionSelected( false ),
+m_vecDecay3pi( true ),
+m_projections( kNumHists )
 {
 	createHistograms();
 }
@@ -46,21 +52,56 @@ VecPsPlotGenerator::projectEvent( Kinematics* kin ){
   projectEvent( kin, "" );
 }
 
+void
+VecPsPlotGenerator::selectReaction( const string& reactionName ){
+
+   m_reaction = reactionName;
+   m_reactionSelected = true;
+
+   // check config file for 3pi dalitz parameters -- we assume here that the first amplitude in the list is a Vec_ps_refl amplitude
+   int nargs  = cfgInfo()->amplitudeList( reactionName, "", "" ).at(0)->factors().at(0).size();
+
+   // vector decays to 3pi by default (omega)
+   m_vecDecay3pi = ( nargs != 11 );
+}
+
 void
 VecPsPlotGenerator::projectEvent( Kinematics* kin, const string& reactionName ){
 
+   // the projections only depend on the event, so later passes with
+   // other amplitude sets reuse them
+   const double* cached = m_projections.find( kin, reactionName );
+   if( cached != NULL ){
+
+      for( int i = 0; i < kNumHists; ++i ) fillHistogram( i, cached[i] );
+      return;
+   }
+
+   // the name may be empty (see above), so a name equal to the initial
+   // m_reaction does not mean the reaction has been selected
+   if( !m_reactionSelected || m_reaction != reactionName )
+      selectReaction( reactionName );
+
+   double values[kNumHists];
+   projectValues( kin, values );
+
+   m_projections.insert( values );
+
+   //cout << "calls to fillHistogram go here" << endl;
+   for( int i = 0; i < kNumHists; ++i ) fillHistogram( i, values[i] );
+}
+
+void
+VecPsPlotGenerator::projectValues( Kinematics* kin, double* values ) const {
+
    //cout << "project event" << endl;
    TLorentzVector beam   = kin->particle( 0 );
    TLorentzVector recoil = kin->particle( 1 );
    TLorentzVector bach = kin->particle( 2 );
 
-   bool m_3pi = true;  // vector decays to 3pi by default (omega)
+   bool m_3pi = m_vecDecay3pi;
    int min_recoil = 6; // min particle index for recoil sum
 
-   // check config file for 3pi dalitz parameters -- we assume here that the first amplitude in the list is a Vec_ps_refl amplitude
-   int nargs  = cfgInfo()->amplitudeList( reactionName, "", "" ).at(0)->factors().at(0).size();
-   if(nargs == 11) m_3pi = false;
-
    TLorentzVector vec, vec_daught1, vec_daught2; // compute for each final state below 
 
    if(m_3pi==1) {
@@ -116,22 +157,14 @@ VecPsPlotGenerator::projectEvent( Kinematics* kin, const string& reactionName ){
    double Mandt = fabs((target-recoil).M2());
    double recoil_mass = recoil.M();  
 
-   GDouble cosTheta = TMath::Cos(locthetaphi[0]);
-   GDouble Phi = locthetaphi[1];
-   GDouble cosThetaH = TMath::Cos(locthetaphih[0]);
-   GDouble PhiH = locthetaphih[1];
-   GDouble prod_angle = locthetaphi[2];
-
-   //cout << "calls to fillHistogram go here" << endl;
-   fillHistogram( kVecPsMass, X.M() );
-   fillHistogram( kCosTheta, cosTheta );
-   fillHistogram( kPhi, Phi );
-   fillHistogram( kCosThetaH, cosThetaH );
-   fillHistogram( kPhiH, PhiH );
-   fillHistogram( kProd_Ang, prod_angle );
-   fillHistogram( kt, Mandt );
-   fillHistogram( kRecoilMass, recoil_mass );
-   fillHistogram( kProtonPsMass, proton_ps.M() );
-   fillHistogram( kRecoilPsMass, recoil_ps.M() );
-
+   values[kVecPsMass] = X.M();
+   values[kCosTheta] = TMath::Cos(locthetaphi[0]);
+   values[kPhi] = locthetaphi[1];
+   values[kCosThetaH] = TMath::Cos(locthetaphih[0]);
+   values[kPhiH] = locthetaphih[1];
+   values[kProd_Ang] = locthetaphi[2];
+   values[kt] = Mandt;
+   values[kRecoilMass] = recoil_mass;
+   values[kProtonPsMass] = proton_ps.M();
+   values[kRecoilPsMass] = recoil_ps.M();
 }
@@ -5,6 +5,7 @@
 #include <string>
 
 #include "IUAmpTools/PlotGenerator.h"
+#include "AMPTOOLS_DATAIO/PlotProjectionCache.h"
 
 using namespace std;
 
@@ -22,6 +23,15 @@ public:
   VecPsPlotGenerator( const FitResults& results, Option opt);
   VecPsPlotGenerator( const FitResults& results );
   VecPsPlotGenerator( );
+
+  // selects the reaction of the events given to projectValues, this must
+  // be done before the values are computed from several threads
+  void selectReaction( const string& reactionName );
+
+  // the values of all histograms for one event of the selected reaction;
+  // unlike projectEvent this can be called from several threads, e.g. by
+  // PlotSubsetEngine
+  void projectValues( Kinematics* kin, double* values ) const;
  
 private:
   
@@ -29,6 +39,13 @@ private:
   void projectEvent( Kinematics* kin, const string& reactionName );
 
   void createHistograms( );
+
+  // the selected reaction, the vector decays to three pions in it
+  string m_reaction;
+  bool m_reactionSelected;
+  bool m_vecDecay3pi;
+
+  PlotProjectionCache m_projections;
  
 };
 
@@ -7,6 +7,8 @@
 #include <cassert>
 #include <cstdlib>
 #include <unistd.h>
+#include <thread>
+#include <atomic>
 
 #include "IUAmpTools/FitResults.h"
 
@@ -36,6 +38,7 @@ int main( int argc, char* argv[] ){
     // set default parameters
     
     string outfileName("");
+    unsigned int nThreads = thread::hardware_concurrency();
     
     // parse command line
     
@@ -47,9 +50,14 @@ int main( int argc, char* argv[] ){
             if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
             else  outfileName = argv[++i]; }
         
+        if (arg == "-n"){
+            if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+            else  nThreads = atoi(argv[++i]); }
+        
         if (arg == "-h"){
             cout << endl << " Usage for: " << argv[0] << endl << endl;
             cout << "\t -o <file>\t Ouput text file" << endl;
+            cout << "\t -n <int>\t Number of threads (default: number of cores)" << endl;
             exit(1);}
         
         
@@ -110,87 +118,80 @@ int main( int argc, char* argv[] ){
    // print out the bin center                                                                     
     double step = ( highMass - lowMass ) / kNumBins;
     double stept = ( hight - lowt ) / kNumBinst;
-    ofstream outfile[kNumBins][kNumBinst];
-    // descend into the directory that contains the bins
-    chdir( fitDir.c_str() );
 
- 
-     for (int j=0; j<kNumBins; j++) {
-    for( int k = 0; k < kNumBinst; k++ ){
-  
-        ostringstream dir;
-        dir << "bin_" << j<<"_"<<k;
-        chdir( dir.str().c_str() );
-        cout<<"Getting results from bin "<<j<<"_"<<k<<endl;
+    // the coefficients of the moments are computed once and shared by
+    // the threads, each of which handles whole bins
+    momentProjector projector(ws, 1, LMAX);
+
+    if (nThreads < 1) nThreads = 1;
+
+    atomic<int> nextBin(0);
+
+    auto projectBins = [&](){
+      int bin;
+      while( ( bin = nextBin++ ) < kNumBins*kNumBinst ){
+
+        int j = bin / kNumBinst;
+        int k = bin % kNumBinst;
 
-        //ofstream outfile;
-        //cout<<"File opening..."<<endl;
-        outfile[j][k].open( outfileName.c_str(),std::ofstream::out | std::ofstream::trunc );
+        ostringstream dir;
+        dir << fitDir << "bin_" << j<<"_"<<k << "/";
 
+        ostringstream outfile;
 
-	outfile[j][k] <<"M"<<"\t"<<"t"; //First line contains names of variables, first two colomns correspond to M(invariant mass) and t
+	outfile <<"M"<<"\t"<<"t"; //First line contains names of variables, first two colomns correspond to M(invariant mass) and t
 
-	for (int L = 0; L<= pow(LMAX,1); L++) {// the rest of the colomn correspond to moments
+	for (int L = 0; L<= int(LMAX); L++) {// the rest of the colomn correspond to moments
 	  for (int M = 0; M<= L; M++) {
     
-	    outfile[j][k]<<"\t"<<"H0_"<<L<<M<<"\t"<<"H0_"<<L<<M<<"uncert.";
-	    outfile[j][k]<<"\t"<<"H1_"<<L<<M<<"\t"<<"H1_"<<L<<M<<"uncert.";
+	    outfile<<"\t"<<"H0_"<<L<<M<<"\t"<<"H0_"<<L<<M<<"uncert.";
+	    outfile<<"\t"<<"H1_"<<L<<M<<"\t"<<"H1_"<<L<<M<<"uncert.";
 	  }}
-	outfile[j][k]<<endl;
-
-
+	outfile<<endl;
 
-        //cout<<"Opened file"<<endl;
         for( int i = 0; i < kNumBins_Bootstrap; i++ ){
-            cout<<"Results from bootstrap "<<i<<endl;
-            
-            ostringstream resultsFile;
-	    resultsFile.str("");
-            //cout<<"Created resultsFile"<<endl;
-	    resultsFile << "bin_bs_" << i << ".fit";
-            //cout<<"Naming results file"<<endl;
-	                                                                                                                                                                                                  
-	    FitResults results( resultsFile.str().c_str() );
-            //cout<<"Named results file"<<endl;
 
-	    // print out the bin center                                                                                                                                                                                       
-	    outfile[j][k] << lowMass + step * j + step / 2. << "\t";
-	    outfile[j][k] << lowt + stept * k + stept / 2. << "\t";
+            ostringstream resultsFile;
+	    resultsFile << dir.str() << "bin_bs_" << i << ".fit";
 
-	    if( !results.valid() ){
+	    FitResults results( resultsFile.str().c_str() );
 
-	      for (int L = 0; L<= pow(LMAX,1); L++) {// calculating moments and writing to a file
-		for (int M = 0; M<= L; M++) {
-     
-		  outfile[j][k] << 0<< "\t"<< 0 <<"\t";
-		  outfile[j][k] << 0<< "\t"<< 0 <<"\t";
-		}}
-	      outfile[j][k] << endl;
-     
-	      continue;
-	    }
+	    // print out the bin center
+	    outfile << lowMass + step * j + step / 2. << "\t";
+	    outfile << lowt + stept * k + stept / 2. << "\t";
 
+	    vector<double> x;
+	    if( results.valid() ) x = results.parValueList();
 
+	    for (int L = 0; L<= int(LMAX); L++) {// calculating moments and writing to a file
+	      for (int M = 0; M<= L; M++) {
 
- for (int L = 0; L<= pow(LMAX,1); L++) {// calculating moments and writing to a file
-    for (int M = 0; M<= L; M++) {
-     
-      outfile[j][k] << real(decomposeMoment(0, L, M, ws, results.parValueList()))<< "\t"<< 0 <<"\t";
-      outfile[j][k] << real(decomposeMoment(1, L, M, ws, results.parValueList()))<< "\t"<< 0 <<"\t";
-      // if(L==0 && M==0 && i==44 && j==3)cout <<" H0_00=  "<< real(decomposeMoment(0, L, M, ws, results.parValueList()))<<" H1_00=  "<< real(decomposeMoment(1, L, M, ws, results.parValueList()))<<" H2_00=  "<< decomposeMoment(2, L, M, ws, results.parValueList())<<endl;
+		if( x.empty() ){
+		  outfile << 0<< "\t"<< 0 <<"\t";
+		  outfile << 0<< "\t"<< 0 <<"\t";
+		  continue;
+		}
 
-        }}
+		outfile << real(projector.moment(0, L, M, x))<< "\t"<< 0 <<"\t";
+		outfile << real(projector.moment(1, L, M, x))<< "\t"<< 0 <<"\t";
+	      }}
 
-	outfile[j][k]<<endl;
+	    outfile<<endl;
 	}
 
+        ofstream out( ( dir.str() + outfileName ).c_str(), std::ofstream::out | std::ofstream::trunc );
+        out << outfile.str();
+        out.close();
+      }
+    };
 
-	outfile[j][k].close();
-        //cout<<"end fit bin "<<j<<endl;
-        chdir( ".." );
+    vector<thread> threads;
+    for (unsigned int t = 0; t < nThreads; t++) threads.push_back(thread(projectBins));
+    for (unsigned int t = 0; t < threads.size(); t++) threads[t].join();
 
-    }
-    }
+    for (int j=0; j<kNumBins; j++)
+      for( int k = 0; k < kNumBinst; k++ )
+        cout<<"Wrote results of bin "<<j<<"_"<<k<<endl;
     
     return 0;
 }
@@ -29,5 +29,30 @@ std::complex<double> decomposeMoment(int alpha,double L, double M, const waveset
 std::complex<double> decomposeMoment(int alpha ,double L, double M, const waveset& ws, const vector<double>& x);
 
 
+// The coefficients of the moments H_alpha(L,M), alpha <= maxAlpha,
+// L <= maxL and 0 <= M <= L, of a waveset are computed once.  Each moment
+// of a fit result is then a sum of coeff * x1 * conj(x2) over the coupled
+// wave pairs, with the same result as decomposeMoment.
+class momentProjector {
+ public:
+  momentProjector(const waveset& ws, int maxAlpha, size_t maxL);
+
+  std::complex<double> moment(int alpha, int L, int M, const double* x) const;
+  std::complex<double> moment(int alpha, int L, int M, const vector<double>& x) const { return moment(alpha, L, M, &x[0]); }
+
+ private:
+  struct term {
+    size_t idx1, idx2;
+    std::complex<double> coeff;
+  };
+
+  size_t index(int alpha, int L, int M) const { return (alpha*(m_maxL+1) + L)*(m_maxL+1) + M; }
+
+  int m_maxAlpha;
+  size_t m_maxL;
+  std::vector< std::vector<term> > m_terms;
+};
+
+
 #endif /* MOMENT_H */
 
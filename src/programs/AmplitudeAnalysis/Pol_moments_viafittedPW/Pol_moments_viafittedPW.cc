@@ -10,6 +10,8 @@
 #include <complex>
 #include <string>
 #include <time.h>
+#include <thread>
+#include <atomic>
 
 #include "IUAmpTools/FitResults.h"
 #include "TFile.h"
@@ -38,9 +40,17 @@ using namespace std;
 
 
 
-std::complex<double> pw_refl(string fitresFile, int L, int hel[3]);
-std::complex<double> sdme_refl(int alp, int L1, int L2, int M1, int M2, string fitFile);
-std::complex<double> Moments_refl(int alp, int L, int M, string file_fit);
+// partial waves of one bin, indexed by reflectivity (0 for -1, 1 for +1),
+// L, m + LMAX and k
+struct PartialWaves {
+  std::complex<double> pw[2][LMAX+1][2*LMAX+1][2];
+};
+
+std::complex<double> pw_refl(const FitResults& fitres, int L, int hel[3]);
+void load_pw_refl(string fitresFile, PartialWaves& waves);
+std::complex<double> pw_lookup(const PartialWaves& waves, int L, int hel[3]);
+std::complex<double> sdme_refl(int alp, int L1, int L2, int M1, int M2, const PartialWaves& waves);
+std::complex<double> Moments_refl(int alp, int L, int M, const PartialWaves& waves);
 double clebsch(double j1, double j2, double j3, double m1, double m2);
 
 
@@ -64,6 +74,7 @@ int main( int argc, char* argv[] ){
     // set default parameters
     
     string outfileName("");
+    unsigned int nThreads = thread::hardware_concurrency();
     
     // parse command line
     
@@ -74,9 +85,13 @@ int main( int argc, char* argv[] ){
         if (arg == "-o"){
             if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
             else  outfileName = argv[++i]; }
+        if (arg == "-n"){
+            if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+            else  nThreads = atoi( argv[++i] ); }
         if (arg == "-h"){
             cout << endl << " Usage for: " << argv[0] << endl << endl;
             cout << "\t -o <file>\t Ouput text file" << endl;
+            cout << "\t -n <int>\t Number of threads (default: number of cores)" << endl;
             exit(1);}
     }
     
@@ -85,10 +100,7 @@ int main( int argc, char* argv[] ){
         exit(1);
     }
     
-
-
- 
-
+    if (nThreads < 1) nThreads = 1;
 
   double step = ( highMass - lowMass ) / kNumBins;
     double stept = ( hight - lowt ) / kNumBinst;
@@ -106,41 +118,54 @@ int main( int argc, char* argv[] ){
       }}
     outfile<<endl;
 
+    // the fit results of every M_eta_pi and t bin are read once into
+    // PartialWaves, the bins are shared between the threads and the
+    // moments are written out in the original order afterwards
+    vector< vector<double> > moments( kNumBins * kNumBinst );
+    atomic<int> nextBin( 0 );
+
+    auto computeBins = [&](){
+      int bin;
+      while( ( bin = nextBin++ ) < kNumBins * kNumBinst ){
+
+        int i = bin / kNumBinst;
+        int j = bin % kNumBinst;
 
+        ostringstream resultsFile;
+        resultsFile << fitDir << "/bin_" << i << "_" << j << "/bin_" << i << "_" << j << ".fit";
 
-    // descend into the directory that contains the bins
-    chdir( fitDir.c_str() );
+        PartialWaves waves;
+        load_pw_refl( resultsFile.str(), waves );
 
+        for (int L = 0; L<= pow(LMAX,2); L++) {// calculating moments
+        for (int M = 0; M<= L; M++) {
+
+          moments[bin].push_back( real(Moments_refl(0, L, M, waves)) );
+          moments[bin].push_back( real(Moments_refl(1, L, M, waves)) );
+        }}
+      }
+    };
 
+    vector< thread > threads;
+    for( unsigned int t = 0; t < nThreads; t++ ) threads.push_back( thread( computeBins ) );
+    for( unsigned int t = 0; t < threads.size(); t++ ) threads[t].join();
 
     //Looping through M_eta_pi and t bins
     for( int i = 0; i < kNumBins;i++ ){
       for( int j = 0; j < kNumBinst; j++ ){  
 	cout<<"bin "<<i<<"_"<<j<<endl;
-        
-        ostringstream dir;
-        dir << "bin_" << i<<"_"<<j;
-        chdir( dir.str().c_str() );
-        
-        string resultsFile;
-        resultsFile ="bin_" + std::to_string(i)+"_"+ std::to_string(j)+".fit";
 
-        
         // print out the bin center
         outfile << lowMass + step * i + step / 2. << "\t";
 	outfile << lowt + stept * j + stept / 2. << "\t";
 
-  
-    for (int L = 0; L<= pow(LMAX,2); L++) {// calculating moments and writing to a file
-    for (int M = 0; M<= L; M++) {
-     
-      outfile << real(Moments_refl(0, L, M, resultsFile))<< "\t"<< 0 <<"\t";
-      outfile << real(Moments_refl(1, L, M, resultsFile))<< "\t"<< 0 <<"\t";
-      // if(L==0 && M==0 && i==44 && j==3)cout <<" H0_00=  "<< real(Moments_refl(0, L, M, resultsFile))<<" H1_00=  "<< real(Moments_refl(1, L, M, resultsFile))<<endl;
-        }}
+        // writing moments to a file
+        const vector<double>& binMoments = moments[i*kNumBinst + j];
+        for( size_t n = 0; n < binMoments.size(); n++ ){
+
+          outfile << binMoments[n] << "\t" << 0 << "\t";
+        }
         outfile << endl;
-        
-        chdir( ".." );
     }
     }
 
@@ -160,10 +185,10 @@ int main( int argc, char* argv[] ){
 
 
 
-std::complex<double> pw_refl(string fitresFile, int L, int hel[3]){
+std::complex<double> pw_refl(const FitResults& fitres, int L, int hel[3]){
   /* returns partial waves for g p --> (eta pi)_L p
   * partial waves are in the reflectivity basis
-  * fitresFile is the name of the fit output file for given m_eta_pi and t bin
+  * fitres are the fit results for given m_eta_pi and t bin
   * hel = {epsilon, m, k}
   * epsilon is the relfectivity
   * k = 0,1 is the nucleon non-flip (0) or flip (1)
@@ -175,9 +200,6 @@ std::complex<double> pw_refl(string fitresFile, int L, int hel[3]){
   int eps = hel[0], m = hel[1], k = hel[2];
 
 
-FitResults fitres(fitresFile);
-
- if( !fitres.valid() )return zero;
  // eps = +/- 1 ; k = 0,1 ; |m|<= L
   if( abs(eps)!=1 || abs(2*k-1)!=1 || abs(m)>L) {
     return zero;
@@ -230,8 +252,43 @@ FitResults fitres(fitresFile);
 
 
 
-std::complex<double> sdme_refl(int alp, int L1, int L2, int M1, int M2, string fitFile){ // code formula (D8) from 10.1103/PhysRevD.100.054017 //alp corresponds to H0 or H1
-  // fitresFile contains fit results in given {t,m_etapi} bin
+void load_pw_refl(string fitresFile, PartialWaves& waves){
+  /* reads the fit output file for given m_eta_pi and t bin once and
+  * stores all partial waves from pw_refl, zero if the fit is not valid
+  */
+
+  FitResults fitres(fitresFile);
+
+  int hel[3];
+  for (int e = 0; e < 2; e++) {
+  for (int L = 0; L <= LMAX; L++) {
+  for (int m = -LMAX; m <= LMAX; m++) {
+  for (int k = 0; k < 2; k++) {
+    hel[0] = 2*e-1; hel[1] = m; hel[2] = k;
+    waves.pw[e][L][m+LMAX][k] = fitres.valid() ? pw_refl(fitres, L, hel) : 0.0;
+  }}}}
+}
+
+
+
+std::complex<double> pw_lookup(const PartialWaves& waves, int L, int hel[3]){
+  // same as pw_refl, from the stored partial waves
+  int eps = hel[0], m = hel[1], k = hel[2];
+
+  if( abs(eps)!=1 || (k!=0 && k!=1) || L<0 || L>LMAX || abs(m)>L) {
+    return 0.0;
+  }
+
+  return waves.pw[(eps+1)/2][L][m+LMAX][k];
+}
+
+
+
+
+
+
+std::complex<double> sdme_refl(int alp, int L1, int L2, int M1, int M2, const PartialWaves& waves){ // code formula (D8) from 10.1103/PhysRevD.100.054017 //alp corresponds to H0 or H1
+  // waves contains the partial waves in given {t,m_etapi} bin
   std::complex<double> rho (0.0,0.0), ui (0.0, 1.0);
   std::complex<double> pw1 (0.0,0.0), pw2 (0.0,0.0);
   int hel1[3], hel2[3]; // hel = [eps, m , k]
@@ -247,14 +304,14 @@ std::complex<double> sdme_refl(int alp, int L1, int L2, int M1, int M2, string f
       case 0:
         fac = 1.0;
         hel1[1] = M1; hel2[1] = M2;
-        pw1 = pw_refl(fitFile, L1, hel1); //  fitresFile contains fitresults for given bin in { t_{pp}, m_{eta pi}}, L , hel = {epsilon, m proj. of L, k}
-        pw2 = pw_refl(fitFile, L2, hel2);
+        pw1 = pw_lookup(waves, L1, hel1); //  waves contains the partial waves for given bin in { t_{pp}, m_{eta pi}}, L , hel = {epsilon, m proj. of L, k}
+        pw2 = pw_lookup(waves, L2, hel2);
         rho += fac * pw1 * conj(pw2);
         
         fac = pow(-1.,M1-M2);
         hel1[1] = -M1; hel2[1] = -M2;
-        pw1 = pw_refl(fitFile, L1, hel1);
-        pw2 = pw_refl(fitFile, L2, hel2);
+        pw1 = pw_lookup(waves, L1, hel1);
+        pw2 = pw_lookup(waves, L2, hel2);
         rho += fac * pw1 * conj(pw2);
        
         break;
@@ -263,14 +320,14 @@ std::complex<double> sdme_refl(int alp, int L1, int L2, int M1, int M2, string f
         fac = -(double)e*pow(-1.,M1);
         
         hel1[1] = -M1; hel2[1] = M2;
-        pw1 = pw_refl(fitFile, L1, hel1);
-        pw2 = pw_refl(fitFile, L2, hel2);
+        pw1 = pw_lookup(waves, L1, hel1);
+        pw2 = pw_lookup(waves, L2, hel2);
         rho += fac * pw1 * conj(pw2);
         
         fac = -(double)e*pow(-1.,M2);
         hel1[1] = M1; hel2[1] = -M2;
-        pw1 = pw_refl(fitFile, L1, hel1);
-        pw2 = pw_refl(fitFile, L2, hel2);
+        pw1 = pw_lookup(waves, L1, hel1);
+        pw2 = pw_lookup(waves, L2, hel2);
         rho += fac * pw1 * conj(pw2);
         break;
         
@@ -278,14 +335,14 @@ std::complex<double> sdme_refl(int alp, int L1, int L2, int M1, int M2, string f
         fac = -ui*(double)e*pow(-1.,M1);
         
         hel1[1] = -M1; hel2[1] = M2;
-        pw1 = pw_refl(fitFile, L1, hel1);
-        pw2 = pw_refl(fitFile, L2, hel2);
+        pw1 = pw_lookup(waves, L1, hel1);
+        pw2 = pw_lookup(waves, L2, hel2);
         rho += fac * pw1 * conj(pw2);
         
         fac = +ui*(double)e*pow(-1.,M2);
         hel1[1] = M1; hel2[1] = -M2;
-        pw1 = pw_refl(fitFile, L1, hel1);
-        pw2 = pw_refl(fitFile, L2, hel2);
+        pw1 = pw_lookup(waves, L1, hel1);
+        pw2 = pw_lookup(waves, L2, hel2);
         rho += fac * pw1 * conj(pw2);
         break;
         
@@ -293,14 +350,14 @@ std::complex<double> sdme_refl(int alp, int L1, int L2, int M1, int M2, string f
         fac = 1.0;
         
         hel1[1] = M1; hel2[1] = M2;
-        pw1 = pw_refl(fitFile, L1, hel1);
-        pw2 = pw_refl(fitFile, L2, hel2);
+        pw1 = pw_lookup(waves, L1, hel1);
+        pw2 = pw_lookup(waves, L2, hel2);
         rho += fac * pw1 * conj(pw2);
         
         fac = -pow(-1.,M1-M2);
         hel1[1] = -M1; hel2[1] = -M2;
-        pw1 = pw_refl(fitFile, L1, hel1);
-        pw2 = pw_refl(fitFile, L2, hel2);
+        pw1 = pw_lookup(waves, L1, hel1);
+        pw2 = pw_lookup(waves, L2, hel2);
         rho += fac * pw1 * conj(pw2);
         break;
         
@@ -316,7 +373,7 @@ std::complex<double> sdme_refl(int alp, int L1, int L2, int M1, int M2, string f
 
 
 
-std::complex<double> Moments_refl(int alp, int L, int M, string file_fit){ //H0 or H1 , L, M, fitresults file for given t and  invariant mass bin 
+std::complex<double> Moments_refl(int alp, int L, int M, const PartialWaves& waves){ //H0 or H1 , L, M, partial waves for given t and  invariant mass bin 
   // WARNING: the sum extends to max(l1,l2) = LMAX 
   std::complex<double> mom = 0.0;
   std::complex<double> rho = 0.0;
@@ -330,7 +387,7 @@ std::complex<double> Moments_refl(int alp, int L, int M, string file_fit){ //H0
       for (int m2 = -l2; m2 <= l2; m2 +=1 ) {
         cg1 = clebsch(l2,L,l1,0,0);   // m1,m2 and M are =0
         cg2 = clebsch(l2,L,l1,m2,M);  // 6th argument m1=M+m2
-        rho = sdme_refl(alp, l1, l2, m2+M,m2, file_fit);
+        rho = sdme_refl(alp, l1, l2, m2+M,m2, waves);
         mom += fac*sqrt( (2.0*l2+1)/(2.0*l1+1) )*cg1*cg2*rho;
 	
       }}}
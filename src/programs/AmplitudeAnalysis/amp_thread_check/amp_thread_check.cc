@@ -0,0 +1,478 @@
+// amp_thread_check: evaluates every amplitude of an AmpTools configuration
+// file on a fixed set of synthetic phase space events, first in a single
+// thread and then concurrently from many threads, and compares the
+// results.  Amplitudes that give different results when called from
+// several threads at once are not safe for multi-threaded likelihood
+// evaluation.  Parameters are taken from the "parameter" lines of the
+// configuration file; no data files are read.
+//
+// The amplitudes with block-vectorized CPU kernels (BreitWigner, Vec_ps_refl
+// and Zlm) are then evaluated once more through calcAmplitudeAll, with the
+// kernel and with the per-event calcAmplitude path that AMPTOOLS_CPU_KERNELS=0
+// selects.  The two agree if every value differs by at most kKernelTolerance
+// times the largest magnitude of that amplitude factor.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <complex>
+#include <cmath>
+#include <cstdlib>
+#include <cassert>
+#include <thread>
+
+#include "particleType.h"
+
+#include "TLorentzVector.h"
+#include "TGenPhaseSpace.h"
+#include "TRandom3.h"
+
+#include "AMPTOOLS_AMPS/BreitWigner.h"
+#include "AMPTOOLS_AMPS/BreitWigner3body.h"
+#include "AMPTOOLS_AMPS/Compton.h"
+#include "AMPTOOLS_AMPS/DblRegge_FastEta.h"
+#include "AMPTOOLS_AMPS/DblRegge_FastPi.h"
+#include "AMPTOOLS_AMPS/EtaPb_tdist.h"
+#include "AMPTOOLS_AMPS/Flatte.h"
+#include "AMPTOOLS_AMPS/Hist2D.h"
+#include "AMPTOOLS_AMPS/Lambda1520Angles.h"
+#include "AMPTOOLS_AMPS/Lambda1520tdist.h"
+#include "AMPTOOLS_AMPS/PhaseOffset.h"
+#include "AMPTOOLS_AMPS/Pi0Regge.h"
+#include "AMPTOOLS_AMPS/Pi0SAID.h"
+#include "AMPTOOLS_AMPS/PiPlusRegge.h"
+#include "AMPTOOLS_AMPS/Piecewise.h"
+#include "AMPTOOLS_AMPS/ThreePiAngles.h"
+#include "AMPTOOLS_AMPS/ThreePiAnglesSchilling.h"
+#include "AMPTOOLS_AMPS/TwoLeptonAngles.h"
+#include "AMPTOOLS_AMPS/TwoLeptonAnglesGJ.h"
+#include "AMPTOOLS_AMPS/TwoPSAngles.h"
+#include "AMPTOOLS_AMPS/TwoPSHelicity.h"
+#include "AMPTOOLS_AMPS/TwoPiAngles.h"
+#include "AMPTOOLS_AMPS/TwoPiAngles_amp.h"
+#include "AMPTOOLS_AMPS/TwoPiAngles_primakoff.h"
+#include "AMPTOOLS_AMPS/TwoPiEtas_tdist.h"
+#include "AMPTOOLS_AMPS/TwoPiNC_tdist.h"
+#include "AMPTOOLS_AMPS/TwoPiW_brokenetas.h"
+#include "AMPTOOLS_AMPS/TwoPiWt_primakoff.h"
+#include "AMPTOOLS_AMPS/TwoPiWt_sigma.h"
+#include "AMPTOOLS_AMPS/TwoPitdist.h"
+#include "AMPTOOLS_AMPS/Uniform.h"
+#include "AMPTOOLS_AMPS/VecRadiative_SDME.h"
+#include "AMPTOOLS_AMPS/Vec_ps_refl.h"
+#include "AMPTOOLS_AMPS/Ylm.h"
+#include "AMPTOOLS_AMPS/Zlm.h"
+#include "AMPTOOLS_AMPS/b1piAngAmp.h"
+#include "AMPTOOLS_AMPS/omegapi_amplitude.h"
+#include "AMPTOOLS_AMPS/polCoef.h"
+
+#include "IUAmpTools/Kinematics.h"
+#include "IUAmpTools/Amplitude.h"
+#include "IUAmpTools/ConfigFileParser.h"
+#include "IUAmpTools/ConfigurationInfo.h"
+
+#include "AMPTOOLS_AMPS/cpuKernel.h"
+
+using std::complex;
+using namespace std;
+
+static map< string, Amplitude* > gAmpPrototypes;
+
+// the kernels only reorder the arithmetic, so they agree to rounding
+static const double kKernelTolerance = ( sizeof( GDouble ) == sizeof( double ) ? 1e-9 : 1e-4 );
+
+static void registerAmplitude( const Amplitude& amp ){
+
+	gAmpPrototypes[amp.name()] = amp.clone();
+}
+
+// one amplitude factor of the configuration file together with the
+// events and permutations it has to be evaluated for
+struct AmpCheck {
+
+	string ampName;
+	string className;
+	Amplitude* amp;
+	const vector< Kinematics* >* events;
+	vector< vector< int > > permutations;
+};
+
+static void evaluate( const AmpCheck& check, unsigned int firstEvent,
+		      vector< complex< GDouble > >& result ){
+
+	// start at a different event in each thread so that the threads
+	// work on different events at the same time
+	const vector< Kinematics* >& events = *check.events;
+	unsigned int nPerm = check.permutations.size();
+	result.resize( events.size() * nPerm );
+
+	for( unsigned int i = 0; i < events.size(); ++i ){
+
+		unsigned int iEvent = ( firstEvent + i ) % events.size();
+		for( unsigned int iPerm = 0; iPerm < nPerm; ++iPerm ){
+
+			result[iEvent*nPerm+iPerm] =
+				check.amp->calcAmplitude( events[iEvent], check.permutations[iPerm] );
+		}
+	}
+}
+
+static void evaluateAll( const vector< AmpCheck >* checks, unsigned int firstEvent,
+			 vector< vector< complex< GDouble > > >* results ){
+
+	results->resize( checks->size() );
+	for( unsigned int i = 0; i < checks->size(); ++i )
+		evaluate( (*checks)[i], firstEvent, (*results)[i] );
+}
+
+// calcAmplitudeAll on the AmpTools data layout, through the CPU kernel or
+// through the per-event path of the Amplitude base class
+static void evaluateBlock( const AmpCheck& check, bool kernel,
+			   vector< complex< GDouble > >& result ){
+
+	const vector< Kinematics* >& events = *check.events;
+	int nEvents = events.size();
+	int nPerm = check.permutations.size();
+	int nParticles = check.permutations[0].size();
+
+	// E, px, py, pz of every particle, event by event
+	vector< GDouble > data( 4 * nParticles * nEvents );
+	for( int iEvent = 0; iEvent < nEvents; ++iEvent ){
+
+		for( int iParticle = 0; iParticle < nParticles; ++iParticle ){
+
+			TLorentzVector p4 = events[iEvent]->particle( iParticle );
+			GDouble* p = &(data[4 * ( nParticles * iEvent + iParticle )]);
+			p[0] = p4.E();
+			p[1] = p4.Px();
+			p[2] = p4.Py();
+			p[3] = p4.Pz();
+		}
+	}
+
+	vector< GDouble > userVars( nEvents * nPerm * check.amp->numUserVars() );
+	GDouble* pdUserVars = ( userVars.empty() ? NULL : &(userVars[0]) );
+	if( pdUserVars != NULL )
+		check.amp->calcUserVarsAll( &(data[0]), pdUserVars, nEvents, &check.permutations );
+
+	vector< GDouble > amps( 2 * nEvents * nPerm );
+	if( kernel )
+		check.amp->calcAmplitudeAll( &(data[0]), &(amps[0]), nEvents,
+					     &check.permutations, pdUserVars );
+	else
+		check.amp->Amplitude::calcAmplitudeAll( &(data[0]), &(amps[0]), nEvents,
+							&check.permutations, pdUserVars );
+
+	result.resize( nEvents * nPerm );
+	for( unsigned int i = 0; i < result.size(); ++i )
+		result[i] = complex< GDouble >( amps[2*i], amps[2*i+1] );
+}
+
+static bool sameValue( GDouble a, GDouble b ){
+
+	if( std::isnan( a ) && std::isnan( b ) ) return true;
+	return a == b;
+}
+
+int main( int argc, char* argv[] ){
+
+	string configfile("");
+
+	int nEvents = 1000;
+	unsigned int nThreads = thread::hardware_concurrency();
+	unsigned int seed = 1;
+
+	double beamLowE  = 3.0;
+	double beamHighE = 12.0;
+
+	//parse command line:
+	for (int i = 1; i < argc; i++){
+
+		string arg(argv[i]);
+
+		if (arg == "-c"){
+			if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+			else  configfile = argv[++i]; }
+		if (arg == "-n"){
+			if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+			else  nEvents = atoi( argv[++i] ); }
+		if (arg == "-t"){
+			if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+			else  nThreads = atoi( argv[++i] ); }
+		if (arg == "-s"){
+			if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+			else  seed = atoi( argv[++i] ); }
+		if (arg == "-a"){
+			if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+			else  beamLowE = atof( argv[++i] ); }
+		if (arg == "-b"){
+			if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+			else  beamHighE = atof( argv[++i] ); }
+		if (arg == "-h"){
+			cout << endl << " Usage for: " << argv[0] << endl << endl;
+			cout << "\t -c    <file>\t Config file" << endl;
+			cout << "\t -n    <value>\t Number of synthetic events per reaction [optional]" << endl;
+			cout << "\t -t    <value>\t Number of concurrent threads [optional]" << endl;
+			cout << "\t -s    <value>\t Random number seed initialization [optional]" << endl;
+			cout << "\t -a    <value>\t Minimum photon energy [optional]" << endl;
+			cout << "\t -b    <value>\t Maximum photon energy [optional]" << endl << endl;
+			exit(1);
+		}
+	}
+
+	if( configfile.size() == 0 ){
+		cout << "No config file specified:  run amp_thread_check -h for help" << endl;
+		exit(1);
+	}
+	if( nThreads < 2 ) nThreads = 2;
+
+	registerAmplitude( BreitWigner() );
+	registerAmplitude( BreitWigner3body() );
+	registerAmplitude( Compton() );
+	registerAmplitude( DblRegge_FastEta() );
+	registerAmplitude( DblRegge_FastPi() );
+	registerAmplitude( EtaPb_tdist() );
+	registerAmplitude( Flatte() );
+	registerAmplitude( Hist2D() );
+	registerAmplitude( Lambda1520Angles() );
+	registerAmplitude( Lambda1520tdist() );
+	registerAmplitude( PhaseOffset() );
+	registerAmplitude( Pi0Regge() );
+	registerAmplitude( Pi0SAID() );
+	registerAmplitude( PiPlusRegge() );
+	registerAmplitude( Piecewise() );
+	registerAmplitude( ThreePiAngles() );
+	registerAmplitude( ThreePiAnglesSchilling() );
+	registerAmplitude( TwoLeptonAngles() );
+	registerAmplitude( TwoLeptonAnglesGJ() );
+	registerAmplitude( TwoPSAngles() );
+	registerAmplitude( TwoPSHelicity() );
+	registerAmplitude( TwoPiAngles() );
+	registerAmplitude( TwoPiAngles_amp() );
+	registerAmplitude( TwoPiAngles_primakoff() );
+	registerAmplitude( TwoPiEtas_tdist() );
+	registerAmplitude( TwoPiNC_tdist() );
+	registerAmplitude( TwoPiW_brokenetas() );
+	registerAmplitude( TwoPiWt_primakoff() );
+	registerAmplitude( TwoPiWt_sigma() );
+	registerAmplitude( TwoPitdist() );
+	registerAmplitude( Uniform() );
+	registerAmplitude( VecRadiative_SDME() );
+	registerAmplitude( Vec_ps_refl() );
+	registerAmplitude( Ylm() );
+	registerAmplitude( Zlm() );
+	registerAmplitude( b1piAngAmp() );
+	registerAmplitude( omegapi_amplitude() );
+	registerAmplitude( polCoef() );
+
+	ConfigFileParser parser( configfile );
+	ConfigurationInfo* cfgInfo = parser.getConfigurationInfo();
+
+	TRandom3 random( seed );
+	gRandom->SetSeed( seed ); // used by TGenPhaseSpace
+
+	// synthetic events: beam photon along z on a proton target, the
+	// final state distributed according to phase space
+	map< string, vector< Kinematics* > > events;
+	vector< ReactionInfo* > reactions = cfgInfo->reactionList();
+	for( unsigned int iReac = 0; iReac < reactions.size(); ++iReac ){
+
+		vector< string > particles = reactions[iReac]->particleList();
+		if( particles.size() < 3 ){
+
+			cout << "Reaction " << reactions[iReac]->reactionName()
+			     << " needs at least two final state particles" << endl;
+			exit(1);
+		}
+
+		vector< double > masses;
+		double threshold = 0;
+		for( unsigned int i = 1; i < particles.size(); ++i ){
+
+			masses.push_back( ParticleMass( ParticleEnum( particles[i].c_str() ) ) );
+			threshold += masses.back();
+		}
+
+		TLorentzVector target( 0, 0, 0, ParticleMass( Proton ) );
+		vector< Kinematics* >& reacEvents = events[reactions[iReac]->reactionName()];
+
+		while( reacEvents.size() < (unsigned int)nEvents ){
+
+			double beamE = random.Uniform( beamLowE, beamHighE );
+			TLorentzVector beam( 0, 0, beamE, beamE );
+			TLorentzVector W = beam + target;
+			if( W.M() <= threshold ) continue;
+
+			TGenPhaseSpace phaseSpace;
+			phaseSpace.SetDecay( W, masses.size(), &(masses[0]) );
+			phaseSpace.Generate();
+
+			vector< TLorentzVector > p4;
+			p4.push_back( beam );
+			for( unsigned int i = 0; i < masses.size(); ++i )
+				p4.push_back( *phaseSpace.GetDecay( i ) );
+
+			reacEvents.push_back( new Kinematics( p4, 1.0 ) );
+		}
+	}
+
+	// one amplitude object per factor, exactly as in a fit
+	vector< AmpCheck > checks;
+	vector< AmplitudeInfo* > amps = cfgInfo->amplitudeList();
+	vector< ParameterInfo* > pars = cfgInfo->parameterList();
+	for( unsigned int iAmp = 0; iAmp < amps.size(); ++iAmp ){
+
+		vector< vector< string > > factors = amps[iAmp]->factors();
+		for( unsigned int iFac = 0; iFac < factors.size(); ++iFac ){
+
+			string className = factors[iFac][0];
+			if( gAmpPrototypes.find( className ) == gAmpPrototypes.end() ){
+
+				cout << "WARNING:  amplitude " << className
+				     << " is not known to amp_thread_check, skipping it" << endl;
+				continue;
+			}
+
+			vector< string > args( factors[iFac].begin() + 1, factors[iFac].end() );
+
+			AmpCheck check;
+			check.ampName = amps[iAmp]->fullName() + " " + className;
+			check.className = className;
+			check.amp = gAmpPrototypes[className]->newAmplitude( args );
+			for( unsigned int iPar = 0; iPar < pars.size(); ++iPar )
+				check.amp->setParValue( pars[iPar]->parName(), pars[iPar]->value() );
+			check.events = &(events[amps[iAmp]->reactionName()]);
+
+			// identity permutation first, then those of the config file
+			vector< int > identity;
+			unsigned int nParticles = cfgInfo->reaction( amps[iAmp]->reactionName() )->particleList().size();
+			for( unsigned int i = 0; i < nParticles; ++i ) identity.push_back( i );
+			check.permutations.push_back( identity );
+			vector< vector< int > > perms = amps[iAmp]->permutations();
+			check.permutations.insert( check.permutations.end(), perms.begin(), perms.end() );
+
+			checks.push_back( check );
+		}
+	}
+
+	cout << "Checking " << checks.size() << " amplitude factors with "
+	     << nEvents << " events and " << nThreads << " threads" << endl;
+
+	// reference values from a single thread
+	vector< vector< complex< GDouble > > > reference;
+	evaluateAll( &checks, 0, &reference );
+
+	// all threads evaluate all amplitudes at the same time
+	vector< vector< vector< complex< GDouble > > > > results( nThreads );
+	vector< thread > threads;
+	for( unsigned int iThread = 0; iThread < nThreads; ++iThread ){
+
+		unsigned int firstEvent = ( iThread * nEvents ) / nThreads;
+		threads.push_back( thread( evaluateAll, &checks, firstEvent, &(results[iThread]) ) );
+	}
+	for( unsigned int iThread = 0; iThread < nThreads; ++iThread )
+		threads[iThread].join();
+
+	int nFailed = 0;
+	for( unsigned int i = 0; i < checks.size(); ++i ){
+
+		int nMismatch = 0;
+		for( unsigned int iThread = 0; iThread < nThreads; ++iThread ){
+
+			const vector< complex< GDouble > >& values = results[iThread][i];
+			for( unsigned int j = 0; j < values.size(); ++j ){
+
+				if( !sameValue( real( values[j] ), real( reference[i][j] ) ) ||
+				    !sameValue( imag( values[j] ), imag( reference[i][j] ) ) ) ++nMismatch;
+			}
+		}
+
+		if( nMismatch == 0 ){
+
+			cout << "  OK              " << checks[i].ampName << endl;
+		}
+		else{
+
+			cout << "  NOT THREAD SAFE " << checks[i].ampName << " ("
+			     << nMismatch << " differing values)" << endl;
+			++nFailed;
+		}
+	}
+
+	if( nFailed > 0 ){
+
+		cout << nFailed << " of " << checks.size()
+		     << " amplitude factors are not thread safe" << endl;
+	}
+	else{
+
+		cout << "All amplitude factors give identical results in all threads" << endl;
+	}
+
+	// the CPU kernels against the per-event path they replace
+	int nKernelFailed = 0;
+	if( !cpuKernelsEnabled() ){
+
+		cout << "AMPTOOLS_CPU_KERNELS=0, the CPU kernels are not checked" << endl;
+	}
+	else{
+
+		cout << "Comparing the CPU kernels to calcAmplitude, relative tolerance "
+		     << kKernelTolerance << endl;
+	}
+
+	for( unsigned int i = 0; i < checks.size() && cpuKernelsEnabled(); ++i ){
+
+		const string& className = checks[i].className;
+		if( className != "BreitWigner" && className != "Vec_ps_refl" && className != "Zlm" )
+			continue;
+
+		vector< complex< GDouble > > kernel, perEvent;
+		evaluateBlock( checks[i], true, kernel );
+		evaluateBlock( checks[i], false, perEvent );
+
+		double scale = 0;
+		for( unsigned int j = 0; j < perEvent.size(); ++j )
+			if( std::isfinite( abs( perEvent[j] ) ) ) scale = max( scale, (double)abs( perEvent[j] ) );
+
+		int nMismatch = 0;
+		double maxDiff = 0;
+		for( unsigned int j = 0; j < perEvent.size(); ++j ){
+
+			if( sameValue( real( kernel[j] ), real( perEvent[j] ) ) &&
+			    sameValue( imag( kernel[j] ), imag( perEvent[j] ) ) ) continue;
+
+			double diff = abs( kernel[j] - perEvent[j] );
+			if( !( diff <= kKernelTolerance * scale ) ) ++nMismatch;
+			if( scale > 0 ) maxDiff = max( maxDiff, diff / scale );
+		}
+
+		if( nMismatch == 0 ){
+
+			cout << "  OK              " << checks[i].ampName
+			     << " (largest relative difference " << maxDiff << ")" << endl;
+		}
+		else{
+
+			cout << "  KERNEL MISMATCH " << checks[i].ampName << " ("
+			     << nMismatch << " differing values)" << endl;
+			++nKernelFailed;
+		}
+	}
+
+	if( nKernelFailed > 0 ){
+
+		cout << nKernelFailed << " amplitude factors differ between the CPU kernel "
+		     << "and calcAmplitude" << endl;
+	}
+
+	for( map< string, vector< Kinematics* > >::iterator reac = events.begin();
+	     reac != events.end(); ++reac ){
+
+		for( unsigned int i = 0; i < reac->second.size(); ++i )
+			delete reac->second[i];
+	}
+
+	return ( nFailed > 0 || nKernelFailed > 0 ? 1 : 0 );
+}
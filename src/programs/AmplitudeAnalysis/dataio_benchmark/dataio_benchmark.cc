@@ -0,0 +1,389 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+#include "AMPTOOLS_DATAIO/ROOTDataReader.h"
+#include "AMPTOOLS_DATAIO/ROOTDataReaderBootstrap.h"
+#include "AMPTOOLS_DATAIO/ROOTDataReaderTEM.h"
+#include "AMPTOOLS_DATAIO/ROOTDataReaderWithTCut.h"
+#include "AMPTOOLS_DATAIO/ROOTChainDataReader.h"
+#include "AMPTOOLS_DATAIO/FSRootDataReader.h"
+#include "AMPTOOLS_DATAIO/ROOTDataWriter.h"
+#include "AMPTOOLS_DATAIO/FSRootDataWriter.h"
+#include "AMPTOOLS_DATAIO/ASCIIDataWriter.h"
+
+#include "IUAmpTools/Kinematics.h"
+
+#include "TLorentzVector.h"
+#include "TRandom3.h"
+
+using namespace std;
+
+void Usage()
+{
+  cout << "Usage:\n  dataio_benchmark [OPTIONS]\n\n";
+  cout << "  Writes synthetic events with every AMPTOOLS_DATAIO writer and reads them\n";
+  cout << "  back with every reader.  For each it prints the events per second, the\n";
+  cout << "  file size divided by the time in MB/s and the peak resident memory.\n";
+  cout << "  No input files are needed.\n\n";
+  cout << "  Options: \n";
+  cout << "   -n [nEvents]    : Number of events to write (default 1000000)\n";
+  cout << "   -p [nParticles] : Number of final state particles including the recoil (default 3)\n";
+  cout << "   -w              : Give the events weights other than one\n";
+  cout << "   -r [nPasses]    : Number of passes through the data for every reader (default 1)\n";
+  cout << "   -d [directory]  : Directory for the temporary files (default .)\n";
+  cout << "   -s [seed]       : Random number seed (default 1)\n";
+  cout << "   -k              : Keep the generated files\n";
+  cout << "   -c              : Leave AMPTOOLS_KIN_CACHE set, so the readers may use\n";
+  cout << "                     their kinematics cache (unset by default)\n";
+  exit(1);
+}
+
+
+/**
+ * A fixed pool of random events that the writers cycle through.  The events
+ * are generated before any timing starts, so only the I/O is measured.  The
+ * pool is larger than a basket, so the repetition does not help compression.
+ *
+ * The first particle is a beam photon along z, the second a recoil proton
+ * and the others are pions.
+ */
+
+class EventPool {
+
+public:
+
+  enum { kPoolSize = 50000 };
+
+  EventPool( unsigned int nParticles, bool weighted, int seed ){
+
+    TRandom3 random( seed );
+
+    for( unsigned int i = 0; i < kPoolSize; ++i ){
+
+      vector< TLorentzVector > particles( nParticles + 1 );
+
+      double eBeam = random.Uniform( 8.2, 9.0 );
+      particles[0].SetXYZT( 0, 0, eBeam, eBeam );
+
+      particles[1].SetXYZM( random.Gaus( 0, 0.3 ), random.Gaus( 0, 0.3 ),
+                            random.Uniform( 0.1, 1.0 ), 0.938272046 );
+
+      for( unsigned int j = 2; j <= nParticles; ++j ){
+
+        particles[j].SetXYZM( random.Gaus( 0, 0.4 ), random.Gaus( 0, 0.4 ),
+                              random.Uniform( 0.5, 4.0 ), 0.13957018 );
+      }
+
+      // similar to sideband subtracted data
+      double weight = weighted ? random.Uniform( -0.5, 1.5 ) : 1;
+
+      m_events.push_back( new Kinematics( particles, weight ) );
+    }
+  }
+
+  ~EventPool(){
+
+    for( unsigned int i = 0; i < m_events.size(); ++i ) delete m_events[i];
+  }
+
+  const Kinematics& event( unsigned long i ) const { return *m_events[i % m_events.size()]; }
+
+private:
+
+  vector< Kinematics* > m_events;
+};
+
+
+struct Result {
+
+  string name;
+  unsigned long events;
+  double seconds;
+  double megabytes;
+  double peakMB;
+};
+
+// peak resident memory is reset before every measurement where the
+// kernel allows it, otherwise the numbers are the peak of the process
+
+void resetPeakMemory(){
+
+  ofstream clearRefs( "/proc/self/clear_refs" );
+  if( clearRefs.good() ) clearRefs << "5";
+}
+
+double peakMemoryMB(){
+
+  ifstream status( "/proc/self/status" );
+  string line;
+  while( getline( status, line ) ){
+
+    if( line.compare( 0, 6, "VmHWM:" ) == 0 ){
+
+      istringstream value( line.substr( 6 ) );
+      double kB = 0;
+      value >> kB;
+      return kB / 1024;
+    }
+  }
+
+  struct rusage usage;
+  getrusage( RUSAGE_SELF, &usage );
+
+#ifdef __APPLE__
+  return usage.ru_maxrss / ( 1024. * 1024. );
+#else
+  return usage.ru_maxrss / 1024.;
+#endif
+}
+
+double fileSizeMB( const string& fileName ){
+
+  struct stat info;
+  if( stat( fileName.c_str(), &info ) != 0 ) return 0;
+
+  return info.st_size / ( 1024. * 1024. );
+}
+
+double secondsSince( const chrono::steady_clock::time_point& start ){
+
+  return chrono::duration< double >( chrono::steady_clock::now() - start ).count();
+}
+
+
+// the writers are timed including the destructor, which writes the
+// last baskets and closes the file
+
+Result benchROOTWriter( const EventPool& pool, unsigned long nEvents,
+                        bool weighted, const string& fileName ){
+
+  resetPeakMemory();
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  ROOTDataWriter* writer = new ROOTDataWriter( fileName, "kin", true, weighted );
+  for( unsigned long i = 0; i < nEvents; ++i ) writer->writeEvent( pool.event( i ) );
+  delete writer;
+
+  Result result = { "ROOTDataWriter", nEvents, secondsSince( start ),
+                    fileSizeMB( fileName ), peakMemoryMB() };
+  return result;
+}
+
+Result benchFSRootWriter( const EventPool& pool, unsigned long nEvents,
+                          unsigned int nParticles, const string& fileName ){
+
+  resetPeakMemory();
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  FSRootDataWriter* writer = new FSRootDataWriter( nParticles, fileName );
+  for( unsigned long i = 0; i < nEvents; ++i ) writer->writeEvent( pool.event( i ) );
+  delete writer;
+
+  Result result = { "FSRootDataWriter", nEvents, secondsSince( start ),
+                    fileSizeMB( fileName ), peakMemoryMB() };
+  return result;
+}
+
+Result benchASCIIWriter( const EventPool& pool, unsigned long nEvents,
+                         unsigned int nParticles, const string& fileName ){
+
+  // geant types:  beam photon, proton and alternating charged pions
+  vector< int > types( nParticles + 1, 8 );
+  types[0] = 1;
+  types[1] = 14;
+  for( unsigned int i = 3; i <= nParticles; i += 2 ) types[i] = 9;
+
+  resetPeakMemory();
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  ASCIIDataWriter* writer = new ASCIIDataWriter( fileName );
+  for( unsigned long i = 0; i < nEvents; ++i ) writer->writeEvent( pool.event( i ), types );
+  delete writer;
+
+  Result result = { "ASCIIDataWriter", nEvents, secondsSince( start ),
+                    fileSizeMB( fileName ), peakMemoryMB() };
+  return result;
+}
+
+// the readers are timed including the constructor, since several of
+// them scan the whole tree there
+
+template< class Reader >
+Result benchReader( const string& name, const vector< string >& args,
+                    const string& fileName, int nPasses ){
+
+  resetPeakMemory();
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  Reader* reader = new Reader( args );
+
+  unsigned long nEvents = 0;
+  for( int pass = 0; pass < nPasses; ++pass ){
+
+    if( pass > 0 ) reader->resetSource();
+
+    Kinematics* event;
+    while( ( event = reader->getEvent() ) != NULL ){
+
+      ++nEvents;
+      delete event;
+    }
+  }
+
+  delete reader;
+
+  Result result = { name, nEvents, secondsSince( start ),
+                    nPasses * fileSizeMB( fileName ), peakMemoryMB() };
+  return result;
+}
+
+void printResult( const Result& result ){
+
+  printf( "%-26s %12lu %10.2f %14.0f %10.1f %12.1f\n",
+          result.name.c_str(), result.events, result.seconds,
+          result.seconds > 0 ? result.events / result.seconds : 0,
+          result.seconds > 0 ? result.megabytes / result.seconds : 0,
+          result.peakMB );
+  fflush( stdout );
+}
+
+
+int main( int argc, char* argv[] ){
+
+  unsigned long nEvents = 1000000;
+  unsigned int nParticles = 3;
+  bool weighted = false;
+  int nPasses = 1;
+  string directory = ".";
+  int seed = 1;
+  bool keepFiles = false;
+  bool useCache = false;
+
+  for( int i = 1; i < argc; ++i ){
+    string arg=argv[i];
+    if (arg == "-n"){
+      if ((i+1 == argc) || (argv[i+1][0] == '-')) Usage();
+      else nEvents = strtoul( argv[++i], NULL, 10 );
+    }else if (arg == "-p"){
+      if ((i+1 == argc) || (argv[i+1][0] == '-')) Usage();
+      else nParticles = atoi( argv[++i] );
+    }else if (arg == "-r"){
+      if ((i+1 == argc) || (argv[i+1][0] == '-')) Usage();
+      else nPasses = atoi( argv[++i] );
+    }else if (arg == "-d"){
+      if ((i+1 == argc) || (argv[i+1][0] == '-')) Usage();
+      else directory = argv[++i];
+    }else if (arg == "-s"){
+      if ((i+1 == argc) || (argv[i+1][0] == '-')) Usage();
+      else seed = atoi( argv[++i] );
+    }else if (arg == "-w") weighted = true;
+    else if (arg == "-k") keepFiles = true;
+    else if (arg == "-c") useCache = true;
+    else Usage();
+  }
+
+  // the FSRoot format needs at least two final state particles
+  if( nParticles < 2 || nParticles + 1 > Kinematics::kMaxParticles ) Usage();
+  if( nEvents < 1 || nPasses < 1 ) Usage();
+
+  if( !useCache ) unsetenv( "AMPTOOLS_KIN_CACHE" );
+
+  string ampToolsFile = directory + "/dataio_benchmark_amptools.root";
+  string fsRootFile = directory + "/dataio_benchmark_fsroot.root";
+  string asciiFile = directory + "/dataio_benchmark.ascii";
+
+  cout << "Generating a pool of " << EventPool::kPoolSize << " events with "
+       << nParticles << " final state particles" << ( weighted ? " and weights" : "" )
+       << endl;
+
+  EventPool pool( nParticles, weighted, seed );
+
+  cout << "Writing " << nEvents << " events and reading them " << nPasses
+       << ( nPasses == 1 ? " time" : " times" ) << endl << endl;
+
+  printf( "%-26s %12s %10s %14s %10s %12s\n",
+          "", "events", "seconds", "events/s", "MB/s", "peak RSS MB" );
+
+  printResult( benchROOTWriter( pool, nEvents, weighted, ampToolsFile ) );
+  printResult( benchFSRootWriter( pool, nEvents, nParticles, fsRootFile ) );
+  printResult( benchASCIIWriter( pool, nEvents, nParticles, asciiFile ) );
+
+  ostringstream nParticlesStr;
+  nParticlesStr << nParticles;
+
+  vector< string > args;
+
+  args.push_back( ampToolsFile );
+  args.push_back( "kin" );
+  printResult( benchReader< ROOTDataReader >( "ROOTDataReader", args,
+                                              ampToolsFile, nPasses ) );
+
+  // wide cuts, so the selection is timed but every event passes
+  args.clear();
+  args.push_back( ampToolsFile );
+  args.push_back( "0" ); args.push_back( "100" );
+  args.push_back( "kin" );
+  printResult( benchReader< ROOTDataReaderWithTCut >( "ROOTDataReaderWithTCut", args,
+                                                      ampToolsFile, nPasses ) );
+
+  args.clear();
+  args.push_back( ampToolsFile );
+  args.push_back( "0" ); args.push_back( "100" );
+  args.push_back( "0" ); args.push_back( "100" );
+  args.push_back( "0" ); args.push_back( "100" );
+  args.push_back( "kin" );
+  printResult( benchReader< ROOTDataReaderTEM >( "ROOTDataReaderTEM", args,
+                                                 ampToolsFile, nPasses ) );
+
+  ostringstream seedStr;
+  seedStr << seed;
+
+  args.clear();
+  args.push_back( ampToolsFile );
+  args.push_back( seedStr.str() );
+  args.push_back( "kin" );
+  printResult( benchReader< ROOTDataReaderBootstrap >( "ROOTDataReaderBootstrap", args,
+                                                       ampToolsFile, nPasses ) );
+
+  args.clear();
+  args.push_back( ampToolsFile );
+  args.push_back( "kin" );
+  printResult( benchReader< ROOTChainDataReader >( "ROOTChainDataReader", args,
+                                                   ampToolsFile, nPasses ) );
+
+  args.clear();
+  args.push_back( fsRootFile );
+  args.push_back( "nt" );
+  args.push_back( nParticlesStr.str() );
+  printResult( benchReader< FSRootDataReader >( "FSRootDataReader", args,
+                                                fsRootFile, nPasses ) );
+
+  // the weight branch of the same tree doubles as the friend tree
+  if( weighted ){
+
+    args.push_back( fsRootFile );
+    args.push_back( "nt" );
+    args.push_back( "weight" );
+    printResult( benchReader< FSRootDataReader >( "FSRootDataReader (friend)", args,
+                                                  fsRootFile, nPasses ) );
+  }
+
+  if( !keepFiles ){
+
+    remove( ampToolsFile.c_str() );
+    remove( fsRootFile.c_str() );
+    remove( asciiFile.c_str() );
+  }
+
+  return 0;
+}
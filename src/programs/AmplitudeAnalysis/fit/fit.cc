@@ -6,6 +6,26 @@
 #include <vector>
 #include <utility>
 #include <map>
+#include <deque>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <csignal>
+#include <iomanip>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "TSystem.h"
 
@@ -14,6 +34,9 @@
 #include "AMPTOOLS_DATAIO/ROOTDataReaderWithTCut.h"
 #include "AMPTOOLS_DATAIO/ROOTDataReaderTEM.h"
 #include "AMPTOOLS_DATAIO/FSRootDataReader.h"
+#include "AMPTOOLS_DATAIO/ROOTChainDataReader.h"
+#include "AMPTOOLS_DATAIO/NormIntCache.h"
+#include "AMPTOOLS_DATAIO/FileUtilities.h"
 #include "AMPTOOLS_AMPS/TwoPSAngles.h"
 #include "AMPTOOLS_AMPS/TwoPSHelicity.h"
 #include "AMPTOOLS_AMPS/TwoPiAngles.h"
@@ -42,6 +65,7 @@
 #include "AMPTOOLS_AMPS/Vec_ps_refl.h"
 #include "AMPTOOLS_AMPS/PhaseOffset.h"
 #include "AMPTOOLS_AMPS/Piecewise.h"
+#include "AMPTOOLS_AMPS/ampProfiler.h"
 
 #include "MinuitInterface/MinuitMinimizationManager.h"
 #include "IUAmpTools/AmpToolsInterface.h"
@@ -52,25 +76,38 @@
 using std::complex;
 using namespace std;
 
+// NULL unless the normalization integrals are cached, see NormIntCache
+NormIntCache* normIntCache = NULL;
+
+
 double runSingleFit(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIter, string seedfile) {
+  AmpProfileScope setup( ampProfileCounter("setup", "AmpToolsInterface") );
   AmpToolsInterface ati( cfgInfo );
+  setup.stop();
 
   cout << "LIKELIHOOD BEFORE MINIMIZATION:  " << ati.likelihood() << endl;
+  if( normIntCache ) normIntCache->store( ati );
 
   MinuitMinimizationManager* fitManager = ati.minuitMinimizationManager();
   fitManager->setMaxIterations(maxIter);
 
-  if( useMinos ){
+  {
+    AmpProfileScope profile( ampProfileCounter("minimization", useMinos ? "MINOS" : "MIGRAD") );
 
-    fitManager->minosMinimization();
-  }
-  else{
+    if( useMinos ){
 
-    fitManager->migradMinimization();
+      fitManager->minosMinimization();
+    }
+    else{
+
+      fitManager->migradMinimization();
+    }
   }
 
-  if( hesse )
+  if( hesse ){
+     AmpProfileScope profile( ampProfileCounter("minimization", "HESSE") );
      fitManager->hesseEvaluation();
+  }
 
   bool fitFailed =
     ( fitManager->status() != 0 || fitManager->eMatrixStatus() != 3 );
@@ -91,11 +128,25 @@ double runSingleFit(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int m
   return ati.likelihood();
 }
 
-void runRndFits(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIter, string seedfile, int numRnd, double maxFraction) {
+void promoteBestFit(const string& fitName, const string& seedfile, int minFitTag, double minLL, int numRnd) {
+  if(minFitTag < 0) cout << "ALL FITS FAILED!" << endl;
+  else {
+    cout << "MINIMUM LIKELIHOOD FROM " << minFitTag << " of " << numRnd << " RANDOM PRODUCTION PARS = " << minLL << endl;
+    if( !copyFile(Form("%s_%d.fit", fitName.data(), minFitTag), fitName + ".fit") )
+      cout << "ERROR: cannot copy " << fitName << "_" << minFitTag << ".fit" << endl;
+    if( seedfile.size() != 0 && !copyFile(seedfile + Form("_%d.txt", minFitTag), seedfile + ".txt") )
+      cout << "ERROR: cannot copy " << seedfile << "_" << minFitTag << ".txt" << endl;
+  }
+}
+
+void runRndFits(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIter, string seedfile, int numRnd, double maxFraction, unsigned int randomSeed) {
+  AmpProfileScope setup( ampProfileCounter("setup", "AmpToolsInterface") );
   AmpToolsInterface ati( cfgInfo );
+  setup.stop();
   string fitName = cfgInfo->fitName();
 
   cout << "LIKELIHOOD BEFORE MINIMIZATION:  " << ati.likelihood() << endl;
+  if( normIntCache ) normIntCache->store( ati );
 
   MinuitMinimizationManager* fitManager = ati.minuitMinimizationManager();
   fitManager->setMaxIterations(maxIter);
@@ -111,19 +162,29 @@ void runRndFits(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIt
     cout << "FIT " << i << " OF " << numRnd << endl;
     cout << endl << "###############################" << endl;
 
-    // randomize parameters
+    // every fit starts from the parameters of the configuration file,
+    // randomized with its own seed, so that it does not depend on how many
+    // fits are run at the same time
+    ati.reinitializePars();
+    AmpToolsInterface::setRandomSeed(randomSeed + i);
     ati.randomizeProductionPars(maxFraction);
     for(size_t ipar=0; ipar<parRangeKeywords.size(); ipar++) {
       ati.randomizeParameter(parRangeKeywords[ipar][0], atof(parRangeKeywords[ipar][1].c_str()), atof(parRangeKeywords[ipar][2].c_str()));
     }
 
-    if(useMinos)
-      fitManager->minosMinimization();
-    else
-      fitManager->migradMinimization();
+    {
+      AmpProfileScope profile( ampProfileCounter("minimization", useMinos ? "MINOS" : "MIGRAD") );
 
-    if(hesse)
+      if(useMinos)
+        fitManager->minosMinimization();
+      else
+        fitManager->migradMinimization();
+    }
+
+    if(hesse) {
+       AmpProfileScope profile( ampProfileCounter("minimization", "HESSE") );
        fitManager->hesseEvaluation();
+    }
 
     bool fitFailed = (fitManager->status() != 0 || fitManager->eMatrixStatus() != 3);
 
@@ -147,93 +208,828 @@ void runRndFits(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIt
   }
 
   // print best fit results
-  if(minFitTag < 0) cout << "ALL FITS FAILED!" << endl;
-  else {
-    cout << "MINIMUM LIKELIHOOD FROM " << minFitTag << " of " << numRnd << " RANDOM PRODUCTION PARS = " << minLL << endl;
-    gSystem->Exec(Form("cp %s_%d.fit %s.fit", fitName.data(), minFitTag, fitName.data()));
-    if( seedfile.size() != 0 )
-      gSystem->Exec(Form("cp %s_%d.txt %s.txt", seedfile.data(), minFitTag, seedfile.data()));
+  promoteBestFit(fitName, seedfile, minFitTag, minLL, numRnd);
+}
+
+// sends the output of a forked process to its own log file
+void redirectOutput(const string& logName) {
+  int logFd = open(logName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if( logFd >= 0 ) {
+    dup2(logFd, 1);
+    dup2(logFd, 2);
+    close(logFd);
   }
 }
 
-void runParScan(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIter, string seedfile, string parScan) {
-  double minVal=0, maxVal=0, stepSize=0;
-  int steps=0;
+struct RestartResult {
+  double likelihood;
+  int failed;
+};
+
+/**
+ * Runs the randomized fits in up to numProcs forked processes at a time.
+ * The data are read and the amplitudes computed once before forking, so
+ * every process has its own AmpToolsInterface over the same, shared pages
+ * in memory.  Every fit starts from the parameters of the configuration
+ * file, randomized with the seed randomSeed + i, and writes its output to
+ * <fitName>_i.log.  The results are therefore independent of numProcs.
+ */
+void runRndFitsParallel(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIter, string seedfile, int numRnd, double maxFraction, unsigned int randomSeed, int numProcs) {
+  AmpToolsInterface ati( cfgInfo );
+  string fitName = cfgInfo->fitName();
+
+  // this also fills the amplitude caches before they are shared
+  cout << "LIKELIHOOD BEFORE MINIMIZATION:  " << ati.likelihood() << endl;
+  if( normIntCache ) normIntCache->store( ati );
+
+  MinuitMinimizationManager* fitManager = ati.minuitMinimizationManager();
+  fitManager->setMaxIterations(maxIter);
+
+  vector< vector<string> > parRangeKeywords = cfgInfo->userKeywordArguments("parRange");
+
+  // keep track of best fit (mininum log-likelihood)
+  double minLL = 0;
+  int minFitTag = -1;
+
+  // process id -> fit number and the pipe the result is read from
+  map< pid_t, pair<int, int> > running;
+  int nextFit = 0;
+
+  while( nextFit < numRnd || !running.empty() ) {
+
+    if( nextFit < numRnd && (int)running.size() < numProcs ) {
+
+      int fd[2];
+      if( pipe(fd) != 0 ) {
+        perror("pipe");
+        assert( false );
+      }
+
+      cout << flush;
+      fflush(stdout);
+      fflush(stderr);
+
+      pid_t pid = fork();
+      assert( pid >= 0 );
+
+      if( pid == 0 ) {
+
+        close(fd[0]);
+
+        redirectOutput(fitName + Form("_%d.log", nextFit));
+
+        cout << "FIT " << nextFit << " OF " << numRnd << endl;
+
+        AmpToolsInterface::setRandomSeed(randomSeed + nextFit);
+        ati.randomizeProductionPars(maxFraction);
+        for(size_t ipar=0; ipar<parRangeKeywords.size(); ipar++) {
+          ati.randomizeParameter(parRangeKeywords[ipar][0], atof(parRangeKeywords[ipar][1].c_str()), atof(parRangeKeywords[ipar][2].c_str()));
+        }
+
+        if(useMinos)
+          fitManager->minosMinimization();
+        else
+          fitManager->migradMinimization();
+
+        if(hesse)
+          fitManager->hesseEvaluation();
+
+        RestartResult result;
+        result.failed = (fitManager->status() != 0 || fitManager->eMatrixStatus() != 3);
+        result.likelihood = ati.likelihood();
+
+        if( result.failed )
+          cout << "ERROR: fit failed use results with caution..." << endl;
+
+        cout << "LIKELIHOOD AFTER MINIMIZATION:  " << result.likelihood << endl;
+
+        ati.finalizeFit(to_string(nextFit));
+
+        if( seedfile.size() != 0 && !result.failed ){
+          string seedfile_rand = seedfile + Form("_%d.txt", nextFit);
+          ati.fitResults()->writeSeed( seedfile_rand );
+        }
+
+        cout << flush;
+        fflush(stdout);
+
+        bool written = ( write(fd[1], &result, sizeof(result)) == sizeof(result) );
+
+        // skip the destructors, the parent still owns the shared state
+        _exit( written ? 0 : 1 );
+      }
+
+      close(fd[1]);
+      running[pid] = make_pair(nextFit, fd[0]);
+
+      cout << "STARTED FIT " << nextFit << " OF " << numRnd << " IN PROCESS " << pid << endl;
+      ++nextFit;
+      continue;
+    }
+
+    int status;
+    pid_t pid = waitpid(-1, &status, 0);
+    if( pid < 0 ) {
+      if( errno == EINTR ) continue;
+      perror("waitpid");
+      break;
+    }
+
+    map< pid_t, pair<int, int> >::iterator proc = running.find(pid);
+    if( proc == running.end() ) continue;
+
+    int tag = proc->second.first;
+
+    // the result is written before the process exits
+    RestartResult result;
+    bool finished = ( read(proc->second.second, &result, sizeof(result)) == sizeof(result) ) &&
+                    WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+    close(proc->second.second);
+    running.erase(proc);
+
+    if( !finished ) {
+      cout << "ERROR: fit " << tag << " did not finish, see " << fitName << "_" << tag << ".log" << endl;
+      continue;
+    }
 
+    cout << "FIT " << tag << " OF " << numRnd << ( result.failed ? " FAILED" : "" )
+         << ", LIKELIHOOD AFTER MINIMIZATION:  " << result.likelihood << endl;
+
+    // update best fit, ties go to the lower fit number
+    if( !result.failed && ( result.likelihood < minLL ||
+                            ( result.likelihood == minLL && tag < minFitTag ) ) ) {
+      minLL = result.likelihood;
+      minFitTag = tag;
+    }
+  }
+
+  // print best fit results
+  promoteBestFit(fitName, seedfile, minFitTag, minLL, numRnd);
+}
+
+struct ScanAxis {
+  string parName;
+  double minVal;
+  double maxVal;
+  double stepSize;
+  int steps;
+  int start;
+};
+
+// a point of the scan, i and j are the steps along the two axes, or
+// minus the refinement level and the side for the refined points
+struct ScanResult {
+  int i;
+  int j;
+  double value[2];
+  double likelihood;
+  int failed;
+};
+
+// reads the parScan keyword of the parameter and finds the step closest
+// to its value in the configuration file, where the scan starts
+bool findScanAxis(ConfigurationInfo* cfgInfo, const string& parName, ScanAxis& axis) {
   vector< vector<string> > parScanKeywords = cfgInfo->userKeywordArguments("parScan");
 
-  if(parScanKeywords.size()==0) {
-    cout << "No parScan keyword found in configuration file. Set up at least one parameter for scanning! Aborting." << endl;
-    return;
-  } else {
-    for(size_t ipar=0; ipar<parScanKeywords.size(); ipar++) {
-      if(parScanKeywords[ipar][0]==parScan) {
-	minVal = atof(parScanKeywords[ipar][1].c_str());
-	maxVal = atof(parScanKeywords[ipar][2].c_str());
-	stepSize = atof(parScanKeywords[ipar][3].c_str());
-	steps = trunc((maxVal-minVal)/stepSize)+1;
-	break;
-      } else
-	cout << "Skipping configuration to scan " << parScanKeywords[ipar][0] << "since scanning of " << parScan << " was requested..." << endl;
+  size_t ipar = 0;
+  for( ; ipar<parScanKeywords.size(); ipar++) {
+    if(parScanKeywords[ipar][0]==parName) break;
+  }
+
+  if(ipar==parScanKeywords.size()) {
+    cout << "No parScan keyword found in configuration file for " << parName << ". Set up at least one parameter for scanning! Aborting." << endl;
+    return false;
+  }
+
+  axis.parName = parName;
+  axis.minVal = atof(parScanKeywords[ipar][1].c_str());
+  axis.maxVal = atof(parScanKeywords[ipar][2].c_str());
+  axis.stepSize = atof(parScanKeywords[ipar][3].c_str());
+  axis.steps = trunc((axis.maxVal-axis.minVal)/axis.stepSize)+1;
+
+  vector<ParameterInfo*> parInfoVec = cfgInfo->parameterList();
+
+  auto parItr = parInfoVec.begin();
+  for( ; parItr != parInfoVec.end(); ++parItr ) {
+    if( (**parItr).parName() == parName ) break;
+  }
+
+  if( parItr == parInfoVec.end() ){
+    cout << "ERROR:  request to scan nonexistent parameter:  " << parName << endl;
+    return false;
+  }
+
+  axis.start = (int)floor(((**parItr).value()-axis.minVal)/axis.stepSize + 0.5);
+  axis.start = max(0, min(axis.steps-1, axis.start));
+
+  return true;
+}
+
+string scanTag(const ScanResult& point, size_t numAxes) {
+  if(point.i < 0) return Form("refine_%d_%d", -point.i, point.j);
+  if(numAxes == 1) return to_string(point.i);
+  return Form("%d_%d", point.i, point.j);
+}
+
+ScanResult scanPoint(const vector<ScanAxis>& axes, int i, int j) {
+  ScanResult point;
+  point.i = i;
+  point.j = j;
+  point.value[0] = axes[0].minVal + i*axes[0].stepSize;
+  point.value[1] = axes.size() > 1 ? axes[1].minVal + j*axes[1].stepSize : 0;
+  point.likelihood = 0;
+  point.failed = 1;
+  return point;
+}
+
+// fits one point starting from the current parameters of ati
+ScanResult fitScanPoint(AmpToolsInterface& ati, const vector<ScanAxis>& axes, ScanResult point, bool useMinos, bool hesse, const string& seedfile) {
+  string tag = scanTag(point, axes.size());
+
+  cout << endl << "###############################" << endl;
+  cout << "SCAN POINT " << tag << endl;
+  cout << endl << "###############################" << endl;
+
+  // set and fix parameters for scan
+  for(size_t a=0; a<axes.size(); a++)
+    ati.parameterManager()->setAmpParameter( axes[a].parName, point.value[a] );
+
+  MinuitMinimizationManager* fitManager = ati.minuitMinimizationManager();
+
+  if(useMinos)
+    fitManager->minosMinimization();
+  else
+    fitManager->migradMinimization();
+
+  if(hesse)
+     fitManager->hesseEvaluation();
+
+  point.failed = (fitManager->status() != 0 || fitManager->eMatrixStatus() != 3);
+
+  if( point.failed )
+    cout << "ERROR: fit failed use results with caution..." << endl;
+
+  point.likelihood = ati.likelihood();
+  cout << "LIKELIHOOD AFTER MINIMIZATION:  " << point.likelihood << endl;
+
+  ati.finalizeFit(tag);
+
+  if( seedfile.size() != 0 && !point.failed ){
+    string seedfile_scan = seedfile + "_scan_" + tag + ".txt";
+    ati.fitResults()->writeSeed( seedfile_scan );
+  }
+
+  return point;
+}
+
+// the points of a walk, fit in order, the first one starting from the
+// parameters of the point seed
+struct ScanSegment {
+  pair<int, int> seed;
+  vector<ScanResult> points;
+};
+
+typedef map< pair<int, int>, vector<double> > ScanSnapshots;
+
+// the fitted production parameters and free amplitude parameters, so that
+// the fits of the neighbouring points can start from them
+vector<double> scanSnapshot(AmpToolsInterface& ati, ConfigurationInfo* cfgInfo) {
+  const FitResults* results = ati.fitResults();
+  vector<double> pars;
+
+  vector<AmplitudeInfo*> amps = cfgInfo->amplitudeList();
+  for(size_t n=0; n<amps.size(); n++) {
+    if( amps[n]->fixed() ) continue;
+    complex<double> prodPar = results->productionParameter(amps[n]->fullName());
+    pars.push_back(real(prodPar));
+    pars.push_back(imag(prodPar));
+  }
+
+  vector<ParameterInfo*> ampPars = cfgInfo->parameterList();
+  for(size_t n=0; n<ampPars.size(); n++) {
+    if( !ampPars[n]->fixed() ) pars.push_back(results->parValue(ampPars[n]->parName()));
+  }
+
+  return pars;
+}
+
+// keeps the current parameters if the point was not fit
+void restoreScanSnapshot(AmpToolsInterface& ati, ConfigurationInfo* cfgInfo, const vector<double>& pars) {
+  if( pars.empty() ) return;
+
+  ParameterManager* parMgr = ati.parameterManager();
+  size_t k = 0;
+
+  vector<AmplitudeInfo*> amps = cfgInfo->amplitudeList();
+  for(size_t n=0; n<amps.size(); n++) {
+    if( amps[n]->fixed() ) continue;
+    parMgr->setProductionParameter(amps[n]->fullName(), complex<double>(pars[k], pars[k+1]));
+    k += 2;
+  }
+
+  vector<ParameterInfo*> ampPars = cfgInfo->parameterList();
+  for(size_t n=0; n<ampPars.size(); n++) {
+    if( !ampPars[n]->fixed() ) parMgr->setAmpParameter(ampPars[n]->parName(), pars[k++]);
+  }
+}
+
+// the snapshots are too large for a single atomic write to a pipe
+bool writeAll(int fd, const void* data, size_t size) {
+  const char* bytes = (const char*)data;
+  while( size > 0 ) {
+    ssize_t n = write(fd, bytes, size);
+    if( n < 0 && errno == EINTR ) continue;
+    if( n <= 0 ) return false;
+    bytes += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool readAll(int fd, void* data, size_t size) {
+  char* bytes = (char*)data;
+  while( size > 0 ) {
+    ssize_t n = read(fd, bytes, size);
+    if( n < 0 && errno == EINTR ) continue;
+    if( n <= 0 ) return false;
+    bytes += n;
+    size -= n;
+  }
+  return true;
+}
+
+/**
+ * Fits the points of every segment in order.  The first point starts from
+ * the parameters of the segment's seed and every other point from the
+ * result of the previous one.  The parameters of all fitted points are
+ * added to snapshots, which must already hold the seeds.  With numProcs > 1
+ * every segment runs in a forked process, up to numProcs at a time, and the
+ * output of segment k goes to <logBase>_seg<k>.log.
+ */
+vector<ScanResult> runScanSegments(AmpToolsInterface& ati, ConfigurationInfo* cfgInfo, const vector<ScanAxis>& axes, const vector<ScanSegment>& segments, ScanSnapshots& snapshots, bool useMinos, bool hesse, const string& seedfile, const string& logBase, int numProcs) {
+  vector<ScanResult> results;
+
+#ifdef GPU_ACCELERATION
+  // the forked processes cannot share the GPU context
+  numProcs = 1;
+#endif
+
+  if( numProcs <= 1 ) {
+    for(size_t k=0; k<segments.size(); k++) {
+      restoreScanSnapshot(ati, cfgInfo, snapshots[segments[k].seed]);
+
+      for(size_t n=0; n<segments[k].points.size(); n++) {
+        ScanResult result = fitScanPoint(ati, axes, segments[k].points[n], useMinos, hesse, seedfile);
+        snapshots[make_pair(result.i, result.j)] = scanSnapshot(ati, cfgInfo);
+        results.push_back(result);
+      }
     }
+    return results;
+  }
+
+  size_t numPars = snapshots.begin()->second.size();
+
+  // process id and the pipe the results are read from
+  deque< pair<pid_t, int> > running;
+  size_t next = 0;
+
+  while( next < segments.size() || !running.empty() ) {
+
+    if( next < segments.size() && (int)running.size() < numProcs ) {
+
+      int fd[2];
+      if( pipe(fd) != 0 ) {
+        perror("pipe");
+        assert( false );
+      }
+
+      cout << flush;
+      fflush(stdout);
+      fflush(stderr);
+
+      pid_t pid = fork();
+      assert( pid >= 0 );
+
+      if( pid == 0 ) {
+
+        close(fd[0]);
+        redirectOutput(logBase + Form("_seg%d.log", (int)next));
+
+        restoreScanSnapshot(ati, cfgInfo, snapshots[segments[next].seed]);
+
+        bool written = true;
+        for(size_t n=0; n<segments[next].points.size(); n++) {
+          ScanResult result = fitScanPoint(ati, axes, segments[next].points[n], useMinos, hesse, seedfile);
+          vector<double> pars = scanSnapshot(ati, cfgInfo);
+
+          cout << flush;
+          fflush(stdout);
+
+          written = written && writeAll(fd[1], &result, sizeof(result)) &&
+            ( numPars == 0 || writeAll(fd[1], &(pars[0]), numPars*sizeof(double)) );
+        }
+
+        // skip the destructors, the parent still owns the shared state
+        _exit( written ? 0 : 1 );
+      }
+
+      close(fd[1]);
+      running.push_back(make_pair(pid, fd[0]));
+
+      cout << "STARTED SCAN SEGMENT " << next << " OF " << segments.size() << " IN PROCESS " << pid << endl;
+      ++next;
+      continue;
+    }
+
+    // the oldest segment is read until it closes the pipe
+    pid_t pid = running.front().first;
+    int fd = running.front().second;
+    running.pop_front();
+
+    ScanResult result;
+    vector<double> pars(numPars);
+    while( readAll(fd, &result, sizeof(result)) &&
+           ( numPars == 0 || readAll(fd, &(pars[0]), numPars*sizeof(double)) ) ) {
+      cout << "SCAN POINT " << scanTag(result, axes.size()) << ( result.failed ? " FAILED" : "" )
+           << ", LIKELIHOOD AFTER MINIMIZATION:  " << result.likelihood << endl;
+      snapshots[make_pair(result.i, result.j)] = pars;
+      results.push_back(result);
+    }
+    close(fd);
+
+    int status = 0;
+    pid_t done;
+    do {
+      done = waitpid(pid, &status, 0);
+    } while( done < 0 && errno == EINTR );
+
+    if( done < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 )
+      cout << "ERROR: scan segment in process " << pid << " did not finish, see " << logBase << "_seg*.log" << endl;
+  }
+
+  return results;
+}
+
+int bestScanResult(const vector<ScanResult>& results) {
+  int best = -1;
+  for(size_t n=0; n<results.size(); n++) {
+    if( !results[n].failed && ( best < 0 || results[n].likelihood < results[best].likelihood ) )
+      best = n;
+  }
+  return best;
+}
+
+/**
+ * Scans one parameter, or two on a grid.  The point closest to the values
+ * in the configuration file is fit first.  All other points are reached
+ * from it in single steps, so each fit starts from the result of its
+ * neighbour: first outwards in both directions along the first axis, then
+ * for two parameters outwards in both directions along the second axis
+ * from every point of that column.  With numProcs > 1 these walks run in
+ * forked processes at the same time; they are not split further, since the
+ * parts would have to restart from the first point.  For one parameter the
+ * step is then halved numRefine times around the lowest likelihood.
+ */
+void runParScan(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIter, string seedfile, string parScan, int numProcs, int numRefine) {
+  vector<string> parNames;
+  size_t comma = parScan.find(',');
+  parNames.push_back(parScan.substr(0, comma));
+  if(comma != string::npos) parNames.push_back(parScan.substr(comma+1));
+
+  vector<ScanAxis> axes(parNames.size());
+  for(size_t a=0; a<parNames.size(); a++) {
+    if( !findScanAxis(cfgInfo, parNames[a], axes[a]) ) return;
   }
 
   AmpToolsInterface ati( cfgInfo );
 
   string fitName = cfgInfo->fitName();
   cout << "LIKELIHOOD BEFORE MINIMIZATION:  " << ati.likelihood() << endl;
+  if( normIntCache ) normIntCache->store( ati );
 
-  ParameterManager* parMgr = ati.parameterManager();
   MinuitMinimizationManager* fitManager = ati.minuitMinimizationManager();
   fitManager->setMaxIterations(maxIter);
 
+  cfgInfo->setFitName(fitName + "_scan");
 
-  for(int i=0; i<steps; i++) {
-    cout << endl << "###############################" << endl;
-    cout << "FIT " << i << " OF " << steps << endl;
-    cout << endl << "###############################" << endl;
+  int rows = axes[0].steps;
+  int columns = axes.size() > 1 ? axes[1].steps : 1;
+  int startRow = axes[0].start;
+  int startColumn = axes.size() > 1 ? axes[1].start : 0;
+  pair<int, int> start(startRow, startColumn);
+
+  vector<ScanResult> results;
+  results.push_back( fitScanPoint(ati, axes, scanPoint(axes, startRow, startColumn), useMinos, hesse, seedfile) );
 
-    // set parameter to be scanned
-    vector<ParameterInfo*> parInfoVec = cfgInfo->parameterList();
+  ScanSnapshots snapshots;
+  snapshots[start] = scanSnapshot(ati, cfgInfo);
+
+  // the walks along the first axis
+  vector<ScanSegment> segments;
+  for(int dir=1; dir>=-1; dir-=2) {
+    ScanSegment segment;
+    segment.seed = start;
+    for(int i = startRow+dir; i >= 0 && i < rows; i += dir)
+      segment.points.push_back( scanPoint(axes, i, startColumn) );
+    if( !segment.points.empty() ) segments.push_back(segment);
+  }
 
-    auto parItr = parInfoVec.begin();
-    for( ; parItr != parInfoVec.end(); ++parItr ) {
-      if( (**parItr).parName() == parScan ) break;
+  vector<ScanResult> segmentResults = runScanSegments(ati, cfgInfo, axes, segments, snapshots, useMinos, hesse, seedfile, fitName + "_scan", numProcs);
+  results.insert(results.end(), segmentResults.begin(), segmentResults.end());
+
+  // the walks along the second axis, from the points of the first walks
+  segments.clear();
+  for(int i=0; i<rows && columns>1; i++) {
+    for(int dir=1; dir>=-1; dir-=2) {
+      ScanSegment segment;
+      segment.seed = make_pair(i, startColumn);
+      if( snapshots.count(segment.seed) == 0 ) segment.seed = start;
+
+      for(int j = startColumn+dir; j >= 0 && j < columns; j += dir)
+        segment.points.push_back( scanPoint(axes, i, j) );
+      if( !segment.points.empty() ) segments.push_back(segment);
     }
+  }
 
-    if( parItr == parInfoVec.end() ){
-      cout << "ERROR:  request to scan nonexistent parameter:  " << parScan << endl;
-      return;
+  if( !segments.empty() ) {
+    segmentResults = runScanSegments(ati, cfgInfo, axes, segments, snapshots, useMinos, hesse, seedfile, fitName + "_scan_row", numProcs);
+    results.insert(results.end(), segmentResults.begin(), segmentResults.end());
+  }
+
+  if( numRefine > 0 && axes.size() > 1 )
+    cout << "Refinement of the step size is only done for scans of one parameter" << endl;
+
+  int best = bestScanResult(results);
+  if( numRefine > 0 && axes.size() == 1 && best >= 0 ) {
+    // both sides start from the current best point
+    ScanResult bestPoint = results[best];
+    double step = axes[0].stepSize;
+
+    for(int level=1; level<=numRefine; level++) {
+      step /= 2;
+      ScanResult center = bestPoint;
+
+      for(int side=0; side<2; side++) {
+        ScanResult point = center;
+        point.i = -level;
+        point.j = side;
+        point.value[0] = center.value[0] + ( side == 0 ? -step : step );
+        if( point.value[0] < axes[0].minVal || point.value[0] > axes[0].maxVal ) continue;
+
+        restoreScanSnapshot(ati, cfgInfo, snapshots[make_pair(center.i, center.j)]);
+        point = fitScanPoint(ati, axes, point, useMinos, hesse, seedfile);
+        snapshots[make_pair(point.i, point.j)] = scanSnapshot(ati, cfgInfo);
+        results.push_back(point);
+
+        if( !point.failed && point.likelihood < bestPoint.likelihood ) bestPoint = point;
+      }
+    }
+
+    best = bestScanResult(results);
+  }
+
+  // summary of all points in order of the scanned values
+  vector<ScanResult> sorted = results;
+  sort(sorted.begin(), sorted.end(), [](const ScanResult& a, const ScanResult& b) {
+      return a.value[0] < b.value[0] || ( a.value[0] == b.value[0] && a.value[1] < b.value[1] ); });
+
+  string summaryName = fitName + "_scan_summary.txt";
+  ofstream summary(summaryName.c_str());
+  summary << "# tag";
+  for(size_t a=0; a<axes.size(); a++) summary << " " << axes[a].parName;
+  summary << " likelihood failed" << endl;
+  summary.precision(10);
+
+  for(size_t n=0; n<sorted.size(); n++) {
+    summary << scanTag(sorted[n], axes.size());
+    for(size_t a=0; a<axes.size(); a++) summary << " " << sorted[n].value[a];
+    summary << " " << sorted[n].likelihood << " " << sorted[n].failed << endl;
+  }
+
+  cout << "Wrote " << sorted.size() << " scan points to " << summaryName << endl;
+
+  if(best < 0) cout << "ALL FITS FAILED!" << endl;
+  else {
+    cout << "MINIMUM LIKELIHOOD OF THE SCAN AT " << scanTag(results[best], axes.size()) << ":";
+    for(size_t a=0; a<axes.size(); a++) cout << " " << axes[a].parName << " = " << results[best].value[a];
+    cout << ", LIKELIHOOD = " << results[best].likelihood << endl;
+  }
+}
+
+/**
+ * Runs one job of the fit server.  A job is one line of keywords:
+ *   name <tag>               write the result to <fitName>_<tag>.fit (default job<n>)
+ *   set <parameter> <value>  set an amplitude parameter before the fit
+ *   random <seed>            randomize the production parameters, and those
+ *                            with a parRange keyword, as for -r
+ *   fraction <value>         maximum fraction used by random (default 0.5)
+ *   minos, hesse             as -n and -H
+ *   maxiter <n>              as -m
+ *   seed <file>              write a seed file as -s
+ * Every job starts from the parameters of the configuration file.  The
+ * reply is "<tag> <likelihood> <status>", where status 0 is a good fit, or
+ * a line starting with ERROR.
+ */
+string runFitJob(AmpToolsInterface& ati, ConfigurationInfo* cfgInfo, const string& job, int jobNumber, bool useMinos, bool hesse, int maxIter) {
+  string tag = "job" + to_string(jobNumber);
+  string seedfile;
+  vector< pair<string, double> > setPars;
+  bool randomize = false;
+  unsigned int randomSeed = 0;
+  double maxFraction = 0.5;
+
+  istringstream in(job);
+  string key;
+  while( in >> key ) {
+    if(key == "name") in >> tag;
+    else if(key == "set") {
+      string par;
+      double value;
+      in >> par >> value;
+      setPars.push_back(make_pair(par, value));
+    }
+    else if(key == "random") {
+      randomize = true;
+      in >> randomSeed;
+    }
+    else if(key == "fraction") in >> maxFraction;
+    else if(key == "minos") useMinos = true;
+    else if(key == "hesse") hesse = true;
+    else if(key == "maxiter") in >> maxIter;
+    else if(key == "seed") in >> seedfile;
+    else return "ERROR unknown keyword " + key;
+
+    if( in.fail() ) return "ERROR missing value for " + key;
+  }
+
+  cout << endl << "###############################" << endl;
+  cout << "FIT SERVER JOB " << jobNumber << ":  " << job << endl;
+  cout << endl << "###############################" << endl;
+
+  // forget the result of the previous job
+  ati.reinitializePars();
+
+  for(size_t ipar=0; ipar<setPars.size(); ipar++)
+    ati.parameterManager()->setAmpParameter( setPars[ipar].first, setPars[ipar].second );
+
+  if( randomize ) {
+    vector< vector<string> > parRangeKeywords = cfgInfo->userKeywordArguments("parRange");
+
+    AmpToolsInterface::setRandomSeed(randomSeed);
+    ati.randomizeProductionPars(maxFraction);
+    for(size_t ipar=0; ipar<parRangeKeywords.size(); ipar++) {
+      ati.randomizeParameter(parRangeKeywords[ipar][0], atof(parRangeKeywords[ipar][1].c_str()), atof(parRangeKeywords[ipar][2].c_str()));
     }
+  }
 
-    // set and fix parameter for scan
-    double value = minVal + i*stepSize;
-    parMgr->setAmpParameter( parScan, value );
+  MinuitMinimizationManager* fitManager = ati.minuitMinimizationManager();
+  fitManager->setMaxIterations(maxIter);
 
-    cfgInfo->setFitName(fitName + "_scan");
+  {
+    AmpProfileScope profile( ampProfileCounter("minimization", useMinos ? "MINOS" : "MIGRAD") );
 
     if(useMinos)
       fitManager->minosMinimization();
     else
       fitManager->migradMinimization();
+  }
 
-    if(hesse)
-       fitManager->hesseEvaluation();
+  if(hesse) {
+     AmpProfileScope profile( ampProfileCounter("minimization", "HESSE") );
+     fitManager->hesseEvaluation();
+  }
 
-    bool fitFailed = (fitManager->status() != 0 || fitManager->eMatrixStatus() != 3);
+  bool fitFailed = (fitManager->status() != 0 || fitManager->eMatrixStatus() != 3);
 
-    if( fitFailed )
-      cout << "ERROR: fit failed use results with caution..." << endl;
+  if( fitFailed )
+    cout << "ERROR: fit failed use results with caution..." << endl;
 
-    cout << "LIKELIHOOD AFTER MINIMIZATION:  " << ati.likelihood() << endl;
+  double likelihood = ati.likelihood();
+  cout << "LIKELIHOOD AFTER MINIMIZATION:  " << likelihood << endl;
 
-    ati.finalizeFit(to_string(i));
+  ati.finalizeFit(tag);
 
-    if( seedfile.size() != 0 && !fitFailed ){
-      string seedfile_scan = seedfile + Form("_scan_%d.txt", i);
-      ati.fitResults()->writeSeed( seedfile_scan );
+  if( seedfile.size() != 0 && !fitFailed )
+    ati.fitResults()->writeSeed( seedfile );
+
+  ostringstream reply;
+  reply << tag << " " << setprecision(12) << likelihood << " " << ( fitFailed ? 1 : 0 );
+  return reply.str();
+}
+
+string trimmed(const string& line) {
+  size_t first = line.find_first_not_of(" \t\r");
+  if( first == string::npos ) return "";
+  return line.substr(first, line.find_last_not_of(" \t\r") - first + 1);
+}
+
+/**
+ * Reads the data, computes the amplitudes and normalization integrals
+ * once, then runs fit jobs (see runFitJob) one after the other until
+ * a line "quit" or the end of the input.  The jobs are read from a file,
+ * or, if useSocket is set, from connections to a Unix socket with that
+ * name, which get one reply line for every job line they send.
+ */
+void runFitServer(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIter, string jobSource, bool useSocket) {
+  AmpProfileScope setup( ampProfileCounter("setup", "AmpToolsInterface") );
+  AmpToolsInterface ati( cfgInfo );
+  setup.stop();
+
+  cout << "LIKELIHOOD BEFORE MINIMIZATION:  " << ati.likelihood() << endl;
+  if( normIntCache ) normIntCache->store( ati );
+
+  int jobNumber = 0;
+
+  if( !useSocket ) {
+    ifstream jobs(jobSource.c_str());
+    if( !jobs.good() ) {
+      cout << "ERROR: cannot read fit jobs from " << jobSource << endl;
+      return;
+    }
+
+    string line;
+    while( getline(jobs, line) ) {
+      line = trimmed(line);
+      if( line.empty() || line[0] == '#' ) continue;
+      if( line == "quit" ) break;
+
+      cout << "FIT SERVER RESULT:  " << runFitJob(ati, cfgInfo, line, jobNumber++, useMinos, hesse, maxIter) << endl;
     }
+    return;
+  }
+
+  // a client that goes away must not stop the server
+  signal(SIGPIPE, SIG_IGN);
+
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if( jobSource.size() >= sizeof(address.sun_path) ) {
+    cout << "ERROR: socket name too long:  " << jobSource << endl;
+    return;
   }
+  strcpy(address.sun_path, jobSource.c_str());
+
+  // a socket left behind by an earlier server is replaced, anything else
+  // at that path is kept
+  struct stat info;
+  if( lstat(jobSource.c_str(), &info) == 0 ) {
+    if( !S_ISSOCK(info.st_mode) ) {
+      cout << "ERROR: " << jobSource << " exists and is not a socket" << endl;
+      return;
+    }
+    unlink(jobSource.c_str());
+  }
+
+  int server = socket(AF_UNIX, SOCK_STREAM, 0);
+  if( server < 0 || bind(server, (sockaddr*)&address, sizeof(address)) != 0 || listen(server, 8) != 0 ) {
+    perror("fit server");
+    return;
+  }
+
+  cout << "FIT SERVER LISTENING ON " << jobSource << endl;
+
+  bool stop = false;
+  while( !stop ) {
+    int client = accept(server, NULL, NULL);
+    if( client < 0 ) {
+      if( errno == EINTR ) continue;
+      perror("accept");
+      break;
+    }
+
+    string buffer;
+    char chunk[4096];
+    ssize_t length;
+    bool connected = true;
+
+    while( connected && !stop && ( length = read(client, chunk, sizeof(chunk)) ) > 0 ) {
+      buffer.append(chunk, length);
+
+      size_t end;
+      while( connected && !stop && ( end = buffer.find('\n') ) != string::npos ) {
+        string line = trimmed(buffer.substr(0, end));
+        buffer.erase(0, end + 1);
+        if( line.empty() || line[0] == '#' ) continue;
+
+        string reply;
+        if( line == "quit" ) {
+          stop = true;
+          reply = "BYE";
+        }
+        else reply = runFitJob(ati, cfgInfo, line, jobNumber++, useMinos, hesse, maxIter);
+
+        reply += "\n";
+        connected = ( write(client, reply.data(), reply.size()) == (ssize_t)reply.size() );
+      }
+    }
+
+    close(client);
+  }
+
+  close(server);
+  unlink(jobSource.c_str());
 }
 
 int main( int argc, char* argv[] ){
@@ -246,9 +1042,14 @@ int main( int argc, char* argv[] ){
    string configfile;
    string seedfile;
    string scanPar;
+   string jobSource;
+   string profileFile;
+   bool useSocket = false;
    int numRnd = 0;
    unsigned int randomSeed=static_cast<unsigned int>(time(NULL));
    int maxIter = 10000;
+   int numProcs = 1;
+   int numRefine = 0;
 
    // parse command line
 
@@ -271,6 +1072,21 @@ int main( int argc, char* argv[] ){
       if (arg == "-m"){
          if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
          else  maxIter = atoi(argv[++i]); }
+      if (arg == "-j"){
+         if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+         else  numProcs = atoi(argv[++i]); }
+      if (arg == "-pr"){
+         if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+         else  numRefine = atoi(argv[++i]); }
+      if (arg == "-J"){
+         if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+         else { jobSource = argv[++i]; useSocket = false; } }
+      if (arg == "-U"){
+         if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+         else { jobSource = argv[++i]; useSocket = true; } }
+      if (arg == "-P"){
+         if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+         else  profileFile = argv[++i]; }
       if (arg == "-n") useMinos = true;
       if (arg == "-H") hesse = true;
       if (arg == "-p"){
@@ -284,20 +1100,48 @@ int main( int argc, char* argv[] ){
          cout << "   -s <output file>\t\t\t for seeding next fit based on this fit (optional)" << endl;
          cout << "   -r <int>\t\t\t Perform <int> fits each seeded with random parameters" << endl;
             cout << "   -rs <int>\t\t\t Sets the random seed used by the random number generator for the fits with randomized initial parameters. If not set will use the time()" << endl;
-         cout << "   -p <parameter> \t\t\t\t Perform a scan of given parameter. Stepsize, min, max are to be set in cfg file" << endl;
+         cout << "   -j <int>\t\t\t Run up to <int> of the randomized fits or scan segments at the same time, each in its own process with single threaded amplitude kernels" << endl;
+         cout << "   -p <parameter> \t\t\t\t Perform a scan of given parameter, or of two on a grid if separated by a comma. Stepsize, min, max are to be set in cfg file" << endl;
+         cout << "   -pr <int>\t\t\t Refine a scan of one parameter around its minimum by halving the step <int> times" << endl;
          cout << "   -m <int>\t\t\t Maximum number of fit iterations" << endl; 
+         cout << "   -J <file>\t\t\t Read the data once and run the fit jobs in <file>, one per line" << endl;
+         cout << "   -U <socket>\t\t\t Read the data once and run the fit jobs sent to the Unix socket <socket>" << endl;
+         cout << "   -P <file>\t\t\t Time calcAmplitudeAll of the profiled amplitudes, the setup and the minimization, and write the result as JSON to <file> (no timing per likelihood evaluation or of the normalization integrals; not for fits run with -j)" << endl;
          exit(1);}
    }
 
+   if (numProcs < 1) numProcs = 1;
+
+#ifdef _OPENMP
+   // the thread pool of OpenMP does not survive fork, so the amplitude
+   // kernels must not start it before the fits are forked
+   if (numProcs > 1) omp_set_num_threads(1);
+#endif
+
    if (configfile.size() == 0){
       cout << "No config file specified" << endl;
             exit(1);
    }
 
+   // the amplitudes look up their counters when they are created
+   if (profileFile.size() != 0) ampProfilerEnable();
+
    ConfigFileParser parser(configfile);
    ConfigurationInfo* cfgInfo = parser.getConfigurationInfo();
    cfgInfo->display();
 
+   // reactions with cached normalization integrals read them instead of the MC,
+   // the scanned parameters change and the server jobs may change any of them
+   if(jobSource.size() == 0){
+      vector<string> scanPars;
+      for(size_t begin = 0; begin < scanPar.size(); ){
+         size_t comma = min(scanPar.find(',', begin), scanPar.size());
+         scanPars.push_back(scanPar.substr(begin, comma - begin));
+         begin = comma + 1;
+      }
+      normIntCache = NormIntCache::open(cfgInfo, scanPars);
+   }
+
    AmpToolsInterface::registerAmplitude( BreitWigner() );
    AmpToolsInterface::registerAmplitude( BreitWigner3body() );
    AmpToolsInterface::registerAmplitude( TwoPSAngles() );
@@ -330,16 +1174,32 @@ int main( int argc, char* argv[] ){
    AmpToolsInterface::registerDataReader( ROOTDataReaderWithTCut() );
    AmpToolsInterface::registerDataReader( ROOTDataReaderTEM() );
    AmpToolsInterface::registerDataReader( FSRootDataReader() );
+   AmpToolsInterface::registerDataReader( ROOTChainDataReader() );
 
-   if(numRnd==0){
+   if(jobSource.size() != 0){
+      runFitServer(cfgInfo, useMinos, hesse, maxIter, jobSource, useSocket);
+   } else if(numRnd==0){
       if(scanPar=="")
          runSingleFit(cfgInfo, useMinos, hesse, maxIter, seedfile);
       else
-         runParScan(cfgInfo, useMinos, hesse, maxIter, seedfile, scanPar);
+         runParScan(cfgInfo, useMinos, hesse, maxIter, seedfile, scanPar, numProcs, numRefine);
    } else {
       cout << "Running " << numRnd << " fits with randomized parameters with seed=" << randomSeed << endl;
-      AmpToolsInterface::setRandomSeed(randomSeed);
-      runRndFits(cfgInfo, useMinos, hesse, maxIter, seedfile, numRnd, 0.5);
+#ifdef GPU_ACCELERATION
+      // the forked processes cannot share the GPU context
+      numProcs = 1;
+#endif
+      if(numProcs > 1)
+         runRndFitsParallel(cfgInfo, useMinos, hesse, maxIter, seedfile, numRnd, 0.5, randomSeed, numProcs);
+      else
+         runRndFits(cfgInfo, useMinos, hesse, maxIter, seedfile, numRnd, 0.5, randomSeed);
+   }
+
+   if (profileFile.size() != 0){
+      ampProfilerPrint(cout);
+
+      ofstream profile(profileFile.c_str());
+      ampProfilerWriteJSON(profile);
    }
 
   return 0;
@@ -14,6 +14,9 @@
 #include "AMPTOOLS_DATAIO/ROOTDataReaderWithTCut.h"
 #include "AMPTOOLS_DATAIO/ROOTDataReaderTEM.h"
 #include "AMPTOOLS_DATAIO/FSRootDataReader.h"
+#include "AMPTOOLS_DATAIO/ROOTChainDataReader.h"
+#include "AMPTOOLS_DATAIO/NormIntCache.h"
+#include "AMPTOOLS_DATAIO/FileUtilities.h"
 #include "AMPTOOLS_AMPS/TwoPSAngles.h"
 #include "AMPTOOLS_AMPS/TwoPSHelicity.h"
 #include "AMPTOOLS_AMPS/TwoPiAngles.h"
@@ -41,6 +44,7 @@
 #include "AMPTOOLS_AMPS/Piecewise.h"
 #include "AMPTOOLS_AMPS/Flatte.h"
 #include "AMPTOOLS_AMPS/PhaseOffset.h"
+#include "AMPTOOLS_AMPS/ampProfiler.h"
 
 #include "MinuitInterface/MinuitMinimizationManager.h"
 #include "IUAmpToolsMPI/AmpToolsInterfaceMPI.h"
@@ -55,24 +59,36 @@ using namespace std;
 int rank_mpi;
 int size;
 
+// NULL unless the normalization integrals are cached, see NormIntCache
+NormIntCache* normIntCache = NULL;
+
 double runSingleFit(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIter, string seedfile) {
+   AmpProfileScope setup( ampProfileCounter("setup", "AmpToolsInterfaceMPI") );
    AmpToolsInterfaceMPI ati( cfgInfo );
+   setup.stop();
    bool fitFailed = true;
    double lh = 1e7;
 
    if(rank_mpi==0) {
       cout << "LIKELIHOOD BEFORE MINIMIZATION:  " << ati.likelihood() << endl;
+      if( normIntCache ) normIntCache->store( ati );
 
       MinuitMinimizationManager* fitManager = ati.minuitMinimizationManager();
       fitManager->setMaxIterations(maxIter);
 
-      if( useMinos )
-         fitManager->minosMinimization();
-      else
-         fitManager->migradMinimization();
+      {
+         AmpProfileScope profile( ampProfileCounter("minimization", useMinos ? "MINOS" : "MIGRAD") );
 
-      if(hesse)
+         if( useMinos )
+            fitManager->minosMinimization();
+         else
+            fitManager->migradMinimization();
+      }
+
+      if(hesse) {
+         AmpProfileScope profile( ampProfileCounter("minimization", "HESSE") );
          fitManager->hesseEvaluation();
+      }
 
       fitFailed = ( fitManager->status() != 0 || fitManager->eMatrixStatus() != 3 );
 
@@ -95,8 +111,10 @@ double runSingleFit(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int m
    return lh;
 }
 
-void runRndFits(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIter, string seedfile, int numRnd, double maxFraction) {
+void runRndFits(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIter, string seedfile, int numRnd, double maxFraction, unsigned int randomSeed) {
+   AmpProfileScope setup( ampProfileCounter("setup", "AmpToolsInterfaceMPI") );
    AmpToolsInterfaceMPI ati( cfgInfo );
+   setup.stop();
 
    MinuitMinimizationManager* fitManager = NULL; 
    vector< vector<string> > parRangeKeywords;
@@ -108,6 +126,7 @@ void runRndFits(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIt
       fitName = cfgInfo->fitName();
 
       cout << "LIKELIHOOD BEFORE MINIMIZATION:  " << ati.likelihood() << endl;
+      if( normIntCache ) normIntCache->store( ati );
 
       fitManager = ati.minuitMinimizationManager();
       fitManager->setMaxIterations(maxIter);
@@ -128,19 +147,28 @@ void runRndFits(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIt
          cout << "FIT " << i << " OF " << numRnd << endl;
          cout << endl << "###############################" << endl;
 
-         // randomize parameters
+         // every fit starts from the parameters of the configuration file,
+         // randomized with its own seed, like in fit
+         ati.reinitializePars();
+         AmpToolsInterface::setRandomSeed(randomSeed + i);
          ati.randomizeProductionPars(maxFraction);
          for(size_t ipar=0; ipar<parRangeKeywords.size(); ipar++) {
             ati.randomizeParameter(parRangeKeywords[ipar][0], atof(parRangeKeywords[ipar][1].c_str()), atof(parRangeKeywords[ipar][2].c_str()));
          }
 
-         if(useMinos)
-            fitManager->minosMinimization();
-         else
-            fitManager->migradMinimization();
+         {
+            AmpProfileScope profile( ampProfileCounter("minimization", useMinos ? "MINOS" : "MIGRAD") );
 
-         if(hesse)
+            if(useMinos)
+               fitManager->minosMinimization();
+            else
+               fitManager->migradMinimization();
+         }
+
+         if(hesse) {
+            AmpProfileScope profile( ampProfileCounter("minimization", "HESSE") );
             fitManager->hesseEvaluation();
+         }
 
          fitFailed = (fitManager->status() != 0 || fitManager->eMatrixStatus() != 3);
 
@@ -170,9 +198,10 @@ void runRndFits(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIt
       if(minFitTag < 0) cout << "ALL FITS FAILED!" << endl;
       else {
          cout << "MINIMUM LIKELIHOOD FROM " << minFitTag << " of " << numRnd << " RANDOM PRODUCTION PARS = " << minLH << endl;
-         gSystem->Exec(Form("cp %s_%d.fit %s.fit", fitName.data(), minFitTag, fitName.data()));
-         if( seedfile.size() != 0 )
-            gSystem->Exec(Form("cp %s_%d.txt %s.txt", seedfile.data(), minFitTag, seedfile.data()));
+         if( !copyFile(Form("%s_%d.fit", fitName.data(), minFitTag), fitName + ".fit") )
+            cout << "ERROR: cannot copy " << fitName << "_" << minFitTag << ".fit" << endl;
+         if( seedfile.size() != 0 && !copyFile(seedfile + Form("_%d.txt", minFitTag), seedfile + ".txt") )
+            cout << "ERROR: cannot copy " << seedfile << "_" << minFitTag << ".txt" << endl;
       }
    }
 
@@ -211,6 +240,7 @@ void runParScan(ConfigurationInfo* cfgInfo, bool useMinos, bool hesse, int maxIt
    if(rank_mpi==0) {
       fitName = cfgInfo->fitName();
       cout << "LIKELIHOOD BEFORE MINIMIZATION:  " << ati.likelihood() << endl;
+      if( normIntCache ) normIntCache->store( ati );
 
       parMgr = ati.parameterManager();
       fitManager = ati.minuitMinimizationManager();
@@ -286,6 +316,7 @@ int main( int argc, char* argv[] ){
    string configfile;
    string seedfile;
    string scanPar;
+   string profileFile;
    int numRnd = 0;
    unsigned int randomSeed=static_cast<unsigned int>(time(NULL));
    int maxIter = 10000;
@@ -311,6 +342,9 @@ int main( int argc, char* argv[] ){
       if (arg == "-m"){
          if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
          else  maxIter = atoi(argv[++i]); }
+      if (arg == "-P"){
+         if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+         else  profileFile = argv[++i]; }
       if (arg == "-n") useMinos = true;
       if (arg == "-H") hesse = true;
       if (arg == "-p"){
@@ -327,6 +361,7 @@ int main( int argc, char* argv[] ){
             cout << "   -rs <int>\t\t\t Sets the random seed used by the random number generator for the fits with randomized initial parameters. If not set will use the time()" << endl;
             cout << "   -p <parameter> \t\t\t\t Perform a scan of given parameter. Stepsize, min, max are to be set in cfg file" << endl;
             cout << "   -m <int>\t\t\t Maximum number of fit iterations" << endl; 
+            cout << "   -P <file>\t\t\t Time calcAmplitudeAll of the profiled amplitudes, the setup and the minimization, and write the result of each process as JSON to <file>.<rank> (no timing per likelihood evaluation or of the normalization integrals)" << endl;
          }
          MPI_Finalize();
          exit(1);
@@ -339,10 +374,19 @@ int main( int argc, char* argv[] ){
       exit(1);
    }
 
+   // the amplitudes look up their counters when they are created
+   if (profileFile.size() != 0) ampProfilerEnable();
+
    ConfigFileParser parser(configfile);
    ConfigurationInfo* cfgInfo = parser.getConfigurationInfo();
    if( rank_mpi == 0 ) cfgInfo->display();
 
+   // reactions with cached normalization integrals read them instead of the MC,
+   // the scanned parameter changes
+   vector<string> scanPars;
+   if(scanPar != "") scanPars.push_back(scanPar);
+   normIntCache = NormIntCache::open(cfgInfo, scanPars);
+
    AmpToolsInterface::registerAmplitude( BreitWigner() );
    AmpToolsInterface::registerAmplitude( BreitWigner3body() );
    AmpToolsInterface::registerAmplitude( TwoPSAngles() );
@@ -373,6 +417,7 @@ int main( int argc, char* argv[] ){
    AmpToolsInterface::registerDataReader( DataReaderMPI<ROOTDataReaderWithTCut>() );
    AmpToolsInterface::registerDataReader( DataReaderMPI<ROOTDataReaderTEM>() );
    AmpToolsInterface::registerDataReader( DataReaderMPI<FSRootDataReader>() );
+   AmpToolsInterface::registerDataReader( DataReaderMPI<ROOTChainDataReader>() );
 
    if(numRnd==0){
       if(scanPar=="")
@@ -381,8 +426,16 @@ int main( int argc, char* argv[] ){
          runParScan(cfgInfo, useMinos, hesse, maxIter, seedfile, scanPar);
    } else {
       cout << "Running " << numRnd << " fits with randomized parameters with seed=" << randomSeed << endl;
-      AmpToolsInterface::setRandomSeed(randomSeed);
-      runRndFits(cfgInfo, useMinos, hesse, maxIter, seedfile, numRnd, 0.5);
+      runRndFits(cfgInfo, useMinos, hesse, maxIter, seedfile, numRnd, 0.5, randomSeed);
+   }
+
+   // the leader runs MINUIT, the followers compute the amplitudes of
+   // their share of the events, so every process writes its own profile
+   if (profileFile.size() != 0){
+      if( rank_mpi == 0 ) ampProfilerPrint(cout);
+
+      ofstream profile((profileFile + "." + to_string(rank_mpi)).c_str());
+      ampProfilerWriteJSON(profile);
    }
 
    return 0;
@@ -0,0 +1,597 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "IUAmpTools/FitResults.h"
+
+using namespace std;
+
+void Usage()
+{
+  cout << "Usage:\n  fit_bins -c <template.cfg> -b <nBins> [-b <nBins> ...] [OPTIONS] [-- <fit options>]\n\n";
+  cout << "  Runs the fit in every bin directory bin_<i>[_<j>...] of the fit directory, with one\n";
+  cout << "  index per -b in the order used by split_mass, split_t and split_bins.  Each bin gets\n";
+  cout << "  the configuration bin_<tag>.cfg made from the template by replacing\n";
+  cout << "     FITNAME   -> bin_<tag>        NIFILE    -> bin_<tag>.ni\n";
+  cout << "     DATAFILE  -> <dataBase>_<tag>.root     ACCMCFILE -> <accBase>_<tag>.root\n";
+  cout << "     GENMCFILE -> <genBase>_<tag>.root      BKGNDFILE -> <bkgBase>_<tag>.root\n";
+  cout << "  Split files found in the fit directory are moved into their bin directory.\n";
+  cout << "  Bins whose fit completed with the same configuration, input files and fit options are\n";
+  cout << "  skipped, so an interrupted run is resumed by starting it again.  The fit output goes\n";
+  cout << "  to bin_<tag>/bin_<tag>.log.\n\n";
+  cout << "  Options: \n";
+  cout << "   -d [fitDir]    : Directory holding the bin directories (default .)\n";
+  cout << "   -D [dataBase]  : Base name of the split data files\n";
+  cout << "   -A [accBase]   : Base name of the split accepted MC files\n";
+  cout << "   -G [genBase]   : Base name of the split generated MC files\n";
+  cout << "   -K [bkgBase]   : Base name of the split background files\n";
+  cout << "   -j [nCores]    : Number of cores to use (default all)\n";
+  cout << "   -M [MB]        : Memory the fits may use in total (default: available memory at start)\n";
+  cout << "   -m [MB]        : Memory needed by one fit (default: estimated from the input size,\n";
+  cout << "                    then from the peak memory of the completed fits)\n";
+  cout << "   -R [nRetries]  : Number of times a failed fit is started again (default 1)\n";
+  cout << "   -k [cacheDir]  : Directory of the binary kinematics caches (default: next to the\n";
+  cout << "                    input files unless AMPTOOLS_KIN_CACHE is set, 0 disables them)\n";
+  cout << "   -e [fit]       : Fit executable (default fit)\n";
+  cout << "   -o [file]      : Summary of all bins (default <fitDir>/fit_bins_summary.txt)\n";
+  cout << "   -f             : Fit all bins again, even those that are complete\n";
+  cout << "  All arguments after -- are passed to fit, e.g. -- -r 20 -j 4 for 20 randomized\n";
+  cout << "  fits in every bin.  A fit run with -j <n> counts as <n> cores.\n";
+  cout << "  The normalization integrals of the bins are cached next to the accepted MC unless\n";
+  cout << "  AMPTOOLS_NI_CACHE is set, see NormIntCache.\n";
+  exit(1);
+}
+
+
+enum BinStatus { kPending, kRunning, kDone, kSkipped, kFailed };
+
+struct Bin {
+
+  string tag;
+  string dir;
+  string cfgText;
+  string cfgHash;
+  double inputMB;
+
+  BinStatus status;
+  int attempts;
+  time_t start;
+  double seconds;
+  double peakMB;
+};
+
+bool fileExists( const string& path ){
+
+  struct stat info;
+  return stat( path.c_str(), &info ) == 0;
+}
+
+double fileMB( const string& path ){
+
+  struct stat info;
+  if( stat( path.c_str(), &info ) != 0 ) return 0;
+  return info.st_size / 1048576.;
+}
+
+time_t fileTime( const string& path ){
+
+  struct stat info;
+  if( stat( path.c_str(), &info ) != 0 ) return 0;
+  return info.st_mtime;
+}
+
+// path, size and modification time of every input file of the data,
+// accmc, genmc and bkgnd lines of a configuration, relative paths are
+// taken from the directory the fit runs in
+string inputStamps( const string& cfgText, const string& dir ){
+
+  ostringstream stamps;
+
+  istringstream lines( cfgText );
+  string line;
+  while( getline( lines, line ) ){
+
+    istringstream words( line );
+    vector< string > word;
+    string w;
+    while( words >> w ) word.push_back( w );
+
+    if( word.size() < 4 || ( word[0] != "data" && word[0] != "accmc" &&
+                             word[0] != "genmc" && word[0] != "bkgnd" ) ) continue;
+
+    // the reaction and the reader class come first
+    for( unsigned int i = 3; i < word.size(); ++i ){
+
+      string path = ( word[i][0] == '/' ? word[i] : dir + "/" + word[i] );
+
+      struct stat info;
+      if( stat( path.c_str(), &info ) != 0 || !S_ISREG( info.st_mode ) ) continue;
+
+      stamps << " " << word[i] << ":" << info.st_size << ":" << info.st_mtime;
+    }
+  }
+
+  return stamps.str();
+}
+
+string readFile( const string& path ){
+
+  ifstream in( path.c_str() );
+  stringstream text;
+  text << in.rdbuf();
+  return text.str();
+}
+
+// MemAvailable of /proc/meminfo, 0 if it cannot be read
+double availableMB(){
+
+  ifstream meminfo( "/proc/meminfo" );
+  string key, unit;
+  double kB;
+  while( meminfo >> key >> kB ){
+
+    getline( meminfo, unit );
+    if( key == "MemAvailable:" ) return kB / 1024;
+  }
+
+  return 0;
+}
+
+void replaceAll( string& text, const string& from, const string& to ){
+
+  for( size_t pos = text.find( from ); pos != string::npos;
+       pos = text.find( from, pos + to.size() ) ){
+
+    text.replace( pos, from.size(), to );
+  }
+}
+
+// the bin tags in the order of split_bins: the last index runs fastest
+vector< string > binTags( const vector< int >& nBins ){
+
+  vector< string > tags;
+  vector< int > index( nBins.size(), 0 );
+
+  while( true ){
+
+    ostringstream tag;
+    for( unsigned int i = 0; i < index.size(); ++i ) tag << ( i ? "_" : "" ) << index[i];
+    tags.push_back( tag.str() );
+
+    int axis = index.size() - 1;
+    while( axis >= 0 && ++index[axis] == nBins[axis] ) index[axis--] = 0;
+    if( axis < 0 ) break;
+  }
+
+  return tags;
+}
+
+
+/**
+ * Sets up the directory and configuration of a bin.  The input files
+ * named in the configuration are moved into the bin directory if they are
+ * still in the fit directory, as divideData.pl in the threepi_binned
+ * example does.  The hash of the configuration, the size and modification
+ * time of its input files and the fit options is written next to the fit
+ * results when a fit completes, which tells a later run whether the bin
+ * has to be fit again.
+ */
+
+void prepareBin( Bin& bin, const string& fitDir, const string& cfgTemplate,
+                 const map< string, string >& inputs, const vector< string >& fitArgs ){
+
+  string name = "bin_" + bin.tag;
+  bin.dir = fitDir + "/" + name;
+  mkdir( bin.dir.c_str(), 0755 );
+
+  bin.cfgText = cfgTemplate;
+  replaceAll( bin.cfgText, "FITNAME", name );
+  replaceAll( bin.cfgText, "NIFILE", name + ".ni" );
+
+  bin.inputMB = 0;
+  for( map< string, string >::const_iterator input = inputs.begin();
+       input != inputs.end(); ++input ){
+
+    string file = input->second + "_" + bin.tag + ".root";
+    replaceAll( bin.cfgText, input->first, file );
+
+    string split = fitDir + "/" + file;
+    string inBin = bin.dir + "/" + file;
+    if( !fileExists( inBin ) && fileExists( split ) ) rename( split.c_str(), inBin.c_str() );
+
+    bin.inputMB += fileMB( inBin );
+  }
+
+  string options;
+  for( unsigned int i = 0; i < fitArgs.size(); ++i ) options += " " + fitArgs[i];
+
+  ostringstream hash;
+  hash << hex << std::hash< string >()( bin.cfgText + inputStamps( bin.cfgText, bin.dir ) + options );
+  bin.cfgHash = hash.str();
+
+  string cfgName = bin.dir + "/" + name + ".cfg";
+  if( readFile( cfgName ) != bin.cfgText ){
+
+    ofstream cfg( cfgName.c_str() );
+    cfg << bin.cfgText;
+  }
+
+  bin.status = kPending;
+  bin.attempts = 0;
+  bin.start = 0;
+  bin.seconds = 0;
+  bin.peakMB = 0;
+}
+
+bool binComplete( const Bin& bin ){
+
+  string name = bin.dir + "/bin_" + bin.tag;
+  string marker = readFile( name + ".done" );
+
+  return fileExists( name + ".fit" ) && marker.substr( 0, marker.find( '\n' ) ) == bin.cfgHash;
+}
+
+// sends the output of the fit to its own log file
+void redirectOutput( const string& logName ){
+
+  int logFd = open( logName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+  if( logFd >= 0 ){
+
+    dup2( logFd, 1 );
+    dup2( logFd, 2 );
+    close( logFd );
+  }
+}
+
+pid_t startFit( Bin& bin, const string& fitExe, const vector< string >& fitArgs ){
+
+  string name = "bin_" + bin.tag;
+
+  vector< string > args;
+  args.push_back( fitExe );
+  args.push_back( "-c" );
+  args.push_back( name + ".cfg" );
+  args.insert( args.end(), fitArgs.begin(), fitArgs.end() );
+
+  cout << flush;
+  fflush( stdout );
+  fflush( stderr );
+
+  pid_t pid = fork();
+  if( pid < 0 ){
+
+    perror( "fork" );
+    return pid;
+  }
+
+  if( pid == 0 ){
+
+    if( chdir( bin.dir.c_str() ) != 0 ){
+
+      perror( bin.dir.c_str() );
+      _exit( 127 );
+    }
+
+    redirectOutput( name + ".log" );
+
+    vector< char* > argv;
+    for( unsigned int i = 0; i < args.size(); ++i ) argv.push_back( const_cast< char* >( args[i].c_str() ) );
+    argv.push_back( NULL );
+
+    execvp( argv[0], &(argv[0]) );
+    perror( argv[0] );
+    _exit( 127 );
+  }
+
+  bin.status = kRunning;
+  bin.start = time( NULL );
+  ++bin.attempts;
+
+  return pid;
+}
+
+// fit always exits with 0, so a fit succeeded if it wrote valid results
+bool fitSucceeded( const Bin& bin, int status ){
+
+  if( !WIFEXITED( status ) || WEXITSTATUS( status ) != 0 ) return false;
+
+  string fitFile = bin.dir + "/bin_" + bin.tag + ".fit";
+  if( !fileExists( fitFile ) || fileTime( fitFile ) < bin.start ) return false;
+
+  FitResults results( fitFile );
+  return results.valid();
+}
+
+void writeSummary( const string& summaryName, const vector< Bin >& bins ){
+
+  ofstream summary( summaryName.c_str() );
+
+  vector< string > parNames;
+  bool header = false;
+
+  for( unsigned int i = 0; i < bins.size(); ++i ){
+
+    const Bin& bin = bins[i];
+    string fitFile = bin.dir + "/bin_" + bin.tag + ".fit";
+
+    string status = ( bin.status == kFailed ? "failed" : "missing" );
+    if( bin.status == kDone ) status = "done";
+    if( bin.status == kSkipped ) status = "resumed";
+
+    if( ( bin.status != kDone && bin.status != kSkipped ) || !fileExists( fitFile ) ){
+
+      summary << bin.tag << "\t" << status << "\t" << bin.attempts << endl;
+      continue;
+    }
+
+    FitResults results( fitFile );
+    if( !results.valid() ){
+
+      summary << bin.tag << "\tinvalid\t" << bin.attempts << endl;
+      continue;
+    }
+
+    // all bins are made from one template and have the same parameters
+    if( !header ){
+
+      parNames = results.parNameList();
+
+      summary << "# bin\tstatus\tattempts\tseconds\tpeakMB\tlikelihood";
+      for( unsigned int j = 0; j < parNames.size(); ++j )
+        summary << "\t" << parNames[j] << "\t" << parNames[j] << "_err";
+      summary << endl;
+
+      header = true;
+    }
+
+    summary << bin.tag << "\t" << status << "\t" << bin.attempts << "\t"
+            << bin.seconds << "\t" << bin.peakMB << "\t"
+            << setprecision( 12 ) << results.likelihood() << setprecision( 6 );
+
+    for( unsigned int j = 0; j < parNames.size(); ++j )
+      summary << "\t" << results.parValue( parNames[j] ) << "\t" << results.parError( parNames[j] );
+    summary << endl;
+  }
+}
+
+
+int main( int argc, char* argv[] ){
+
+  string cfgTemplateName;
+  string fitDir = ".";
+  string fitExe = "fit";
+  string summaryName;
+  string cacheDir;
+  map< string, string > inputs;
+  vector< int > nBins;
+  vector< string > fitArgs;
+  unsigned int nCores = thread::hardware_concurrency();
+  double budgetMB = 0;
+  double fitMB = 0;
+  int nRetries = 1;
+  bool force = false;
+
+  for( int i = 1; i < argc; ++i ){
+
+    string arg( argv[i] );
+
+    if( arg == "--" ){
+      fitArgs.assign( argv + i + 1, argv + argc );
+      break;
+    }
+
+    if( arg == "-f" ){ force = true; continue; }
+    if( arg == "-h" || i + 1 == argc ) Usage();
+
+    string value( argv[++i] );
+    if( arg == "-c" ) cfgTemplateName = value;
+    else if( arg == "-b" ) nBins.push_back( atoi( value.c_str() ) );
+    else if( arg == "-d" ) fitDir = value;
+    else if( arg == "-D" ) inputs["DATAFILE"] = value;
+    else if( arg == "-A" ) inputs["ACCMCFILE"] = value;
+    else if( arg == "-G" ) inputs["GENMCFILE"] = value;
+    else if( arg == "-K" ) inputs["BKGNDFILE"] = value;
+    else if( arg == "-j" ) nCores = atoi( value.c_str() );
+    else if( arg == "-M" ) budgetMB = atof( value.c_str() );
+    else if( arg == "-m" ) fitMB = atof( value.c_str() );
+    else if( arg == "-R" ) nRetries = atoi( value.c_str() );
+    else if( arg == "-k" ) cacheDir = value;
+    else if( arg == "-e" ) fitExe = value;
+    else if( arg == "-o" ) summaryName = value;
+    else Usage();
+  }
+
+  if( cfgTemplateName == "" || nBins.empty() ) Usage();
+
+  // the fits run in the bin directories, so a path to the executable has
+  // to be absolute; a plain name is looked up in PATH
+  if( fitExe.find( '/' ) != string::npos ){
+
+    char* path = realpath( fitExe.c_str(), NULL );
+    if( path == NULL ){
+
+      cout << "ERROR:  cannot find the fit executable " << fitExe << endl;
+      exit( 1 );
+    }
+    fitExe = path;
+    free( path );
+  }
+  for( unsigned int i = 0; i < nBins.size(); ++i ) if( nBins[i] <= 0 ) Usage();
+  if( nCores == 0 ) nCores = 1;
+  if( summaryName == "" ) summaryName = fitDir + "/fit_bins_summary.txt";
+
+  // a fit running its randomized fits in several processes occupies
+  // that many cores
+  unsigned int coresPerFit = 1;
+  for( unsigned int i = 0; i + 1 < fitArgs.size(); ++i )
+    if( fitArgs[i] == "-j" ) coresPerFit = max( 1, atoi( fitArgs[i+1].c_str() ) );
+  if( coresPerFit > nCores ) coresPerFit = nCores;
+
+  // the caches written by the first fit of a bin are read by its
+  // retries and by later runs over the same files
+  if( cacheDir != "" ) setenv( "AMPTOOLS_KIN_CACHE", cacheDir.c_str(), 1 );
+  else setenv( "AMPTOOLS_KIN_CACHE", "1", 0 );
+  setenv( "AMPTOOLS_NI_CACHE", "1", 0 );
+
+  string cfgTemplate = readFile( cfgTemplateName );
+  if( cfgTemplate == "" ){
+
+    cout << "ERROR:  cannot read the configuration template " << cfgTemplateName << endl;
+    exit( 1 );
+  }
+
+  if( budgetMB <= 0 ) budgetMB = 0.9 * availableMB();
+
+  vector< string > tags = binTags( nBins );
+  vector< Bin > bins( tags.size() );
+  vector< unsigned int > queue;
+
+  for( unsigned int i = 0; i < bins.size(); ++i ){
+
+    bins[i].tag = tags[i];
+    prepareBin( bins[i], fitDir, cfgTemplate, inputs, fitArgs );
+
+    if( !force && binComplete( bins[i] ) ) bins[i].status = kSkipped;
+    else queue.push_back( i );
+  }
+
+  // the largest bins are started first, so that no long fit is left
+  // running alone at the end
+  stable_sort( queue.begin(), queue.end(),
+               [&bins]( unsigned int a, unsigned int b ){ return bins[a].inputMB > bins[b].inputMB; } );
+
+  cout << "Fitting " << queue.size() << " of " << bins.size() << " bins ("
+       << bins.size() - queue.size() << " complete) on " << nCores << " cores";
+  if( budgetMB > 0 ) cout << " with " << (int)budgetMB << " MB of memory";
+  cout << endl;
+
+  // the memory of a fit scales with its input, the largest ratio of peak
+  // memory to input size seen so far is used for the fits still to start
+  double mbPerInputMB = 3;
+  bool measured = false;
+
+  auto estimateMB = [&]( const Bin& bin ){
+    if( fitMB > 0 ) return fitMB;
+    return max( 100., ( measured ? 1.2 : 1. ) * mbPerInputMB * bin.inputMB );
+  };
+
+  map< pid_t, unsigned int > running;
+  map< pid_t, double > reserved;
+  double reservedMB = 0;
+  int nDone = 0;
+  int nFailed = 0;
+
+  deque< unsigned int > pending( queue.begin(), queue.end() );
+
+  while( !pending.empty() || !running.empty() ){
+
+    // start fits while there are free cores and the estimated memory of
+    // the next fit fits into the budget; with nothing running a fit is
+    // always started so that the queue cannot stall
+    while( !pending.empty() && ( running.size() + 1 ) * coresPerFit <= nCores ){
+
+      Bin& bin = bins[pending.front()];
+      double needMB = estimateMB( bin );
+
+      if( !running.empty() && budgetMB > 0 && reservedMB + needMB > budgetMB ) break;
+
+      pid_t pid = startFit( bin, fitExe, fitArgs );
+      if( pid < 0 ) break;
+
+      running[pid] = pending.front();
+      reserved[pid] = needMB;
+      reservedMB += needMB;
+      pending.pop_front();
+
+      cout << "bin_" << bin.tag << ":  started (attempt " << bin.attempts
+           << ", estimated " << (int)needMB << " MB)" << endl;
+    }
+
+    if( running.empty() ){
+
+      // fork failed with nothing running
+      cout << "ERROR:  cannot start " << fitExe << endl;
+      break;
+    }
+
+    int status;
+    struct rusage usage;
+    pid_t pid = wait4( -1, &status, 0, &usage );
+    if( pid < 0 ){
+
+      perror( "wait4" );
+      break;
+    }
+    if( running.find( pid ) == running.end() ) continue;
+
+    Bin& bin = bins[running[pid]];
+    running.erase( pid );
+    reservedMB -= reserved[pid];
+    reserved.erase( pid );
+
+    bin.seconds = difftime( time( NULL ), bin.start );
+    bin.peakMB = usage.ru_maxrss / 1024.;
+
+    if( bin.inputMB > 0 && bin.peakMB > 0 ){
+
+      double ratio = bin.peakMB / bin.inputMB;
+      if( !measured || ratio > mbPerInputMB ) mbPerInputMB = ratio;
+      measured = true;
+    }
+
+    if( fitSucceeded( bin, status ) ){
+
+      ofstream marker( ( bin.dir + "/bin_" + bin.tag + ".done" ).c_str() );
+      marker << bin.cfgHash << endl;
+
+      bin.status = kDone;
+      ++nDone;
+
+      cout << "bin_" << bin.tag << ":  done in " << bin.seconds << " s, "
+           << (int)bin.peakMB << " MB (" << nDone << " of " << queue.size() << ")" << endl;
+    }
+    else if( bin.attempts <= nRetries ){
+
+      bin.status = kPending;
+      pending.push_front( &bin - &(bins[0]) );
+
+      cout << "bin_" << bin.tag << ":  failed, see " << bin.dir << "/bin_" << bin.tag
+           << ".log, starting it again" << endl;
+    }
+    else{
+
+      bin.status = kFailed;
+      ++nFailed;
+
+      cout << "bin_" << bin.tag << ":  FAILED after " << bin.attempts << " attempts, see "
+           << bin.dir << "/bin_" << bin.tag << ".log" << endl;
+    }
+  }
+
+  writeSummary( summaryName, bins );
+
+  cout << nDone << " bins fit, " << nFailed << " failed, "
+       << bins.size() - queue.size() << " already complete; summary in " << summaryName << endl;
+
+  return ( nFailed > 0 || !pending.empty() ? 1 : 0 );
+}
@@ -21,6 +21,7 @@
 #include "AmpPlotter/PlotFactory.h"
 
 #include "AMPTOOLS_DATAIO/OmegaPiPlotGenerator.h"
+#include "AMPTOOLS_DATAIO/PlotSubsetEngine.h"
 #include "AMPTOOLS_DATAIO/ROOTDataReader.h"
 #include "AMPTOOLS_DATAIO/ROOTDataReaderBootstrap.h"
 #include "AMPTOOLS_DATAIO/ROOTDataReaderTEM.h"
@@ -52,6 +53,26 @@ void atiSetup(){
 
 using namespace std;
 
+// reflectivity of an amplitude in a sum, computed from the naturality in
+// its name (e.g. 1pps): 0 for positive, 1 for negative and -1 if the name
+// does not start with spin and parity
+int reflectivity( const string& sumName, const string& ampName ){
+
+  if( ampName.size() < 2 || ampName[0] < '0' || ampName[0] > '9' ) return -1;
+
+  int j = ampName[0]-'0';
+  int parity = 0;
+  if( ampName[1] == 'p' ) parity = +1;
+  else if( ampName[1] == 'm' ) parity = -1;
+  else return -1;
+  int naturality = parity*pow(-1,j);
+
+  if(sumName.find("ImagNegSign") != std::string::npos || sumName.find("RealPosSign") != std::string::npos)
+    return ( naturality > 0 ? 0 : 1 );
+  else
+    return ( naturality > 0 ? 1 : 0 );
+}
+
 int main( int argc, char* argv[] ){
 
 
@@ -68,6 +89,7 @@ int main( int argc, char* argv[] ){
   }
 
   bool showGui = false;
+  unsigned int nThreads = 0;
   string outName = "omegapi_plot.root";
   string resultsName(argv[1]);
   for (int i = 2; i < argc; i++){
@@ -80,10 +102,14 @@ int main( int argc, char* argv[] ){
     if (arg == "-o"){
       outName = argv[++i];
     }
+    if (arg == "-n"){
+      nThreads = atoi( argv[++i] );
+    }
     if (arg == "-h"){
       cout << endl << " Usage for: " << argv[0] << endl << endl;
       cout << "\t -o <file>\t output file path" << endl;
       cout << "\t -g <file>\t show GUI" << endl;
+      cout << "\t -n <int>\t number of threads filling the MC histograms (default: number of cores)" << endl;
       exit(1);
     }
   }
@@ -134,115 +160,84 @@ int main( int argc, char* argv[] ){
   vector<string> amphistname = {"0m0p", "1pps", "1p0s", "1pms", "1ppd", "1p0d", "1pmd", "1mpp", "1m0p", "1mmp", "2mp2p", "2mpp", "2m0p", "2mmp", "2mm2p", "2mp2f", "2mpf", "2m0f", "2mmf", "2mm2f", "3mp2f", "3mpf", "3m0f", "3mmf", "3mm2f", "0m", "1p", "1m", "2m", "3m"};
   vector<string> reflname = {"PosRefl", "NegRefl"};
 
-  // loop over sum configurations (one for each of the individual contributions, and the combined sum of all)
-  for (unsigned int irefl = 0; irefl <= reflname.size(); irefl++){
+  // set unique histogram name for each plot (could put in directories...),
+  // variables without a name are not written
+  vector<string> varname( OmegaPiPlotGenerator::kNumHists );
+  varname[OmegaPiPlotGenerator::kOmegaPiMass] = "MOmegaPi";
+  varname[OmegaPiPlotGenerator::kCosTheta] = "CosTheta";
+  varname[OmegaPiPlotGenerator::kPhi] = "Phi";
+  varname[OmegaPiPlotGenerator::kCosThetaH] = "CosTheta_H";
+  varname[OmegaPiPlotGenerator::kPhiH] = "Phi_H";
+  varname[OmegaPiPlotGenerator::kProd_Ang] = "Prod_Ang";
+  varname[OmegaPiPlotGenerator::kt] = "t";
+  varname[OmegaPiPlotGenerator::kRecoilMass] = "MRecoil";
+  varname[OmegaPiPlotGenerator::kProtonPiMass] = "MProtonPi";
+  varname[OmegaPiPlotGenerator::kRecoilPiMass] = "MRecoilPi";
+
+  // the data is plotted once, its histograms give the binning of the MC
+  cout << "Looping over input data" << endl;
+  vector< TH1* > shapes;
+  for (unsigned int ivar  = 0; ivar  < OmegaPiPlotGenerator::kNumHists; ivar++){
+
+    Histogram* hist = plotGen.projection(ivar, reactionName, PlotGenerator::kData);
+    TH1* thist = hist->toRoot();
+    shapes.push_back(thist);
+
+    if (varname[ivar].empty()) continue;
+
+    thist->SetName((varname[ivar] + "dat").c_str());
+    plotfile->cd();
+    thist->Write();
+  }
 
-    // loop over desired amplitudes 
+  // all sum and amplitude configurations of the accepted MC are filled
+  // in one pass (one for each of the individual contributions, and the
+  // combined sum of all)
+  PlotSubsetEngine engine( results, reactionName,
+                           [&plotGen]( Kinematics* kin, const string& reaction, double* values ){
+                             plotGen.projectValues( kin, values ); },
+                           shapes );
+
+  vector<string> subsetname;
+  for (unsigned int irefl = 0; irefl <= reflname.size(); irefl++){
     for (unsigned int iamp = 0; iamp <= amphistname.size(); iamp++ ) {
 
-      // turn all ampltiudes by default 
-      for (unsigned int jamp = 0; jamp < amps.size(); jamp++ ) {
-	plotGen.enableAmp( jamp );
-      }
+      string name;
+      if (irefl < reflname.size()) name += "_" + reflname[irefl];
+      if (iamp < amphistname.size()) name += "_" + amphistname[iamp];
 
-      // turn off unwanted amplitudes and sums
-      if (iamp < amphistname.size()) {
-	
-        string locampname = amphistname[iamp];
-	
-	// parse amplitude name for naturality to compute reflectivity 
-	int j = locampname[0]-'0';
-	int parity = 0;
-	if( locampname[1] == 'p' ) parity = +1;
-	else if( locampname[1] == 'm' ) parity = -1;
-	else cout<<"Undefined parity in amplitude"<<endl;
-	int naturality = parity*pow(-1,j);
-
-	// turn on all sums by default
-	for (unsigned int i = 0; i < sums.size(); i++) plotGen.enableSum(i);
-
-	// turn off unwanted sums for reflectivity (based on naturality)
-	//cout<<"refl = "<<irefl<<endl;
-	if (irefl < 2) {
-	  for (unsigned int i = 0; i < sums.size(); i++){
-	    
-	    bool disableSum = false;
-	    if(sums[i].find("ImagNegSign") != std::string::npos || sums[i].find("RealPosSign") != std::string::npos) {
-	      if (naturality>0 && irefl==1) disableSum = true;
-	      if (naturality<0 && irefl==0) disableSum = true;
-	    }
-	    else {
-	      if (naturality>0 && irefl==0) disableSum = true;
-	      if (naturality<0 && irefl==1) disableSum = true;
-	    }
-	    
-	    if(disableSum) {
-	      plotGen.disableSum(i);
-	      //cout<<"disable sum "<<sums[i]<<endl;
-	    }
-	  }
-	}
+      vector<string> subset;
+      for (unsigned int jamp = 0; jamp < engine.amplitudes().size(); jamp++ ) {
 
-	// turn off unwanted amplitudes
-        for (unsigned int jamp = 0; jamp < amps.size(); jamp++ ) {
+        // full names are reaction::sum::amplitude
+        string fullName = engine.amplitudes()[jamp];
+        size_t ampStart = fullName.rfind("::");
+        string ampName = fullName.substr(ampStart + 2);
+        string sumName = fullName.substr(0, ampStart);
 
-	  if( amps[jamp].find(locampname.data()) == std::string::npos ) {
-	    plotGen.disableAmp( jamp );
-	    //cout<<"disable amplitude "<<amps[jamp]<<endl;
-	  }
-	}
+        if (iamp < amphistname.size() && ampName.find(amphistname[iamp]) == std::string::npos) continue;
+        if (irefl < reflname.size() && reflectivity(sumName, ampName) != (int)irefl) continue;
 
+        subset.push_back(fullName);
       }
 
-      cout << "Looping over input data" << endl;
-      // loop over data, accMC, and genMC
-      for (unsigned int iplot = 0; iplot < PlotGenerator::kNumTypes; iplot++){
-	if (iplot == PlotGenerator::kGenMC || iplot == PlotGenerator::kBkgnd) continue;
-	if (irefl < reflname.size() && iamp < amphistname.size() && iplot == PlotGenerator::kData) continue; // only plot data once
-	
-	// loop over different variables
-	for (unsigned int ivar  = 0; ivar  < OmegaPiPlotGenerator::kNumHists; ivar++){
-	  
-	  // set unique histogram name for each plot (could put in directories...)
-	  string histname =  "";
-	  if (ivar == OmegaPiPlotGenerator::kOmegaPiMass)  histname += "MOmegaPi";
-	  else if (ivar == OmegaPiPlotGenerator::kCosTheta)  histname += "CosTheta";
-	  else if (ivar == OmegaPiPlotGenerator::kPhi)  histname += "Phi";
-	  else if (ivar == OmegaPiPlotGenerator::kCosThetaH)  histname += "CosTheta_H";
-	  else if (ivar == OmegaPiPlotGenerator::kPhiH)  histname += "Phi_H";
-	  else if (ivar == OmegaPiPlotGenerator::kProd_Ang)  histname += "Prod_Ang";
-	  else if (ivar == OmegaPiPlotGenerator::kt)  histname += "t";
-	  else if (ivar == OmegaPiPlotGenerator::kRecoilMass)  histname += "MRecoil";
-	  else if (ivar == OmegaPiPlotGenerator::kProtonPiMass)  histname += "MProtonPi";
-	  else if (ivar == OmegaPiPlotGenerator::kRecoilPiMass)  histname += "MRecoilPi";
-	  
-	  else continue;
-	  
-	  if (iplot == PlotGenerator::kData) histname += "dat";
-	  if (iplot == PlotGenerator::kBkgnd) histname += "bkgnd";
-	  if (iplot == PlotGenerator::kAccMC) histname += "acc";
-	  if (iplot == PlotGenerator::kGenMC) histname += "gen";
-	  
-	  if (irefl < reflname.size()){
-	    // get name of sum for naming histogram
-	    string sumName = reflname[irefl];
-	    histname += "_";
-	    histname += sumName;
-	  }
-	  if (iamp < amphistname.size()) {
-	    // get name of amp for naming histogram  
-	    histname += "_";
-	    histname += amphistname[iamp];
-	  }
-
-	  Histogram* hist = plotGen.projection(ivar, reactionName, iplot);
-	  TH1* thist = hist->toRoot();
-	  thist->SetName(histname.c_str());
-	  plotfile->cd();
-	  thist->Write();
-	  
-	}
-      }
+      subsetname.push_back(name);
+      engine.addSubset(name, subset);
+    }
+  }
+
+  cout << "Looping over accepted MC" << endl;
+  engine.fill(false, nThreads);
+
+  for (unsigned int isub = 0; isub < engine.numSubsets(); isub++){
+    for (unsigned int ivar  = 0; ivar  < OmegaPiPlotGenerator::kNumHists; ivar++){
+
+      if (varname[ivar].empty()) continue;
+
+      TH1* thist = engine.histogram(isub, ivar);
+      thist->SetName((varname[ivar] + "acc" + subsetname[isub]).c_str());
+      plotfile->cd();
+      thist->Write();
     }
   }
 
@@ -2,6 +2,7 @@
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#include <mutex>
 
 using namespace std;
 
@@ -78,8 +79,37 @@ getCoefficient(int eps, int L, int M, int l1, int m1, int l2, int m2)
 }
 
 
+namespace {
+  double
+  computeThreeJ(long j1, long j2, long j3, long m1, long m2, long m3);
+}
+
+// The same symbols are needed for many moments and wave pairs, so every
+// one is computed only once.
 double
 threeJ(long j1, long j2, long j3, long m1, long m2, long m3)
+{
+  static std::map<std::vector<long>, double> cache;
+  static std::mutex cacheMutex;
+
+  std::vector<long> key(6);
+  key[0] = j1; key[1] = j2; key[2] = j3;
+  key[3] = m1; key[4] = m2; key[5] = m3;
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+
+  std::map<std::vector<long>, double>::const_iterator it = cache.find(key);
+  if (it != cache.end())
+    return it->second;
+
+  double result = computeThreeJ(j1, j2, j3, m1, m2, m3);
+  cache[key] = result;
+  return result;
+}
+
+namespace {
+double
+computeThreeJ(long j1, long j2, long j3, long m1, long m2, long m3)
 {
 #if ROOT_VERSION_CODE >= ROOT_VERSION(5,28,0)
   return ROOT::Math::wigner_3j(2*j1, 2*j2, 2*j3, 2*m1, 2*m2, 2*m3);
@@ -128,6 +158,7 @@ threeJ(long j1, long j2, long j3, long m1, long m2, long m3)
   return prefactor(j1,j2,j3,m1,m2,m3)*sum;
 #endif
 }
+}
 
 
 // Returns the list of non-zero moments for the given waveset.
@@ -271,3 +302,77 @@ decomposeMomentError(int L, int M, const waveset& ws, const vector<double>& x, c
 
   return sqrt(resultSquare);
 }
+
+
+momentTable::momentTable(const waveset& ws, const std::vector<std::pair<size_t, size_t> >& moments)
+  : m_terms(moments.size())
+{
+  for (size_t iMom = 0; iMom < moments.size(); iMom++)
+    {
+      int L = moments[iMom].first;
+      int M = moments[iMom].second;
+
+      for (size_t iWs = 0; iWs < ws.size(); iWs++)
+	{
+	  int eps = ws[iWs].reflectivity;
+
+	  const vector<wave>& w = ws[iWs].waves;
+	  for (size_t iW1 = 0; iW1 < w.size(); iW1++)
+	    {
+	      const wave& w1 = w[iW1];
+	      for (size_t iW2 = 0; iW2 < w.size(); iW2++)
+		{
+		  const wave& w2 = w[iW2];
+		  double coeff = getCoefficient(eps, L, M, w1.l, w1.m, w2.l, w2.m);
+		  if (coeff == 0)
+		    continue;
+
+		  term t;
+		  t.idx1 = w1.getIndex();
+		  t.idx2 = w2.getIndex();
+		  t.coeff = coeff;
+		  m_terms[iMom].push_back(t);
+		}
+	    }
+	}
+    }
+}
+
+double
+momentTable::moment(size_t iMom, const vector<double>& x) const
+{
+  double result = 0;
+  const vector<term>& terms = m_terms[iMom];
+  for (size_t i = 0; i < terms.size(); i++)
+    {
+      const term& t = terms[i];
+      result += t.coeff*(x[t.idx1]*x[t.idx2] + x[t.idx1+1]*x[t.idx2+1]);
+    }
+
+  return result;
+}
+
+double
+momentTable::momentError(size_t iMom, const vector<double>& x, const vector< vector< double > >& covMat) const
+{
+  double resultSquare = 0;
+  const vector<term>& terms = m_terms[iMom];
+  for (size_t i = 0; i < terms.size(); i++)
+    {
+      const term& t = terms[i];
+
+      double re1 = x[t.idx1];
+      double im1 = x[t.idx1 + 1];
+      double re2 = x[t.idx2];
+      double im2 = x[t.idx2 + 1];
+
+      resultSquare += fabs(t.coeff)*(re2*re2*covMat[t.idx1][t.idx1]
+				     + re1*re1*covMat[t.idx2][t.idx2]
+				     + im2*im2*covMat[t.idx1 + 1][t.idx1 + 1]
+				     + im1*im1*covMat[t.idx2 + 1][t.idx2 + 1]
+				     + 2*re1*re2*covMat[t.idx1][t.idx2]
+				     + 2*im1*im2*covMat[t.idx1 + 1][t.idx2 + 1]);
+    }
+
+  return sqrt(resultSquare);
+}
@@ -35,5 +35,28 @@ double decomposeMoment(int L, int M, const waveset& ws, const double* x);
 double decomposeMomentError(const std::pair<size_t, size_t>& LM, const waveset& ws, const vector<double>& x, const vector< vector< double > >& covMat);
 double decomposeMomentError(int L, int M, const waveset& ws, const vector<double>& x, const vector< vector< double > >& covMat);
 
+// The non-zero coefficients of a list of moments for a waveset.  They are
+// computed once, so that decomposing the fit results of a bin is only a
+// sum over the coupled wave pairs, with the same result as
+// decomposeMoment and decomposeMomentError.
+class momentTable
+{
+ public:
+  momentTable(const waveset& ws, const std::vector<std::pair<size_t, size_t> >& moments);
+
+  size_t size() const { return m_terms.size(); }
+
+  double moment(size_t iMom, const vector<double>& x) const;
+  double momentError(size_t iMom, const vector<double>& x, const vector< vector< double > >& covMat) const;
+
+ private:
+  struct term {
+    size_t idx1, idx2;
+    double coeff;
+  };
+
+  std::vector< std::vector<term> > m_terms;
+};
+
 
 #endif
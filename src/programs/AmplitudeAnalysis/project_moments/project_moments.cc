@@ -7,6 +7,8 @@
 #include <cassert>
 #include <cstdlib>
 #include <unistd.h>
+#include <thread>
+#include <atomic>
 
 #include "IUAmpTools/FitResults.h"
 
@@ -28,6 +30,7 @@ int main( int argc, char* argv[] ){
   
   string outfileName("moments.root");
   bool print = false;
+  unsigned int nThreads = thread::hardware_concurrency();
 
   // parse command line
   
@@ -43,11 +46,15 @@ int main( int argc, char* argv[] ){
       else  outfileName = argv[++i]; }
     if (arg == "-p")  
       print = true;
+    if (arg == "-n"){  
+      if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+      else  nThreads = atoi(argv[++i]); }
     if (arg == "-h"){
       cout << endl << " Usage for: " << argv[0] << endl << endl;
       cout << "(optional) -f <fit dir>\t : Fit Directory" << endl;
       cout << "(optional) -o <file>\t : Output file (default: moments.root)" << endl;
       cout << "(optional) -p\t\t : Print equations" << endl;
+      cout << "(optional) -n <int>\t : Number of threads (default: number of cores)" << endl;
       exit(1);}
   }
   
@@ -144,38 +151,64 @@ int main( int argc, char* argv[] ){
   TFile *outfile = new TFile(outfileName.c_str(), "recreate");
   if (!outfile->IsOpen()) exit(1);
 
-  // descend into the directory that contains the bins
-  chdir( fitDir.c_str() );
-  
+  // The coefficients of all moments are computed once, then the bins are
+  // shared between the threads.  The histograms are filled afterwards.
+  momentTable table(ws, vecMom);
+
+  if (nThreads < 1) nThreads = 1;
+
+  vector<char> validBin(kNumBins, false);
+  vector< vector<double> > value(kNumBins), error(kNumBins);
+  atomic<int> nextBin(0);
+  atomic<bool> wrongWaveset(false);
+
+  auto projectBins = [&](){
+    int i;
+    while( ( i = nextBin++ ) < kNumBins ){
+
+      ostringstream resultsFile;
+      resultsFile << fitDir << "/bin_" << i << "/bin_" << i << ".fit";
+
+      FitResults results( resultsFile.str() );
+      if( !results.valid() )
+	continue;
+
+      vector<double> x = results.parValueList();
+      if (  2*ws.getNwaves() != x.size() ){
+	wrongWaveset = true;
+	continue;
+      }
+
+      vector< vector<double> > covMat = results.errorMatrix();
+      for (size_t iMom = 0; iMom < table.size(); iMom++)
+	{
+	  value[i].push_back(table.moment(iMom, x));
+	  error[i].push_back(table.momentError(iMom, x, covMat));
+	}
+      validBin[i] = true;
+    }
+  };
+
+  vector<thread> threads;
+  for (unsigned int t = 0; t < nThreads; t++) threads.push_back(thread(projectBins));
+  for (unsigned int t = 0; t < threads.size(); t++) threads[t].join();
+
+  if (wrongWaveset){
+    cout << "Different number of waves in fit result. Check waveset!" << endl;
+    outfile->Close();
+    exit(1);
+  }
+
   for( int i = 0; i < kNumBins; ++i ){
-    
-    ostringstream dir;
-    dir << "bin_" << i;
-    chdir( dir.str().c_str() );
-    
-    ostringstream resultsFile;
-    resultsFile << "bin_" << i << ".fit";
-    
-    FitResults results( resultsFile.str() );
-    if( !results.valid() ){
-      
-      chdir( ".." );
+
+    if( !validBin[i] )
       continue;
-    }
 
-    if (  2*ws.getNwaves() != results.parValueList().size() ){
-      cout << "Different number of waves in fit result. Check waveset!" << endl;
-      outfile->Close();
-      exit(1);
-    }
-    
-    for (std::vector<std::pair<size_t, size_t> >::const_iterator it = vecMom.begin(); it != vecMom.end(); it++)
+    for (size_t iMom = 0; iMom < vecMom.size(); iMom++)
       {
-	hMoments[*it]->SetBinContent(i + 1, decomposeMoment(*it, ws, results.parValueList()));
-	hMoments[*it]->SetBinError(i + 1, decomposeMomentError(*it, ws, results.parValueList(), results.errorMatrix()));
+	hMoments[vecMom[iMom]]->SetBinContent(i + 1, value[i][iMom]);
+	hMoments[vecMom[iMom]]->SetBinError(i + 1, error[i][iMom]);
       }
-    
-    chdir( ".." );
   }
   
   
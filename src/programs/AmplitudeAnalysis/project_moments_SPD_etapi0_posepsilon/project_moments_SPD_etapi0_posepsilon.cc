@@ -7,6 +7,8 @@
 #include <cassert>
 #include <cstdlib>
 #include <unistd.h>
+#include <thread>
+#include <atomic>
 
 #include "IUAmpTools/FitResults.h"
 
@@ -33,6 +35,7 @@ int main( int argc, char* argv[] ){
     // set default parameters
     
     string outfileName("");
+    unsigned int nThreads = thread::hardware_concurrency();
     
     // parse command line
     
@@ -43,9 +46,13 @@ int main( int argc, char* argv[] ){
         if (arg == "-o"){
             if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
             else  outfileName = argv[++i]; }
+        if (arg == "-n"){
+            if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+            else  nThreads = atoi(argv[++i]); }
         if (arg == "-h"){
             cout << endl << " Usage for: " << argv[0] << endl << endl;
             cout << "\t -o <file>\t Ouput text file" << endl;
+            cout << "\t -n <int>\t Number of threads (default: number of cores)" << endl;
             exit(1);}
     }
     
@@ -76,19 +83,23 @@ int main( int argc, char* argv[] ){
 
 
 
-    // descend into the directory that contains the bins
-    chdir( fitDir.c_str() );
-    
-    for( int i = 0; i < kNumBins;i++ ){
-      for( int j = 0; j < kNumBinst; j++ ){  
-	cout<<"bin "<<i<<"_"<<j<<endl;
-        
-        ostringstream dir;
-        dir << "bin_" << i<<"_"<<j;
-        chdir( dir.str().c_str() );
-        
+    // the bins are read in parallel and written out in order
+    if (nThreads < 1) nThreads = 1;
+
+    vector<string> lines(kNumBins*kNumBinst);
+    atomic<int> nextBin(0);
+
+    auto projectBins = [&](){
+      int bin;
+      while( ( bin = nextBin++ ) < kNumBins*kNumBinst ){
+
+        int i = bin / kNumBinst;
+        int j = bin % kNumBinst;
+
+        ostringstream outfile;
+
         ostringstream resultsFile;
-        resultsFile << "bin_" << i <<"_"<<j<<".fit";
+        resultsFile << fitDir << "/bin_" << i<<"_"<<j << "/bin_" << i <<"_"<<j<<".fit";
         
      
 
@@ -100,7 +111,7 @@ int main( int argc, char* argv[] ){
 	  outfile <<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"
 		  <<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"
 		  <<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<"\t"<<0<<endl;            
-            chdir( ".." );
+            lines[bin] = outfile.str();
             continue;
         }
         
@@ -147,10 +158,18 @@ int main( int argc, char* argv[] ){
 
         outfile << endl;
 
-	//	if( i==44 && j==3) cout <<" H0_11= "<<H0_11.first<<"   "<<H1_11.first<<endl;
+        lines[bin] = outfile.str();
+      }
+    };
 
-        
-        chdir( ".." );
+    vector<thread> threads;
+    for (unsigned int t = 0; t < nThreads; t++) threads.push_back(thread(projectBins));
+    for (unsigned int t = 0; t < threads.size(); t++) threads[t].join();
+
+    for( int i = 0; i < kNumBins;i++ ){
+      for( int j = 0; j < kNumBinst; j++ ){  
+	cout<<"bin "<<i<<"_"<<j<<endl;
+        outfile << lines[i*kNumBinst + j];
     }
     }
     return 0;
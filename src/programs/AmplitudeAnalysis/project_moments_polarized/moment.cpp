@@ -198,12 +198,74 @@ std::complex<double> decomposeMoment(int alpha ,double L, double M, const wavese
 
 
 
+momentProjector::momentProjector(const waveset& ws, int maxAlpha, size_t maxL)
+  : m_maxAlpha(maxAlpha), m_maxL(maxL), m_terms((maxAlpha+1)*(maxL+1)*(maxL+1))
+{
+  std::complex<double> ui (0., 1.);
 
+  for (int alpha = 0; alpha <= maxAlpha; alpha++)
+  for (int L = 0; L <= int(maxL); L++)
+  for (int M = 0; M <= L; M++)
+    {
+      for (size_t iWs = 0; iWs < ws.size(); iWs++)
+	{
+	  double eps = ws[iWs].reflectivity;
 
+	  const vector<wave>& w = ws[iWs].waves;
+	  for (size_t iW1 = 0; iW1 < w.size(); iW1++)
+	    {
+	      const wave& w1 = w[iW1];
+	      for (size_t iW2 = 0; iW2 < w.size(); iW2++)
+		{
+		  const wave& w2 = w[iW2];
+
+		  // the same coefficients as in decomposeMoment
+		  double com_coeff=sqrt((2.*w2.l+1.)/(2.*w1.l+1.))*clebsch(w2.l,L,w1.l,0.,0.,0.);
+		  if (com_coeff == 0) continue;
+
+		  std::complex<double> coeff;
+		  if (alpha==0)
+		    coeff = clebsch(w2.l,L,w1.l,w2.m,M,w1.m) + pow(-1.,w2.m-w1.m)*clebsch(w2.l,L,w1.l,-w2.m,M,-w1.m);
+		  else if (alpha==1)
+		    coeff = (-eps)*pow(-1.,w1.m)*clebsch(w2.l,L,w1.l,w2.m,M,-w1.m) + (-eps)*pow(-1.,w2.m)*clebsch(w2.l,L,w1.l,-w2.m,M,w1.m);
+		  else if (alpha==2)
+		    coeff = (-ui*eps)*pow(-1.,-w1.m)*clebsch(w2.l,L,w1.l,w2.m,M,-w1.m) + (ui*eps)*pow(-1.,-w2.m)*clebsch(w2.l,L,w1.l,-w2.m,M,w1.m);
+		  else
+		    coeff = clebsch(w2.l,L,w1.l,w2.m,M,w1.m) - pow(-1.,w2.m-w1.m)*clebsch(w2.l,L,w1.l,-w2.m,M,-w1.m);
+
+		  coeff *= com_coeff;
+		  if (alpha>0) coeff = -coeff;
+		  if (coeff == 0.) continue;
+
+		  term t;
+		  t.idx1 = w1.getIndex();
+		  t.idx2 = w2.getIndex();
+		  t.coeff = coeff;
+		  m_terms[index(alpha, L, M)].push_back(t);
+		}
+	    }
+	}
+    }
+}
 
 
 
 
+std::complex<double> momentProjector::moment(int alpha, int L, int M, const double* x) const
+{
+  std::complex<double> result(0.,0.);
+  if (alpha < 0 || alpha > m_maxAlpha || L < 0 || L > int(m_maxL) || M < 0 || M > L) return result;
 
+  const vector<term>& terms = m_terms[index(alpha, L, M)];
+  for (size_t i = 0; i < terms.size(); i++)
+    {
+      const term& t = terms[i];
 
+      // x1 * conj(x2), the ll'* of decomposeMoment
+      std::complex<double> llprimeconj(x[t.idx1]*x[t.idx2] + x[t.idx1+1]*x[t.idx2+1],
+				       x[t.idx1+1]*x[t.idx2] - x[t.idx1]*x[t.idx2+1]);
+      result += t.coeff*llprimeconj;
+    }
 
+  return result;
+}
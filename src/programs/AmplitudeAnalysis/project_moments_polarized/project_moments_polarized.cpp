@@ -16,6 +16,8 @@
 #include <complex>
 #include <string>
 #include <time.h>
+#include <thread>
+#include <atomic>
 
 #include "IUAmpTools/FitResults.h"
 #include "TFile.h"
@@ -43,6 +45,7 @@ int main( int argc, char* argv[] ){
     // set default parameters
     
     string outfileName("");
+    unsigned int nThreads = thread::hardware_concurrency();
     
     // parse command line
     
@@ -53,9 +56,13 @@ int main( int argc, char* argv[] ){
         if (arg == "-o"){
             if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
             else  outfileName = argv[++i]; }
+        if (arg == "-n"){
+            if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+            else  nThreads = atoi(argv[++i]); }
         if (arg == "-h"){
             cout << endl << " Usage for: " << argv[0] << endl << endl;
             cout << "\t -o <file>\t Ouput text file" << endl;
+            cout << "\t -n <int>\t Number of threads (default: number of cores)" << endl;
             exit(1);}
     }
     
@@ -123,59 +130,61 @@ positive.push_back(wave("G1+", 4, 1));
 
 
 
-    // descend into the directory that contains the bins
-    chdir( fitDir.c_str() );
+    // the coefficients of the moments are computed once, then the bins
+    // are shared between the threads and written out in order
+    momentProjector projector(ws, 1, LMAX);
 
+    if (nThreads < 1) nThreads = 1;
 
+    vector<string> lines(kNumBins*kNumBinst);
+    atomic<int> nextBin(0);
+
+    auto projectBins = [&](){
+      int bin;
+      while( ( bin = nextBin++ ) < kNumBins*kNumBinst ){
+
+        int i = bin / kNumBinst;
+        int j = bin % kNumBinst;
 
-    //Looping through M_eta_pi and t bins
-    for( int i = 0; i < kNumBins;i++ ){
-      for( int j = 0; j < kNumBinst; j++ ){  
-	cout<<"bin "<<i<<"_"<<j<<endl;
-        
-        ostringstream dir;
-        dir << "bin_" << i<<"_"<<j;
-        chdir( dir.str().c_str() );
-        
         string resultsFile;
-        resultsFile ="bin_" + std::to_string(i)+"_"+ std::to_string(j)+".fit";
+        resultsFile = fitDir + "/bin_" + std::to_string(i)+"_"+ std::to_string(j) + "/bin_" + std::to_string(i)+"_"+ std::to_string(j)+".fit";
         FitResults results(resultsFile);
-	
 
-	if( !results.valid() ){
-	  outfile<< lowMass + step * i + step / 2. << "\t";
-	  outfile<< lowt + stept * j + stept / 2. << "\t";
-	  for (int L = 0; L<= pow(LMAX,1); L++) {// calculating moments and writing to a file
-	    for (int M = 0; M<= L; M++) {
-     
-	      outfile << 0<< "\t"<< 0 <<"\t";
-	      outfile << 0<< "\t"<< 0 <<"\t";
-	    }}
-	  outfile << endl;
+        ostringstream line;
 
-	  chdir( ".." );   
-	  continue;
-        }
+        // print out the bin center
+        line << lowMass + step * i + step / 2. << "\t";
+        line << lowt + stept * j + stept / 2. << "\t";
 
+        vector<double> x;
+        if( results.valid() ) x = results.parValueList();
 
+        for (int L = 0; L<= int(LMAX); L++) {// calculating moments and writing to a file
+        for (int M = 0; M<= L; M++) {
 
-        
-        // print out the bin center
-        outfile << lowMass + step * i + step / 2. << "\t";
-	outfile << lowt + stept * j + stept / 2. << "\t";
-  
-  
-    for (int L = 0; L<= pow(LMAX,1); L++) {// calculating moments and writing to a file
-    for (int M = 0; M<= L; M++) {
-     
-      outfile << real(decomposeMoment(0, L, M, ws, results.parValueList()))<< "\t"<< 0 <<"\t";
-      outfile << real(decomposeMoment(1, L, M, ws, results.parValueList()))<< "\t"<< 0 <<"\t";
-      // if(L==0 && M==0 && i==44 && j==3)cout <<" H0_00=  "<< real(decomposeMoment(0, L, M, ws, results.parValueList()))<<" H1_00=  "<< real(decomposeMoment(1, L, M, ws, results.parValueList()))<<" H2_00=  "<< decomposeMoment(2, L, M, ws, results.parValueList())<<endl;
+          if( x.empty() ){
+            line << 0<< "\t"<< 0 <<"\t";
+            line << 0<< "\t"<< 0 <<"\t";
+            continue;
+          }
 
+          line << real(projector.moment(0, L, M, x))<< "\t"<< 0 <<"\t";
+          line << real(projector.moment(1, L, M, x))<< "\t"<< 0 <<"\t";
         }}
-        outfile << endl;
-        
-        chdir( ".." );
+
+        lines[bin] = line.str();
+      }
+    };
+
+    vector<thread> threads;
+    for (unsigned int t = 0; t < nThreads; t++) threads.push_back(thread(projectBins));
+    for (unsigned int t = 0; t < threads.size(); t++) threads[t].join();
+
+    //Looping through M_eta_pi and t bins
+    for( int i = 0; i < kNumBins;i++ ){
+      for( int j = 0; j < kNumBinst; j++ ){  
+	cout<<"bin "<<i<<"_"<<j<<endl;
+        outfile << lines[i*kNumBinst + j] << endl;
     }
     }
 
@@ -0,0 +1,394 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "AMPTOOLS_DATAIO/ROOTDataReader.h"
+#include "AMPTOOLS_DATAIO/ROOTDataWriter.h"
+
+#include "TLorentzVector.h"
+#include "TROOT.h"
+
+using namespace std;
+
+#define DEFTREENAME "kin"
+
+void Usage()
+{
+  cout << "Usage:\n  split_bins <infile> <outputBase> <axis> <low> <high> <nBins> [<axis> <low> <high> <nBins> ...] [OPTIONS]\n\n";
+  cout << "  Splits the input into bins of one or more of the axes\n";
+  cout << "     mass  : invariant mass of all particles after the recoil\n";
+  cout << "     t     : -t computed from the recoil (second particle)\n";
+  cout << "     ebeam : beam energy\n";
+  cout << "  in a single pass.  The output files are named <outputBase>_<i>[_<j>...].root\n";
+  cout << "  with one index per axis, in the order the axes are given.\n\n";
+  cout << "  Options: \n";
+  cout << "   -M [maxEvents] : Limit total number of events\n";
+  cout << "   -T [treeName]  : Overwrites the default ROOT tree name (\"kin\") in output and/or input files\n";
+  cout << "                    To specify input and output names delimit with \':\' ex. -T inKin:outKin\n";
+  cout << "   -t [treeName]  : Update existing files with new tree, instead of overwriting.\n";
+  cout << "   -n [nThreads]  : Number of threads that fill and compress the output (default 4)\n";
+  exit(1);
+}
+
+
+pair <string,string> GetTreeNames(char* treeArg)
+{
+  pair <string,string> treeNames(DEFTREENAME,"");
+  string treeArgStr(treeArg);
+  size_t delimPos=treeArgStr.find(':',1);
+
+  if (delimPos != string::npos){
+    treeNames.first=treeArgStr.substr(0,delimPos);
+    treeNames.second=treeArgStr.substr(delimPos+1);
+  }else
+    treeNames.second=treeArgStr;
+
+  return treeNames;
+}
+
+
+enum AxisType { kMass, kT, kEBeam };
+
+struct Axis {
+
+  AxisType type;
+  string name;
+  double low;
+  double high;
+  int nBins;
+};
+
+double axisValue( AxisType type, const vector< TLorentzVector >& fs ){
+
+  switch( type ){
+
+    case kMass: {
+
+      // the first two entries in this list are the beam and the recoil
+      TLorentzVector x;
+      for( unsigned int i = 2; i < fs.size(); ++i ) x += fs[i];
+      return x.M();
+    }
+    case kT: {
+
+      TLorentzVector target( 0, 0, 0, 0.938272046 );
+      return -1 * ( fs[1] - target ).M2();
+    }
+    case kEBeam:
+      return fs[0].E();
+  }
+
+  return 0;
+}
+
+
+/**
+ * Events of each bin are collected in memory and handed to a pool of
+ * threads in batches.  A bin is only ever processed by one thread at a
+ * time, so its batches are written in order, while different bins are
+ * filled and compressed in parallel.  The reading thread waits whenever
+ * too many events are queued, which bounds the memory use independent
+ * of the number of bins.
+ */
+
+class BinWriterPool {
+
+public:
+
+  enum { kBatchSize = 5000, kMaxQueued = 200000 };
+
+  BinWriterPool( vector< ROOTDataWriter* >& writers, unsigned int nThreads ) :
+    m_writers( writers ),
+    m_buffers( writers.size() ),
+    m_pending( writers.size() ),
+    m_scheduled( writers.size(), false ),
+    m_queued( 0 ),
+    m_done( false )
+  {
+    for( unsigned int i = 0; i < nThreads; ++i )
+      m_threads.push_back( thread( &BinWriterPool::work, this ) );
+  }
+
+  // takes ownership of the event
+  void add( unsigned int bin, Kinematics* event ){
+
+    m_buffers[bin].push_back( event );
+    if( m_buffers[bin].size() >= kBatchSize ) submit( bin );
+  }
+
+  void finish(){
+
+    for( unsigned int bin = 0; bin < m_buffers.size(); ++bin ){
+
+      if( !m_buffers[bin].empty() ) submit( bin );
+    }
+
+    {
+      lock_guard< mutex > lock( m_mutex );
+      m_done = true;
+    }
+    m_binReady.notify_all();
+
+    for( unsigned int i = 0; i < m_threads.size(); ++i ) m_threads[i].join();
+    m_threads.clear();
+  }
+
+private:
+
+  void submit( unsigned int bin ){
+
+    unique_lock< mutex > lock( m_mutex );
+    m_batchDone.wait( lock, [this]{ return m_queued < kMaxQueued; } );
+
+    m_queued += m_buffers[bin].size();
+    m_pending[bin].push_back( vector< Kinematics* >() );
+    m_pending[bin].back().swap( m_buffers[bin] );
+
+    if( !m_scheduled[bin] ){
+
+      m_scheduled[bin] = true;
+      m_readyBins.push_back( bin );
+      m_binReady.notify_one();
+    }
+  }
+
+  void work(){
+
+    unique_lock< mutex > lock( m_mutex );
+
+    while( true ){
+
+      m_binReady.wait( lock, [this]{ return m_done || !m_readyBins.empty(); } );
+      if( m_readyBins.empty() ) break;
+
+      unsigned int bin = m_readyBins.front();
+      m_readyBins.pop_front();
+
+      // write every batch of this bin, including those that
+      // arrive while writing
+      while( !m_pending[bin].empty() ){
+
+        vector< Kinematics* > batch;
+        batch.swap( m_pending[bin].front() );
+        m_pending[bin].pop_front();
+
+        lock.unlock();
+
+        for( unsigned int i = 0; i < batch.size(); ++i ){
+
+          m_writers[bin]->writeEvent( *batch[i] );
+          delete batch[i];
+        }
+
+        lock.lock();
+        m_queued -= batch.size();
+        m_batchDone.notify_all();
+      }
+
+      m_scheduled[bin] = false;
+    }
+  }
+
+  vector< ROOTDataWriter* >& m_writers;
+
+  // only used by the reading thread
+  vector< vector< Kinematics* > > m_buffers;
+
+  // protected by m_mutex
+  mutex m_mutex;
+  condition_variable m_binReady;
+  condition_variable m_batchDone;
+  vector< deque< vector< Kinematics* > > > m_pending;
+  vector< bool > m_scheduled;
+  deque< unsigned int > m_readyBins;
+  unsigned int m_queued;
+  bool m_done;
+
+  vector< thread > m_threads;
+};
+
+
+int main( int argc, char* argv[] ){
+
+  unsigned int maxEvents = 4294967000; //close to 4byte int range
+
+  pair <string,string> treeNames(DEFTREENAME,DEFTREENAME);
+
+  bool recreate=true;
+  unsigned int nThreads = 4;
+
+  if( argc < 7 ) Usage();
+
+  string outBase( argv[2] );
+
+  vector< Axis > axes;
+
+  int i = 3;
+  while( i < argc && argv[i][0] != '-' ){
+
+    if( i + 3 >= argc ) Usage();
+
+    Axis axis;
+    axis.name = argv[i];
+    if( axis.name == "mass" ) axis.type = kMass;
+    else if( axis.name == "t" ) axis.type = kT;
+    else if( axis.name == "ebeam" ) axis.type = kEBeam;
+    else Usage();
+
+    axis.low = atof( argv[i+1] );
+    axis.high = atof( argv[i+2] );
+    axis.nBins = atoi( argv[i+3] );
+    if( axis.nBins < 1 || axis.high <= axis.low ) Usage();
+
+    axes.push_back( axis );
+    i += 4;
+  }
+
+  if( axes.empty() ) Usage();
+
+  for( ; i < argc; ++i ){
+    string arg=argv[i];
+    if (arg == "-t"){
+      if ((i+1 == argc) || (argv[i+1][0] == '-')) Usage();
+      else{
+	treeNames = GetTreeNames(argv[++i]);
+	recreate=false;
+      }
+    }else if (arg == "-T"){
+      if ((i+1 == argc) || (argv[i+1][0] == '-')) Usage();
+      else{
+	treeNames = GetTreeNames(argv[++i]);
+	recreate=true;
+      }
+    }else if (arg == "-M"){
+      if ((i+1 == argc) || (argv[i+1][0] == '-')) Usage();
+      else maxEvents = atoi( argv[++i] );
+    }else if (arg == "-n"){
+      if ((i+1 == argc) || (argv[i+1][0] == '-')) Usage();
+      else nThreads = atoi( argv[++i] );
+    }
+    else Usage();
+  }
+
+  if( nThreads < 1 ) nThreads = 1;
+
+  enum { kMaxBins = 10000 };
+
+  int numBins = 1;
+  for( unsigned int a = 0; a < axes.size(); ++a ) numBins *= axes[a].nBins;
+  assert( numBins <= kMaxBins );
+
+  // the writers are filled from several threads
+  ROOT::EnableThreadSafety();
+
+  vector< string > dataReaderArgs;
+  dataReaderArgs.push_back( argv[1] );
+  dataReaderArgs.push_back( treeNames.first );
+
+  // open reader
+  ROOTDataReader in( dataReaderArgs );
+
+  // the pool below already fills the trees in parallel, so the writers
+  // do not start threads of their own
+  ROOTWriterSettings writerSettings = ROOTWriterSettings::fromEnvironment();
+  writerSettings.setAsync( false );
+
+  vector< ROOTDataWriter* > outFile( numBins );
+  vector< int > events( numBins, 0 );
+  vector< double > sum( numBins * axes.size(), 0 );
+
+  for( int bin = 0; bin < numBins; ++bin ){
+
+    // the last axis runs fastest
+    ostringstream outName;
+    outName << outBase;
+    for( unsigned int a = 0, stride = numBins; a < axes.size(); ++a ){
+
+      stride /= axes[a].nBins;
+      outName << "_" << ( bin / stride ) % axes[a].nBins;
+    }
+    outName << ".root";
+
+    outFile[bin] = new ROOTDataWriter( outName.str(),
+				       treeNames.second.c_str(),
+				       recreate, in.hasWeight(), writerSettings );
+  }
+
+  BinWriterPool pool( outFile, nThreads );
+
+  unsigned int eventCount = 0;
+  vector< double > value( axes.size() );
+
+  Kinematics* event;
+  // check the count first, so no event is read that is not used
+  while( eventCount < maxEvents && ( event = in.getEvent() ) != NULL ){
+
+    ++eventCount;
+
+    const vector< TLorentzVector >& fs = event->particleList();
+
+    int bin = 0;
+    for( unsigned int a = 0; a < axes.size(); ++a ){
+
+      value[a] = axisValue( axes[a].type, fs );
+
+      int axisBin = static_cast< int >( floor( ( value[a] - axes[a].low ) /
+                                               ( axes[a].high - axes[a].low ) *
+                                               axes[a].nBins ) );
+      if( axisBin < 0 || axisBin >= axes[a].nBins ){
+
+        bin = -1;
+        break;
+      }
+
+      bin = bin * axes[a].nBins + axisBin;
+    }
+
+    if( bin < 0 ){
+
+      delete event;
+      continue;
+    }
+
+    ++events[bin];
+    for( unsigned int a = 0; a < axes.size(); ++a ) sum[bin*axes.size()+a] += value[a];
+
+    pool.add( bin, event );
+  }
+
+  pool.finish();
+
+  // closing the files writes the last baskets, also in parallel
+  vector< thread > closers;
+  for( unsigned int t = 0; t < nThreads; ++t ){
+
+    closers.push_back( thread( [&outFile, t, nThreads]{
+          for( unsigned int bin = t; bin < outFile.size(); bin += nThreads )
+            delete outFile[bin]; } ) );
+  }
+  for( unsigned int t = 0; t < closers.size(); ++t ) closers[t].join();
+
+  for( int bin = 0; bin < numBins; ++bin ){
+
+    printf( "bin %4i  %10i events", bin, events[bin] );
+    for( unsigned int a = 0; a < axes.size(); ++a ){
+
+      printf( "  mean %s %.3f", axes[a].name.c_str(),
+              events[bin] > 0 ? sum[bin*axes.size()+a] / events[bin] : 0 );
+    }
+    printf( "\n" );
+  }
+
+  return 0;
+}
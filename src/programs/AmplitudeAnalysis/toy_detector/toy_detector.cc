@@ -7,55 +7,225 @@
 #include <cassert>
 #include <utility>
 #include <cstdlib>
+#include <thread>
+#include <mutex>
 
 #include "IUAmpTools/Kinematics.h"
-#include "AMPTOOLS_DATAIO/ROOTDataReader.h"
+#include "AMPTOOLS_DATAIO/ROOTColumnReader.h"
 #include "AMPTOOLS_DATAIO/ROOTDataWriter.h"
 
-#include "CLHEP/Vector/LorentzVector.h"
-
-#include "TRandom.h"
+#include "TLorentzVector.h"
+#include "TRandom3.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TROOT.h"
 
 using namespace std;
-using namespace CLHEP;
 
-int main( int argc, char* argv[] ){
-  
-  string treeName( "kin" );
-  
-	if( argc < 3 ){
-		
-		cout << "Usage:  toy_detector <infile> <outfile>" << endl;
-		return 1;
-	}
-	
-  vector< string > dataReaderArgs;
-  dataReaderArgs.push_back( argv[1] );
-  dataReaderArgs.push_back( treeName );
-  
-	ROOTDataReader in(  dataReaderArgs );
-  ROOTDataWriter out( argv[2] );
-	
-  Kinematics* event;
-  while( ( event = in.getEvent() ) != NULL ){
-    
-    vector< HepLorentzVector > fs = event->particleList();
-
-    HepLorentzVector x;
+void Usage(){
+
+  cout << "Usage:  toy_detector <infile> <outfile> [<infile> <outfile> ...] [OPTIONS]" << endl << endl;
+  cout << "  Keeps the events of each input file with a probability rising linearly with the" << endl;
+  cout << "  mass of all particles after the recoil (100% at 3 GeV) and writes them to the" << endl;
+  cout << "  output file that follows it." << endl << endl;
+  cout << "  Options:" << endl;
+  cout << "   -s [seed]     : Random seed (default 1), the result does not depend on -n" << endl;
+  cout << "   -n [nThreads] : Number of files processed at the same time (default 1)" << endl;
+  cout << "   -g            : Also write all events to <outfile>_gen.root in the same pass" << endl;
+  exit( 1 );
+}
+
+struct FilePair {
+
+  string input;
+  string accepted;
+  string generated;
+};
+
+// a seed for every block of every file, so that the decisions do not
+// depend on the order in which files and blocks are processed
+unsigned int blockSeed( unsigned int seed, unsigned int file, Long64_t block ){
+
+  unsigned long long x = seed + 0x9E3779B97F4A7C15ULL * ( file + 1 ) + 0xBF58476D1CE4E5B9ULL * ( block + 1 );
+  x = ( x ^ ( x >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+  x = ( x ^ ( x >> 27 ) ) * 0x94D049BB133111EBULL;
+  x = x ^ ( x >> 31 );
+
+  // TRandom3 treats 0 as a request for a time based seed
+  unsigned int s = x & 0xFFFFFFFF;
+  return ( s == 0 ? 1 : s );
+}
+
+/**
+ * The input is read in blocks of ROOTColumnReader::kBlockSize entries.
+ * For each block the masses are computed first, the random numbers are
+ * drawn in one call from a generator seeded for that block and only then
+ * are the accepted events written.  The writers fill and compress the
+ * output trees on their own threads.
+ */
+
+Long64_t processFile( const FilePair& files, unsigned int fileIndex, unsigned int seed ){
+
+  TFile* inFile = TFile::Open( files.input.c_str() );
+  if( inFile == NULL || inFile->IsZombie() ){
+
+    cout << "ERROR:  cannot open " << files.input << endl;
+    delete inFile;
+    return -1;
+  }
+
+  TTree* inTree = (TTree*)inFile->Get( "kin" );
+  if( inTree == NULL ){
+
+    cout << "ERROR:  no tree kin in " << files.input << endl;
+    inFile->Close();
+    delete inFile;
+    return -1;
+  }
+
+  ROOTColumnReader columns( inTree );
+
+  ROOTWriterSettings settings = ROOTWriterSettings::fromEnvironment();
+  settings.setAsync( true );
+
+  ROOTDataWriter accepted( files.accepted, "kin", true, columns.hasWeight(), settings );
+  ROOTDataWriter* generated = NULL;
+  if( files.generated != "" )
+    generated = new ROOTDataWriter( files.generated, "kin", true, columns.hasWeight(), settings );
+
+  TRandom3 random;
+  vector< double > mass( ROOTColumnReader::kBlockSize );
+  vector< double > uniform( ROOTColumnReader::kBlockSize );
+  vector< TLorentzVector > particles;
+
+  Long64_t numAccepted = 0;
+
+  for( Long64_t first = 0; first < columns.numEntries(); first += ROOTColumnReader::kBlockSize ){
+
+    columns.readEntry( first );
+
+    Long64_t remaining = columns.numEntries() - first;
+    int n = ( remaining < ROOTColumnReader::kBlockSize ? remaining : (Long64_t)ROOTColumnReader::kBlockSize );
+
     // the first two entries in this list are the beam and the recoil
     // skip them in computing the mass
-		for( vector< HepLorentzVector >::iterator particle = fs.begin() + 2;
-        particle != fs.end(); ++particle ){
-			
-			x += *particle;
-		}
-
-    // an acceptance that is linearly rising with mass
-    if( x.m() > drand48() * 3 )
-      out.writeEvent( *event );
-    
-    delete event;
+    for( int i = 0; i < n; ++i ){
+
+      columns.particleList( first + i, particles );
+
+      TLorentzVector x;
+      for( unsigned int j = 2; j < particles.size(); ++j ) x += particles[j];
+      mass[i] = x.M();
+    }
+
+    random.SetSeed( blockSeed( seed, fileIndex, first / ROOTColumnReader::kBlockSize ) );
+    random.RndmArray( n, &(uniform[0]) );
+
+    for( int i = 0; i < n; ++i ){
+
+      // an acceptance that is linearly rising with mass
+      bool accept = ( mass[i] > uniform[i] * 3 );
+      if( !accept && generated == NULL ) continue;
+
+      columns.particleList( first + i, particles );
+      Kinematics event( particles, columns.weight( first + i ) );
+
+      if( accept ){
+
+        accepted.writeEvent( event );
+        ++numAccepted;
+      }
+      if( generated != NULL ) generated->writeEvent( event );
+    }
   }
-  
-	return 0;
+
+  delete generated;
+  inFile->Close();
+  delete inFile;
+
+  return numAccepted;
+}
+
+
+int main( int argc, char* argv[] ){
+
+  unsigned int seed = 1;
+  unsigned int nThreads = 1;
+  bool writeGenerated = false;
+  vector< string > names;
+
+  for( int i = 1; i < argc; ++i ){
+
+    string arg( argv[i] );
+
+    if( arg == "-g" ) writeGenerated = true;
+    else if( arg == "-s" || arg == "-n" ){
+
+      if( i + 1 == argc ) Usage();
+      if( arg == "-s" ) seed = atoi( argv[++i] );
+      else nThreads = atoi( argv[++i] );
+    }
+    else if( arg[0] == '-' ) Usage();
+    else names.push_back( arg );
+  }
+
+  if( names.size() < 2 || names.size() % 2 != 0 ) Usage();
+  if( nThreads == 0 ) nThreads = 1;
+
+  vector< FilePair > files( names.size() / 2 );
+  for( unsigned int i = 0; i < files.size(); ++i ){
+
+    files[i].input = names[2*i];
+    files[i].accepted = names[2*i+1];
+
+    if( writeGenerated ){
+
+      string base = files[i].accepted;
+      if( base.size() > 5 && base.substr( base.size() - 5 ) == ".root" )
+        base = base.substr( 0, base.size() - 5 );
+      files[i].generated = base + "_gen.root";
+    }
+  }
+
+  if( nThreads > files.size() ) nThreads = files.size();
+
+  // the writers fill their trees on their own threads even for -n 1
+  ROOT::EnableThreadSafety();
+
+  vector< Long64_t > numAccepted( files.size(), 0 );
+  unsigned int nextFile = 0;
+  mutex fileMutex;
+
+  auto work = [&](){
+    while( true ){
+
+      unsigned int file;
+      {
+        lock_guard< mutex > lock( fileMutex );
+        if( nextFile == files.size() ) return;
+        file = nextFile++;
+      }
+
+      numAccepted[file] = processFile( files[file], file, seed );
+    }
+  };
+
+  vector< thread > threads;
+  for( unsigned int i = 1; i < nThreads; ++i ) threads.push_back( thread( work ) );
+  work();
+  for( unsigned int i = 0; i < threads.size(); ++i ) threads[i].join();
+
+  int status = 0;
+  for( unsigned int i = 0; i < files.size(); ++i ){
+
+    if( numAccepted[i] < 0 ){
+
+      status = 1;
+      continue;
+    }
+
+    cout << files[i].input << ":  " << numAccepted[i] << " events accepted" << endl;
+  }
+
+  return status;
 }
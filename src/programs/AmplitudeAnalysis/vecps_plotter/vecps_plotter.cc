@@ -21,6 +21,7 @@
 #include "AmpPlotter/PlotFactory.h"
 
 #include "AMPTOOLS_DATAIO/VecPsPlotGenerator.h"
+#include "AMPTOOLS_DATAIO/PlotSubsetEngine.h"
 #include "AMPTOOLS_DATAIO/ROOTDataReader.h"
 #include "AMPTOOLS_DATAIO/ROOTDataReaderBootstrap.h"
 #include "AMPTOOLS_DATAIO/ROOTDataReaderTEM.h"
@@ -50,6 +51,14 @@ void atiSetup(){
 
 using namespace std;
 
+// the sums ImagNegSign and RealPosSign are defined to be the negative
+// reflectivity: returns 1 for those and 0 for the positive reflectivity
+int reflectivity( const string& sumName ){
+
+  if(sumName.find("ImagNegSign") != std::string::npos || sumName.find("RealPosSign") != std::string::npos) return 1;
+  return 0;
+}
+
 int main( int argc, char* argv[] ){
 
 
@@ -66,6 +75,7 @@ int main( int argc, char* argv[] ){
   }
 
   bool showGui = false;
+  unsigned int nThreads = 0;
   string outName = "vecps_plot.root";
   string resultsName(argv[1]);
   for (int i = 2; i < argc; i++){
@@ -78,10 +88,14 @@ int main( int argc, char* argv[] ){
     if (arg == "-o"){
       outName = argv[++i];
     }
+    if (arg == "-n"){
+      nThreads = atoi( argv[++i] );
+    }
     if (arg == "-h"){
       cout << endl << " Usage for: " << argv[0] << endl << endl;
       cout << "\t -o <file>\t output file path" << endl;
       cout << "\t -g <file>\t show GUI" << endl;
+      cout << "\t -n <int>\t number of threads filling the MC histograms (default: number of cores)" << endl;
       exit(1);
     }
   }
@@ -132,105 +146,80 @@ int main( int argc, char* argv[] ){
   vector<string> amphistname = {"1pps", "1p0s", "1pms", "1ppd", "1p0d", "1pmd", "1mpp", "1m0p", "1mmp", "1p", "1m"};
   vector<string> reflname = {"PosRefl", "NegRefl"};
 
-  // loop over sum configurations (one for each of the individual contributions, and the combined sum of all)
-  for (unsigned int irefl = 0; irefl <= reflname.size(); irefl++){
+  // set unique histogram name for each plot (could put in directories...)
+  vector<string> varname( VecPsPlotGenerator::kNumHists );
+  varname[VecPsPlotGenerator::kVecPsMass] = "MVecPs";
+  varname[VecPsPlotGenerator::kCosTheta] = "CosTheta";
+  varname[VecPsPlotGenerator::kPhi] = "Phi";
+  varname[VecPsPlotGenerator::kCosThetaH] = "CosTheta_H";
+  varname[VecPsPlotGenerator::kPhiH] = "Phi_H";
+  varname[VecPsPlotGenerator::kProd_Ang] = "Prod_Ang";
+  varname[VecPsPlotGenerator::kt] = "t";
+  varname[VecPsPlotGenerator::kRecoilMass] = "MRecoil";
+  varname[VecPsPlotGenerator::kProtonPsMass] = "MProtonPs";
+  varname[VecPsPlotGenerator::kRecoilPsMass] = "MRecoilPs";
+
+  // the data is plotted once, its histograms give the binning of the MC
+  cout << "Looping over input data" << endl;
+  vector< TH1* > shapes;
+  for (unsigned int ivar  = 0; ivar  < VecPsPlotGenerator::kNumHists; ivar++){
+
+    Histogram* hist = plotGen.projection(ivar, reactionName, PlotGenerator::kData);
+    TH1* thist = hist->toRoot();
+    thist->SetName((varname[ivar] + "dat").c_str());
+    plotfile->cd();
+    thist->Write();
+
+    shapes.push_back(thist);
+  }
 
-    // loop over desired amplitudes 
+  // all sum and amplitude configurations of the accepted MC are filled
+  // in one pass (one for each of the individual contributions, and the
+  // combined sum of all)
+  plotGen.selectReaction( reactionName );
+  PlotSubsetEngine engine( results, reactionName,
+                           [&plotGen]( Kinematics* kin, const string& reaction, double* values ){
+                             plotGen.projectValues( kin, values ); },
+                           shapes );
+
+  vector<string> subsetname;
+  for (unsigned int irefl = 0; irefl <= reflname.size(); irefl++){
     for (unsigned int iamp = 0; iamp <= amphistname.size(); iamp++ ) {
 
-      // turn all ampltiudes by default 
-      for (unsigned int jamp = 0; jamp < amps.size(); jamp++ ) {
-	plotGen.enableAmp( jamp );
-      }
+      string name;
+      if (irefl < reflname.size()) name += "_" + reflname[irefl];
+      if (iamp < amphistname.size()) name += "_" + amphistname[iamp];
 
-      // turn off unwanted amplitudes and sums
-      if (iamp < amphistname.size()) {
-	
-        string locampname = amphistname[iamp];
-	
-	// turn on all sums by default
-	for (unsigned int i = 0; i < sums.size(); i++) plotGen.enableSum(i);
-
-	// turn off unwanted sums for reflectivity (based on naturality)
-	//cout<<"refl = "<<irefl<<endl;
-	if (irefl < 2) {
-	  for (unsigned int i = 0; i < sums.size(); i++){
-	    
-	    bool disableSum = false;
-	    if(sums[i].find("ImagNegSign") != std::string::npos || sums[i].find("RealPosSign") != std::string::npos) {
-	      //ImagNegSign & RealPosSign are defined to be the negative reflectivity
-	      disableSum = true;
-	    }
-	    else {
-	      disableSum = true;
-	    }
-	    
-	    if(disableSum) {
-	      plotGen.disableSum(i);
-	      //cout<<"disable sum "<<sums[i]<<endl;
-	    }
-	  }
-	}
+      vector<string> subset;
+      for (unsigned int jamp = 0; jamp < engine.amplitudes().size(); jamp++ ) {
 
-	// turn off unwanted amplitudes
-        for (unsigned int jamp = 0; jamp < amps.size(); jamp++ ) {
+        // full names are reaction::sum::amplitude
+        string fullName = engine.amplitudes()[jamp];
+        size_t ampStart = fullName.rfind("::");
+        string ampName = fullName.substr(ampStart + 2);
+        string sumName = fullName.substr(0, ampStart);
 
-	  if( amps[jamp].find(locampname.data()) == std::string::npos ) {
-	    plotGen.disableAmp( jamp );
-	    //cout<<"disable amplitude "<<amps[jamp]<<endl;
-	  }
-	}
+        if (iamp < amphistname.size() && ampName.find(amphistname[iamp]) == std::string::npos) continue;
+        if (irefl < reflname.size() && reflectivity(sumName) != (int)irefl) continue;
 
+        subset.push_back(fullName);
       }
 
-      cout << "Looping over input data" << endl;
-      // loop over data, accMC, and genMC
-      for (unsigned int iplot = 0; iplot < PlotGenerator::kNumTypes; iplot++){
-	if (iplot == PlotGenerator::kGenMC || iplot == PlotGenerator::kBkgnd) continue;
-	if (irefl < reflname.size() && iamp < amphistname.size() && iplot == PlotGenerator::kData) continue; // only plot data once
-	
-	// loop over different variables
-	for (unsigned int ivar  = 0; ivar  < VecPsPlotGenerator::kNumHists; ivar++){
-	  
-	  // set unique histogram name for each plot (could put in directories...)
-	  string histname =  "";
-	  if (ivar == VecPsPlotGenerator::kVecPsMass)  histname += "MVecPs";
-	  else if (ivar == VecPsPlotGenerator::kCosTheta)  histname += "CosTheta";
-	  else if (ivar == VecPsPlotGenerator::kPhi)  histname += "Phi";
-	  else if (ivar == VecPsPlotGenerator::kCosThetaH)  histname += "CosTheta_H";
-	  else if (ivar == VecPsPlotGenerator::kPhiH)  histname += "Phi_H";
-	  else if (ivar == VecPsPlotGenerator::kProd_Ang)  histname += "Prod_Ang";
-	  else if (ivar == VecPsPlotGenerator::kt)  histname += "t";
-	  else if (ivar == VecPsPlotGenerator::kRecoilMass)  histname += "MRecoil";
-	  else if (ivar == VecPsPlotGenerator::kProtonPsMass)  histname += "MProtonPs";
-	  else if (ivar == VecPsPlotGenerator::kRecoilPsMass)  histname += "MRecoilPs";
-	  else continue;	  
-
-	  if (iplot == PlotGenerator::kData) histname += "dat";
-	  if (iplot == PlotGenerator::kBkgnd) histname += "bkgnd";
-	  if (iplot == PlotGenerator::kAccMC) histname += "acc";
-	  if (iplot == PlotGenerator::kGenMC) histname += "gen";
-	  
-	  if (irefl < reflname.size()){
-	    // get name of sum for naming histogram
-	    string sumName = reflname[irefl];
-	    histname += "_";
-	    histname += sumName;
-	  }
-	  if (iamp < amphistname.size()) {
-	    // get name of amp for naming histogram  
-	    histname += "_";
-	    histname += amphistname[iamp];
-	  }
-	  
-	  Histogram* hist = plotGen.projection(ivar, reactionName, iplot);
-	  TH1* thist = hist->toRoot();
-	  thist->SetName(histname.c_str());
-	  plotfile->cd();
-	  thist->Write();
-	  
-	}
-      }
+      subsetname.push_back(name);
+      engine.addSubset(name, subset);
+    }
+  }
+
+  cout << "Looping over accepted MC" << endl;
+  engine.fill(false, nThreads);
+
+  for (unsigned int isub = 0; isub < engine.numSubsets(); isub++){
+    for (unsigned int ivar  = 0; ivar  < VecPsPlotGenerator::kNumHists; ivar++){
+
+      TH1* thist = engine.histogram(isub, ivar);
+      thist->SetName((varname[ivar] + "acc" + subsetname[isub]).c_str());
+      plotfile->cd();
+      thist->Write();
     }
   }
 